@@ -0,0 +1,111 @@
+// Samples a 200-joint character for 1000 instances per frame: one instance at a time with and without keyframe
+// cursors, then as a batch (unsorted, sorted by time, copied back into node transforms, across all threads), and again
+// with the keyframes quantized to i16
+#include "accessor.hpp"
+#include "animation.hpp"
+#include "common.hpp"
+#include "keyframes.hpp"
+#include "node_transforms.hpp"
+#include <algorithm>
+#include <cstdio>
+
+using namespace gltf;
+
+static const u32 JOINTS = 200;
+static const u32 INSTANCES = 1000;
+static const u32 FRAMES = 120;
+
+static usize output_bytes(const Model &model) {
+    usize bytes = 0;
+    for (const AnimationSampler &sampler : model.animations[0].samplers) {
+        bytes += model.accessors[sampler.output].count * element_size(model.accessors[sampler.output]);
+    }
+    return bytes;
+}
+
+int main() {
+    Model model = bench::make_character(JOINTS, 30.0f, 4.0f);
+
+    AnimationClip clip;
+    if (!build_animation_clip(model, 0, clip)) return 1;
+
+    std::vector<NodeTransforms> instances(INSTANCES);
+    std::vector<AnimationCursor> cursors(INSTANCES);
+    for (u32 i = 0; i < INSTANCES; i++) {
+        build_node_transforms(model, instances[i]);
+        reset_animation_cursor(clip, cursors[i]);
+    }
+
+    // Each instance plays at its own offset; 60 Hz frames advance well under one 30 Hz keyframe
+    auto run = [&](bool cursor) {
+        f64 start = bench::now_ms();
+        for (u32 frame = 0; frame < FRAMES; frame++) {
+            for (u32 i = 0; i < INSTANCES; i++) {
+                f32 time = std::fmod(frame / 60.0f + i * 0.37f, clip.end);
+                if (cursor) {
+                    apply_animation(clip, time, instances[i], cursors[i]);
+                } else {
+                    apply_animation(clip, time, instances[i]);
+                }
+                instances[i].edited.clear();
+                for (u32 n = 0; n < JOINTS; n++) instances[i].dirty[n] = 0;
+            }
+        }
+        return (bench::now_ms() - start) / FRAMES;
+    };
+
+    // The batch keeps its samples in its own rows; `apply` also copies them into the instances' node transforms.
+    // Sorted offsets let neighbouring lanes share key lookups and keyframe reads.
+    std::vector<f32> times(INSTANCES), offsets(INSTANCES);
+    AnimationBatch batch;
+    init_animation_batch(clip, INSTANCES, batch);
+    auto run_batch = [&](bool threaded, bool sorted, bool apply) {
+        for (u32 i = 0; i < INSTANCES; i++) offsets[i] = std::fmod(i * 0.37f, clip.end);
+        if (sorted) std::sort(offsets.begin(), offsets.end());
+
+        f64 start = bench::now_ms();
+        for (u32 frame = 0; frame < FRAMES; frame++) {
+            for (u32 i = 0; i < INSTANCES; i++) times[i] = std::fmod(frame / 60.0f + offsets[i], clip.end);
+            if (threaded) {
+                sample_animation_batch(clip, batch, times.data());
+            } else {
+                sample_animation_batch(clip, batch, times.data(), 0, INSTANCES);
+            }
+            if (!apply) continue;
+            for (u32 i = 0; i < INSTANCES; i++) {
+                apply_animation_batch(clip, batch, i, instances[i]);
+                instances[i].edited.clear();
+                for (u32 n = 0; n < JOINTS; n++) instances[i].dirty[n] = 0;
+            }
+        }
+        return (bench::now_ms() - start) / FRAMES;
+    };
+
+    f64 search = run(false);
+    f64 cached = run(true);
+    f64 batched = run_batch(false, false, false);
+    f64 sorted = run_batch(false, true, false);
+    f64 applied = run_batch(false, false, true);
+    f64 threaded = run_batch(true, false, false);
+    usize float_bytes = output_bytes(model);
+
+    KeyframeQuantizeOptions quantize;
+    quantize.translations = quantize.scales = true;
+    if (!quantize_animations(model, quantize) || !build_animation_clip(model, 0, clip)) return 1;
+    init_animation_batch(clip, INSTANCES, batch);
+    f64 quantized_cached = run(true);
+    f64 quantized_batched = run_batch(false, false, false);
+
+    f64 tracks = (f64)clip.tracks.size() * INSTANCES;
+    std::printf("%u joints x %u instances, %zu tracks per instance\n", JOINTS, INSTANCES, clip.tracks.size());
+    std::printf("binary search: %8.3f ms/frame %6.1f ns/track\n", search, search * 1e6 / tracks);
+    std::printf("cursor:        %8.3f ms/frame %6.1f ns/track\n", cached, cached * 1e6 / tracks);
+    std::printf("batch:         %8.3f ms/frame %6.1f ns/track\n", batched, batched * 1e6 / tracks);
+    std::printf("batch sorted:  %8.3f ms/frame %6.1f ns/track\n", sorted, sorted * 1e6 / tracks);
+    std::printf("batch + apply: %8.3f ms/frame %6.1f ns/track\n", applied, applied * 1e6 / tracks);
+    std::printf("batch threads: %8.3f ms/frame %6.1f ns/track\n", threaded, threaded * 1e6 / tracks);
+    std::printf("i16 cursor:    %8.3f ms/frame %6.1f ns/track\n", quantized_cached, quantized_cached * 1e6 / tracks);
+    std::printf("i16 batch:     %8.3f ms/frame %6.1f ns/track\n", quantized_batched, quantized_batched * 1e6 / tracks);
+    std::printf("keyframe values: %zu bytes as float, %zu as i16\n", float_bytes, output_bytes(model));
+    return 0;
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "accessor.hpp"
+#include "gltf.hpp"
+#include "types.hpp"
+#include <chrono>
+#include <cmath>
+#include <vector>
+
+namespace bench {
+
+using namespace gltf;
+
+inline f64 now_ms() {
+    return std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// A chain of `joints` nodes with one animation keying translation, rotation and scale of every joint at `fps` over
+// `seconds`. Joint j swings around a per-joint axis so neighbouring keys differ.
+inline Model make_character(u32 joints, f32 fps, f32 seconds) {
+    Model model;
+    model.nodes.resize(joints);
+    for (u32 j = 0; j + 1 < joints; j++) model.nodes[j].children.push_back(j + 1);
+    model.scenes.resize(1);
+    model.scenes[0].nodes.push_back(0);
+
+    u32 keys = (u32)(fps * seconds) + 1;
+    std::vector<f32> times(keys);
+    for (u32 k = 0; k < keys; k++) times[k] = k / fps;
+    u32 input = add_float_accessor(model, times, "SCALAR", 0);
+
+    Animation animation;
+    for (u32 j = 0; j < joints; j++) {
+        std::vector<f32> translations, rotations, scales;
+        for (u32 k = 0; k < keys; k++) {
+            f32 phase = times[k] * 2.0f + j * 0.1f;
+            translations.insert(translations.end(), {0.0f, 0.1f + 0.01f * std::sin(phase), 0.0f});
+
+            f32 half = 0.25f * std::sin(phase), s = std::sin(half);
+            f32 ax = std::sin(j * 1.3f), ay = std::cos(j * 1.3f), az = 0.5f;
+            f32 length = std::sqrt(ax * ax + ay * ay + az * az);
+            rotations.insert(rotations.end(), {ax / length * s, ay / length * s, az / length * s, std::cos(half)});
+
+            f32 scale = 1.0f + 0.05f * std::cos(phase);
+            scales.insert(scales.end(), {scale, scale, scale});
+        }
+
+        const char *paths[3] = {"translation", "rotation", "scale"};
+        u32 outputs[3] = {add_float_accessor(model, translations, "VEC3", 0),
+                          add_float_accessor(model, rotations, "VEC4", 0),
+                          add_float_accessor(model, scales, "VEC3", 0)};
+        for (u32 p = 0; p < 3; p++) {
+            AnimationSampler sampler;
+            sampler.input = input;
+            sampler.output = outputs[p];
+            animation.samplers.push_back(sampler);
+
+            AnimationChannel channel;
+            channel.sampler = (u32)animation.samplers.size() - 1;
+            channel.target.node = j;
+            channel.target.path = paths[p];
+            animation.channels.push_back(channel);
+        }
+    }
+    model.animations.push_back(animation);
+    return model;
+}
+
+}; // namespace bench
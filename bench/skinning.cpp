@@ -0,0 +1,116 @@
+// Skins a 64-joint character's 100k-vertex tube with linear blend and dual quaternion skinning, four influences per
+// vertex, reporting the palette update and the vertex loop separately
+#include "accessor.hpp"
+#include "animation.hpp"
+#include "common.hpp"
+#include "math.hpp"
+#include "node_transforms.hpp"
+#include "skinning.hpp"
+#include <algorithm>
+#include <cstdio>
+
+using namespace gltf;
+
+static const u32 JOINTS = 64;
+static const u32 VERTICES = 100000;
+static const u32 FRAMES = 200;
+
+// A tube along the joint chain in its first animation frame. Vertex weights fall off over the four joints around
+// its height.
+static Primitive make_tube(Model &model, const NodeTransforms &bind) {
+    std::vector<f32> positions, normals, weights;
+    std::vector<u8> joints;
+    for (u32 v = 0; v < VERTICES; v++) {
+        f32 along = (f32)v / VERTICES * (JOINTS - 1), angle = v * 0.61803f * 6.2831853f;
+        u32 joint = (u32)along;
+        f32 t = along - joint;
+        Vec3 center = {bind.worlds[joint].cols[3][0], bind.worlds[joint].cols[3][1], bind.worlds[joint].cols[3][2]};
+        f32 x = std::cos(angle), z = std::sin(angle);
+        positions.insert(positions.end(), {center.x + 0.05f * x, center.y, center.z + 0.05f * z});
+        normals.insert(normals.end(), {x, 0.0f, z});
+
+        u32 first = joint > 0 ? joint - 1 : 0;
+        for (u32 k = 0; k < 4; k++) joints.push_back((u8)std::min(first + k, JOINTS - 1));
+        weights.insert(weights.end(), {0.1f * (1.0f - t), 0.8f * (1.0f - t) + 0.1f * t, 0.1f * (1.0f - t) + 0.8f * t,
+                                       0.1f * t});
+    }
+
+    Accessor accessor;
+    accessor.buffer_view = append_buffer_view(model, joints.data(), joints.size(), 0, TARGET_ARRAY_BUFFER);
+    accessor.component_type = COMPONENT_UNSIGNED_BYTE;
+    accessor.count = VERTICES;
+    accessor.type = "VEC4";
+
+    Primitive primitive;
+    primitive.attributes["POSITION"] = add_float_accessor(model, positions, "VEC3", TARGET_ARRAY_BUFFER);
+    primitive.attributes["NORMAL"] = add_float_accessor(model, normals, "VEC3", TARGET_ARRAY_BUFFER);
+    primitive.attributes["JOINTS_0"] = add_accessor(model, accessor);
+    primitive.attributes["WEIGHTS_0"] =
+        add_normalized_accessor(model, weights, "VEC4", COMPONENT_UNSIGNED_BYTE, TARGET_ARRAY_BUFFER);
+    return primitive;
+}
+
+int main() {
+    Model model = bench::make_character(JOINTS, 30.0f, 4.0f);
+    AnimationClip clip;
+    if (!build_animation_clip(model, 0, clip)) return 1;
+
+    NodeTransforms transforms;
+    build_node_transforms(model, transforms);
+    apply_animation(clip, 0.0f, transforms);
+    update_node_matrices(transforms);
+
+    std::vector<f32> inverse_binds;
+    for (u32 j = 0; j < JOINTS; j++) {
+        Mat4 inverse;
+        mat4_affine_inverse(transforms.worlds[j], inverse);
+        inverse_binds.insert(inverse_binds.end(), inverse.m, inverse.m + 16);
+    }
+    Skin skin;
+    for (u32 j = 0; j < JOINTS; j++) skin.joints.push_back(j);
+    skin.inverse_bind_matrices = add_float_accessor(model, inverse_binds, "MAT4", 0);
+    model.skins.push_back(skin);
+
+    // Appending the tube can reallocate the buffer the clip's keyframes point into, so the clip is built again
+    Primitive primitive = make_tube(model, transforms);
+    SkinBinding binding;
+    JointPalette linear, dual;
+    if (!build_animation_clip(model, 0, clip) || !bind_skinned_primitive(model, primitive, binding) ||
+        !build_joint_palette(model, 0, linear) || !build_joint_palette(model, 0, dual, true)) {
+        return 1;
+    }
+
+    SkinnedVertices skinned;
+    auto run = [&](JointPalette &palette, bool dual_quaternion, f64 &palette_ms) {
+        f64 skinning = 0.0;
+        palette_ms = 0.0;
+        for (u32 frame = 0; frame < FRAMES; frame++) {
+            apply_animation(clip, std::fmod(frame / 60.0f, clip.end), transforms);
+            update_node_matrices(transforms);
+
+            f64 start = bench::now_ms();
+            update_joint_palette(palette, transforms.worlds);
+            f64 middle = bench::now_ms();
+            if (dual_quaternion) {
+                skin_vertices_dual_quaternion(binding, palette, skinned);
+            } else {
+                skin_vertices(binding, palette, skinned);
+            }
+            palette_ms += middle - start;
+            skinning += bench::now_ms() - middle;
+        }
+        palette_ms /= FRAMES;
+        return skinning / FRAMES;
+    };
+
+    f64 linear_palette, dual_palette;
+    f64 linear_ms = run(linear, false, linear_palette);
+    f64 dual_ms = run(dual, true, dual_palette);
+
+    std::printf("%u joints, %u vertices with normals, 4 influences each\n", JOINTS, VERTICES);
+    std::printf("linear blend:    palette %6.3f ms, vertices %7.3f ms/frame %5.1f ns/vertex\n", linear_palette,
+                linear_ms, linear_ms * 1e6 / VERTICES);
+    std::printf("dual quaternion: palette %6.3f ms, vertices %7.3f ms/frame %5.1f ns/vertex\n", dual_palette,
+                dual_ms, dual_ms * 1e6 / VERTICES);
+    return 0;
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include "gltf.hpp"
+#include "types.hpp"
+#include <string>
+#include <vector>
+
+namespace gltf {
+
+// Accessor component types
+constexpr i32 COMPONENT_BYTE = 5120;
+constexpr i32 COMPONENT_UNSIGNED_BYTE = 5121;
+constexpr i32 COMPONENT_SHORT = 5122;
+constexpr i32 COMPONENT_UNSIGNED_SHORT = 5123;
+constexpr i32 COMPONENT_UNSIGNED_INT = 5125;
+constexpr i32 COMPONENT_FLOAT = 5126;
+
+// Buffer view targets
+constexpr i32 TARGET_ARRAY_BUFFER = 34962;
+constexpr i32 TARGET_ELEMENT_ARRAY_BUFFER = 34963;
+
+// Read-only view over the elements of an accessor, resolved down to raw buffer memory
+struct AccessorView {
+    const u8 *data = nullptr;
+    usize stride = 0;
+    usize count = 0;
+    usize components = 0;
+    i32 component_type = 0;
+    bool normalized = false;
+
+    const u8 *element(usize i) const {
+        return data + i * stride;
+    }
+};
+
+usize component_size(i32 component_type);
+usize component_count(const std::string &type);
+usize element_size(const Accessor &accessor);
+
+// Returns false if the accessor, its buffer view or its buffer are out of range or not loaded
+bool view_accessor(const Model &model, u32 accessor, AccessorView &out);
+
+// Decode / encode `n` components of a single element, honoring the normalized flag
+void read_components(const u8 *src, i32 component_type, bool normalized, usize n, f32 *out);
+void write_components(u8 *dst, i32 component_type, bool normalized, usize n, const f32 *in);
+u32 read_index(const u8 *src, i32 component_type);
+void write_index(u8 *dst, i32 component_type, u32 value);
+
+// Reads every index of `accessor` (or 0..vertex_count-1 when `accessor` is UINT32_MAX)
+bool read_indices(const Model &model, u32 accessor, usize vertex_count, std::vector<u32> &out);
+// Overwrites the indices of `accessor` in place, keeping its component type; `indices` must match its count
+bool write_indices(Model &model, u32 accessor, const std::vector<u32> &indices);
+// Reads every element of `accessor` as floats, component_count(type) values per element
+bool read_floats(const Model &model, u32 accessor, std::vector<f32> &out);
+
+// Append new storage to the model, returning the index of the created object
+u32 add_buffer(Model &model, std::vector<u8> data);
+u32 add_buffer_view(Model &model, u32 buffer, usize byte_offset, usize byte_length, usize byte_stride, i32 target);
+u32 add_accessor(Model &model, const Accessor &accessor);
+
+// Copies `byte_length` bytes to an offset of the model's working buffer aligned to `alignment` (a multiple of 4) and
+// returns a new buffer view over them. Passes append their output here rather than adding a buffer per accessor, so
+// the model still saves as one .bin file. The working buffer is created on first use and may reallocate on every
+// append: AccessorViews into it, and animation clips built over it, do not survive calls that write new data.
+u32 append_buffer_view(Model &model, const void *data, usize byte_length, usize byte_stride, i32 target,
+                       usize alignment = 4);
+
+// Moves each listed accessor whose bytes overlap those of any other accessor of the model, through the same buffer
+// view or another one over the same buffer, to a private copy made with append_buffer_view(). Afterwards the listed
+// accessors can be rewritten in place, also in parallel, without changing what any other accessor reads. Returns the
+// number of accessors copied.
+usize unshare_accessors(Model &model, const std::vector<u32> &accessors);
+
+// Writes `indices` into a new buffer view / accessor as u16 when they fit, u32 otherwise
+u32 add_index_accessor(Model &model, const std::vector<u32> &indices, u32 vertex_count);
+// Writes tightly packed float data into a new buffer view / accessor, computing min / max
+u32 add_float_accessor(Model &model, const std::vector<f32> &values, const std::string &type, i32 target);
+// Writes `values` into a new buffer view / accessor as tightly packed normalized integers of `component_type`
+// (8 or 16 bit), clamping them to its range
+u32 add_normalized_accessor(Model &model, const std::vector<f32> &values, const std::string &type, i32 component_type,
+                            i32 target);
+
+// Removes the accessors no primitive, skin or animation sampler references any more, e.g. after animations were
+// rewritten by optimize_animations(). Accessor indices change.
+void compact_accessors(Model &model);
+
+// Repacks every buffer view still referenced by an accessor or image into a single buffer, dropping the data that
+// passes like welding or simplification left unreferenced. Buffer view indices change; every view keeps its offset
+// modulo the largest component size it holds, so accessors stay as aligned as they were. Fails without touching the
+// model when a referenced view lies outside its buffer or the buffer was never loaded.
+bool compact_buffers(Model &model);
+
+// Rewrites every attribute and morph target of `primitive` to hold `vertex_count` vertices, where old vertex `i` lands
+// at `remap[i]` (UINT32_MAX drops it). Each attribute gets its own tightly packed buffer view and accessor.
+bool remap_vertices(Model &model, Primitive &primitive, const std::vector<u32> &remap, usize vertex_count);
+// Same as remap_vertices(), but new vertex `i` is a copy of old vertex `source[i]`, so vertices may be duplicated
+bool gather_vertices(Model &model, Primitive &primitive, const std::vector<u32> &source);
+
+// Number of vertices referenced by a primitive's attributes (0 if they disagree or are missing)
+usize primitive_vertex_count(const Model &model, const Primitive &primitive);
+
+}; // namespace gltf
@@ -0,0 +1,108 @@
+#pragma once
+
+#include "accessor.hpp"
+#include "gltf.hpp"
+#include "node_transforms.hpp"
+#include "types.hpp"
+#include <string>
+#include <vector>
+
+namespace gltf {
+
+// Animated property of a channel target
+constexpr u8 ANIMATION_PATH_TRANSLATION = 0;
+constexpr u8 ANIMATION_PATH_ROTATION = 1;
+constexpr u8 ANIMATION_PATH_SCALE = 2;
+constexpr u8 ANIMATION_PATH_WEIGHTS = 3;
+
+// Sampler interpolation
+constexpr u8 INTERPOLATION_STEP = 0;
+constexpr u8 INTERPOLATION_LINEAR = 1;
+constexpr u8 INTERPOLATION_CUBICSPLINE = 2;
+
+// One channel with its sampler resolved to views of the keyframe data. Nothing is copied: sampling decodes keyframes
+// straight from the model's buffers, so a track is only valid while those stay in place.
+struct AnimationTrack {
+    AccessorView input;  // Keyframe times, float scalars
+    AccessorView output; // Keyframe values, float or normalized integers
+    u32 node = UINT32_MAX;
+    u32 width = 0; // Values per keyframe: 3 or 4, or the number of morph targets for weights
+    u8 path = ANIMATION_PATH_TRANSLATION;
+    u8 interpolation = INTERPOLATION_LINEAR;
+
+    // Range quantization of the output, applied to sampled values (see AnimationSampler::dequantize_offset)
+    bool dequantize = false;
+    Vec3 dequantize_offset = Vec3::zero();
+    Vec3 dequantize_scale = Vec3::one();
+};
+
+struct AnimationClip {
+    std::vector<AnimationTrack> tracks;
+    f32 start = 0.0f; // Earliest and latest keyframe time over all tracks
+    f32 end = 0.0f;
+    u32 animation = UINT32_MAX;
+};
+
+// Keyframe found by the last lookup of each track of a clip. Playback that moves forward, or stays within a keyframe
+// interval, then finds its keys in O(1); seeks fall back to a binary search. One cursor per playing instance.
+struct AnimationCursor {
+    std::vector<u32> keys;
+};
+
+// Keyframe cursors and sampled values of one clip played by `instances` instances at independent times. The values
+// are a structure of arrays across instances: value c of track t for instance i is
+// values[(rows[t] + c) * instances + i], so each row can be streamed or uploaded as is.
+struct AnimationBatch {
+    u32 instances = 0;
+    std::vector<u32> cursors; // [track * instances + instance]
+    std::vector<u32> rows;    // First row of each track in `values`; a track has `width` rows
+    std::vector<f32> values;
+};
+
+// Instances per job when sample_animation_batch() splits a batch across threads
+constexpr u32 ANIMATION_BATCH_RANGE = 64;
+
+// "translation", "rotation", "scale" or "weights" to ANIMATION_PATH_*; false for anything else
+bool parse_animation_path(const std::string &path, u8 &out);
+
+// Resolves one sampler of `animation` as animating `path`, checking that its accessors agree. `node` is left unset.
+// Range-quantized samplers are only accepted for translation and scale.
+bool view_animation_sampler(const Model &model, u32 animation, u32 sampler, u8 path, AnimationTrack &track);
+
+// Resolves every channel of `animation`. Channels without a target node are skipped; malformed samplers fail.
+bool build_animation_clip(const Model &model, u32 animation, AnimationClip &clip);
+
+// Writes the `track.width` values of the track at `time` to `out`. Times outside the keyframes clamp to the first or
+// last one. LINEAR rotations use slerp, CUBICSPLINE rotations are normalized. Normalized i16 keyframes are decoded
+// four components at a time as they are read.
+void sample_track(const AnimationTrack &track, f32 time, f32 *out);
+void sample_track(const AnimationTrack &track, f32 time, f32 *out, u32 &cursor);
+
+void reset_animation_cursor(const AnimationClip &clip, AnimationCursor &cursor);
+
+// Samples every track of the clip at `time` and writes the results to the targeted nodes. Animated matrix nodes switch
+// to TRS. None of the overloads allocate once the destination weights and the cursor are sized.
+void apply_animation(const AnimationClip &clip, f32 time, Model &model);
+void apply_animation(const AnimationClip &clip, f32 time, Model &model, AnimationCursor &cursor);
+void apply_animation(const AnimationClip &clip, f32 time, NodeTransforms &transforms);
+void apply_animation(const AnimationClip &clip, f32 time, NodeTransforms &transforms, AnimationCursor &cursor);
+
+// Sizes the cursors and the value rows of `batch` for the clip
+void init_animation_batch(const AnimationClip &clip, u32 instances, AnimationBatch &batch);
+
+// Samples every track of the clip for instances [first, first + count) at `times[i]` into the batch rows. Tracks are
+// the outer loop and instances go four per SIMD lane group. A lane whose time falls in the keyframe interval of the
+// lane before it reuses that key lookup, and lanes sharing a span read its keyframes once, so instances sorted by time
+// or playing in step share most of the work. LINEAR rotations use a polynomial-corrected nlerp that stays within
+// 0.002 radians of slerp. Disjoint ranges touch disjoint data and may run on different threads.
+void sample_animation_batch(const AnimationClip &clip, AnimationBatch &batch, const f32 *times, u32 first,
+                            u32 count);
+
+// Whole batch, split across the hardware threads in ranges of ANIMATION_BATCH_RANGE instances
+void sample_animation_batch(const AnimationClip &clip, AnimationBatch &batch, const f32 *times);
+
+// Writes the sampled values of one instance to its node transforms, like apply_animation() would
+void apply_animation_batch(const AnimationClip &clip, const AnimationBatch &batch, u32 instance,
+                           NodeTransforms &transforms);
+
+}; // namespace gltf
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "gltf.hpp"
+#include "types.hpp"
+
+namespace gltf {
+
+// Object-space bounds of a primitive's POSITION accessor. Morph target POSITION displacements widen the result so it
+// holds for any combination of target weights in [0, 1]. Returns false when the primitive has no readable positions.
+bool compute_primitive_bounds(const Model &model, const Primitive &primitive, Bounds &bounds);
+
+// Grows `bounds` to enclose `other`
+void merge_bounds(Bounds &bounds, const Bounds &other);
+
+// Bounds of the transformed volume: the box is refitted around the transformed box, the sphere radius is scaled by the
+// largest axis scale of `matrix`
+Bounds transform_bounds(const Bounds &bounds, const Mat4 &matrix);
+
+// Brings `model.bounds` up to date. World matrices come from update_transforms() (transform.hpp), so node transforms
+// must be edited through set_translation() and friends, and a node whose transform fields or `mesh` were changed
+// directly must be passed to mark_transform_dirty(). The first call reads every POSITION accessor and builds world
+// bounds for all nodes; later calls only visit the subtrees moved by any update_transforms() since the previous call
+// (recorded in BoundsCache::moved_roots), the nodes using a mesh passed to invalidate_mesh_bounds() and the ancestors
+// of both.
+void update_bounds(Model &model);
+
+// Geometry edits are not detected automatically: after rewriting the positions (or morph targets) of a mesh, mark it
+// so the next update_bounds() re-reads it. invalidate_bounds() drops the whole cache, e.g. after hierarchy edits.
+void invalidate_mesh_bounds(Model &model, u32 mesh);
+void invalidate_bounds(Model &model);
+
+// Union of the subtree bounds of a scene's root nodes; call update_bounds() first
+Bounds scene_bounds(const Model &model, u32 scene);
+
+}; // namespace gltf
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "types.hpp"
+#include <cfloat>
 #include <map>
 #include <stdint.h>
 #include <string>
@@ -135,6 +136,9 @@ struct Primitive {
     u32 indices = UINT32_MAX;
     u32 material = UINT32_MAX;
     i32 mode = 4; // GL_TRIANGLES (4) by default
+
+    // Morph targets: attribute displacements, e.g. "POSITION" -> accessor
+    std::vector<std::map<std::string, u32>> targets;
 };
 
 struct Mesh {
@@ -162,6 +166,12 @@ struct Node {
     Vec4 rotation = {0, 0, 0, 1};
     Vec3 scale = Vec3::one();
 
+    // Morph target weights overriding the mesh's, e.g. written by animation
+    std::vector<f32> weights;
+
+    // MSFT_lod: nodes replacing this one at increasingly coarse levels of detail
+    std::vector<u32> lods;
+
     std::string name;
 };
 
@@ -174,6 +184,12 @@ struct AnimationSampler {
     u32 input = UINT32_MAX;               // Accessor for keyframe times
     u32 output = UINT32_MAX;              // Accessor for keyframe values
     std::string interpolation = "LINEAR"; // "LINEAR", "STEP", "CUBICSPLINE"
+
+    // Range quantization of a translation or scale output stored as normalized integers: value = offset + scale *
+    // stored, per component. Saved in the sampler's XIUXIU_animation_dequantize extension, which is then listed in both
+    // extensionsUsed and extensionsRequired. Empty when the output holds the values themselves.
+    std::vector<f32> dequantize_offset;
+    std::vector<f32> dequantize_scale;
 };
 
 struct AnimationChannel {
@@ -190,6 +206,43 @@ struct Animation {
     std::string name;
 };
 
+// Axis-aligned box plus bounding sphere; empty until something has been merged into it
+struct Bounds {
+    Vec3 min = {FLT_MAX, FLT_MAX, FLT_MAX};
+    Vec3 max = {-FLT_MAX, -FLT_MAX, -FLT_MAX};
+    Vec3 center = Vec3::zero();
+    f32 radius = -1.0f;
+
+    bool empty() const {
+        return radius < 0.0f;
+    }
+};
+
+// Bounding volumes derived from the model, maintained by update_bounds() in bounds.hpp
+struct BoundsCache {
+    std::vector<std::vector<Bounds>> primitives; // Object space, [mesh][primitive]
+    std::vector<Bounds> meshes;                  // Object space, union of the mesh primitives
+    std::vector<Bounds> nodes;                   // World space, node and all of its descendants
+
+    // Change tracking for incremental refreshes; world matrices and parents come from Model::transforms.
+    // update_transforms() records the subtrees it recomputed here, and only update_bounds() clears them.
+    std::vector<u32> dirty_meshes;
+    std::vector<u32> moved_roots; // Roots of subtrees whose world matrices changed since the last update_bounds()
+    bool refit_all = false;       // A full transform rebuild happened since the last update_bounds()
+    std::vector<u32> marks;       // Per node scratch of update_bounds(), all zero between calls
+    bool valid = false;
+};
+
+// World matrix of every node, kept current by the edit API in transform.hpp
+struct TransformCache {
+    std::vector<Mat4> world;
+    std::vector<u32> parents;
+    std::vector<u32> dirty;   // Nodes edited since the last update_transforms()
+    std::vector<u8> queued;   // Per node: already in `dirty`
+    std::vector<u32> changed; // Nodes whose world matrix was recomputed by the last update_transforms()
+    bool valid = false;
+};
+
 struct Model {
     std::vector<Buffer> buffers;
     std::vector<BufferView> buffer_views;
@@ -206,6 +259,12 @@ struct Model {
 
     u32 default_scene = 0;
 
+    BoundsCache bounds;
+    TransformCache transforms;
+
+    // Buffer that data written by the accessor helpers is appended to, see append_buffer_view() in accessor.hpp
+    u32 working_buffer = UINT32_MAX;
+
     // Base path for resolving external files
     std::string base_path;
 
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "gltf.hpp"
+#include "types.hpp"
+
+namespace gltf {
+
+// Smallest index component type able to address `max_index`. The largest value of each type is reserved as the
+// primitive restart value, so u16 holds indices up to 65534. u8 is only chosen when `allow_u8` is set, since several
+// graphics APIs do not accept 8-bit index buffers.
+i32 minimal_index_type(u32 max_index, bool allow_u8 = false);
+
+// Converts `count` tightly packed indices between component types, using SIMD for the u32 <-> u16 paths
+void convert_indices(u8 *dst, i32 dst_type, const u8 *src, i32 src_type, usize count);
+
+// Rewrites the index accessor of `primitive` with the minimal component type. The accessor is updated in place
+// (its values are unchanged, so sharing primitives are unaffected) and points at a new, smaller buffer view.
+bool narrow_indices(Model &model, Primitive &primitive, bool allow_u8 = false);
+
+// Rewrites the index accessor of `primitive` as u32, e.g. before merging primitives
+bool widen_indices(Model &model, Primitive &primitive);
+
+// Narrows the index accessors of every primitive in the model
+bool narrow_indices(Model &model, bool allow_u8 = false);
+
+}; // namespace gltf
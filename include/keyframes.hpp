@@ -0,0 +1,56 @@
+#pragma once
+
+#include "gltf.hpp"
+#include "types.hpp"
+
+namespace gltf {
+
+struct KeyframeOptions {
+    // Keys per second LINEAR and CUBICSPLINE samplers are resampled at. 0 keeps the existing key times and leaves
+    // CUBICSPLINE samplers alone.
+    f32 sample_rate = 30.0f;
+
+    // Largest deviation a removed key may have from the interpolation of the keys around it
+    f32 translation_tolerance = 1e-4f; // Distance
+    f32 rotation_tolerance = 1e-3f;    // Angle in radians
+    f32 scale_tolerance = 1e-4f;       // Relative to the scale component
+    f32 weight_tolerance = 1e-3f;      // Per morph target weight
+};
+
+struct KeyframeStats {
+    usize keys_before = 0;
+    usize keys_after = 0;
+};
+
+// Resamples the samplers of `animation` to `options.sample_rate` and drops every key that the remaining keys
+// reproduce within the tolerance of the path its channels animate. The first and last key of a sampler are kept, so
+// durations do not change. STEP samplers keep their times and only lose keys repeating the previous value.
+// Rewritten samplers get new float input / output accessors, with samplers of equal key times sharing one input
+// accessor. The old accessors stay in the model; compact_accessors() and compact_buffers() drop them.
+bool optimize_animation(Model &model, u32 animation, const KeyframeOptions &options = KeyframeOptions(),
+                        KeyframeStats *stats = nullptr);
+
+// optimize_animation() over every animation, sharing input accessors across all of them
+bool optimize_animations(Model &model, const KeyframeOptions &options = KeyframeOptions(),
+                         KeyframeStats *stats = nullptr);
+
+struct KeyframeQuantizeOptions {
+    // Normalized i16 components, which glTF readers accept as is
+    bool rotations = true;
+    bool weights = true; // Only samplers whose weights all lie in [-1, 1]
+
+    // Normalized i16 over the range of each sampler. Core glTF only allows float translation and scale keys, so saved
+    // files require the XIUXIU_animation_dequantize extension and other readers refuse them, hence off by default.
+    bool translations = false;
+    bool scales = false;
+};
+
+// Rewrites the float output accessors of the selected paths as normalized i16, each component within 1 / 65534 of
+// its float value (of the sampler's half range for translations and scales). Rotation keys are normalized first.
+// Samplers already stored as integers are left alone. The float accessors stay in the model until
+// compact_accessors().
+bool quantize_animation(Model &model, u32 animation,
+                        const KeyframeQuantizeOptions &options = KeyframeQuantizeOptions());
+bool quantize_animations(Model &model, const KeyframeQuantizeOptions &options = KeyframeQuantizeOptions());
+
+}; // namespace gltf
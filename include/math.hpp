@@ -0,0 +1,56 @@
+#pragma once
+
+#include "gltf.hpp"
+#include "types.hpp"
+
+namespace gltf {
+
+// Matrices are column-major (`cols[column][row]`) and transform column vectors; quaternions are (x, y, z, w) as in
+// glTF. Kernels run four lanes at a time through the SSE2 / NEON / scalar wrapper picked at compile time.
+
+// Column-major matrix product a * b
+Mat4 mat4_multiply(const Mat4 &a, const Mat4 &b);
+
+// out[i] = a[i] * b[i] for `count` pairs; `out` may alias either input
+void mat4_multiply_batch(const Mat4 *a, const Mat4 *b, Mat4 *out, usize count);
+
+Mat4 mat4_transpose(const Mat4 &matrix);
+
+// General inverse by cofactors. Returns false, leaving `inverse` untouched, when the matrix is singular.
+bool mat4_inverse(const Mat4 &matrix, Mat4 &inverse);
+
+// Inverse of a matrix whose last row is (0, 0, 0, 1), e.g. node and inverse bind matrices. Cheaper than
+// mat4_inverse() and exact in the last row.
+bool mat4_affine_inverse(const Mat4 &matrix, Mat4 &inverse);
+
+// T * R * S with `rotation` a unit quaternion, as glTF composes node transforms
+Mat4 compose_trs(const Vec3 &translation, const Vec4 &rotation, const Vec3 &scale);
+
+// Inverse of compose_trs() for matrices without shear or projection. A negative determinant is folded into scale.x.
+void decompose_trs(const Mat4 &matrix, Vec3 &translation, Vec4 &rotation, Vec3 &scale);
+
+// Hamilton product: rotating by the result applies `b`, then `a`
+Vec4 quat_multiply(const Vec4 &a, const Vec4 &b);
+
+// Unit quaternion, identity for a zero input
+Vec4 quat_normalize(const Vec4 &q);
+
+// Normalized linear interpolation along the shorter arc. Not constant speed, but within a few percent of slerp()
+// for the small angles between neighbouring keyframes.
+Vec4 quat_nlerp(const Vec4 &a, const Vec4 &b, f32 t);
+
+// Spherical interpolation along the shorter arc, falling back to nlerp() for nearly equal rotations
+Vec4 quat_slerp(const Vec4 &a, const Vec4 &b, f32 t);
+
+Vec3 quat_rotate(const Vec4 &q, const Vec3 &v);
+
+// matrix * (v, 1) and matrix * (v, 0)
+Vec3 transform_point(const Mat4 &matrix, const Vec3 &point);
+Vec3 transform_vector(const Mat4 &matrix, const Vec3 &vector);
+
+// Batched forms of the above over tightly packed arrays. `out` may be the same array as `in` but must not otherwise
+// overlap it.
+void transform_points(const Mat4 &matrix, const Vec3 *in, Vec3 *out, usize count);
+void transform_vectors(const Mat4 &matrix, const Vec3 *in, Vec3 *out, usize count);
+
+}; // namespace gltf
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "accessor.hpp"
+#include "gltf.hpp"
+#include "types.hpp"
+#include <vector>
+
+namespace gltf {
+
+// Same flattened layout as SceneBvhNode; leaves reference `count` entries of MeshBvh::triangles
+struct MeshBvhNode {
+    Vec3 min;
+    u32 first = 0;
+    Vec3 max;
+    u32 count = 0;
+};
+
+struct MeshBvhTriangle {
+    u32 primitive = 0;
+    u32 triangle = 0;
+};
+
+// Geometry of one primitive, read in place from the model's buffers at query time. `indices.count` is 0 for
+// non-indexed primitives.
+struct MeshBvhSource {
+    AccessorView positions;
+    AccessorView indices;
+};
+
+// Triangle BVH over every TRIANGLES primitive of a mesh, in the mesh's local space. Vertices are never copied: queries
+// decode positions and indices straight from the accessors, whatever their component types and strides, so the BVH
+// is only valid while the model's buffers stay in place.
+struct MeshBvh {
+    std::vector<MeshBvhNode> nodes;
+    std::vector<MeshBvhTriangle> triangles; // Grouped by leaf
+    std::vector<MeshBvhSource> sources;     // One per mesh primitive
+    u32 mesh = UINT32_MAX;
+};
+
+struct MeshHit {
+    f32 distance = FLT_MAX; // Ray parameter; a world distance when the direction is normalized
+    u32 primitive = UINT32_MAX;
+    u32 triangle = UINT32_MAX;
+    f32 u = 0.0f; // Barycentric weights of the triangle's second and third vertex
+    f32 v = 0.0f;
+};
+
+bool build_mesh_bvh(const Model &model, u32 mesh, MeshBvh &bvh, u32 max_leaf_triangles = 4);
+
+// Closest hit in [0, max_distance], both triangle sides count. Leaves are tested four triangles at a time.
+bool intersect_ray(const MeshBvh &bvh, const Vec3 &origin, const Vec3 &direction, f32 max_distance, MeshHit &hit);
+
+// Line-of-sight test: stops at the first hit in [0, max_distance]
+bool intersect_any(const MeshBvh &bvh, const Vec3 &origin, const Vec3 &direction, f32 max_distance);
+
+// Closest hits for `count` rays, traced as packets of four that share one traversal. Works best for coherent rays,
+// e.g. neighbouring picking or visibility samples. Misses leave `hits[i].primitive` at UINT32_MAX.
+void intersect_rays(const MeshBvh &bvh, const Vec3 *origins, const Vec3 *directions, usize count, f32 max_distance,
+                    MeshHit *hits);
+
+}; // namespace gltf
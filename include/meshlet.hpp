@@ -0,0 +1,47 @@
+#pragma once
+
+#include "gltf.hpp"
+#include "types.hpp"
+#include <vector>
+
+namespace gltf {
+
+struct Meshlet {
+    u32 vertex_offset = 0;   // First entry in MeshletMesh::vertices
+    u32 triangle_offset = 0; // First entry in MeshletMesh::triangles (3 per triangle)
+    u32 vertex_count = 0;
+    u32 triangle_count = 0;
+};
+
+// A meshlet is backfacing for a camera at `eye` when dot(normalize(cone_apex - eye), cone_axis) >= cone_cutoff.
+// A cutoff of 1 means the normals spread too wide for cone culling.
+struct MeshletBounds {
+    Vec3 center;
+    f32 radius = 0.0f;
+    Vec3 cone_apex;
+    Vec3 cone_axis;
+    f32 cone_cutoff = 1.0f;
+};
+
+struct MeshletMesh {
+    std::vector<Meshlet> meshlets;
+    std::vector<MeshletBounds> bounds;
+    std::vector<u32> vertices; // Primitive vertex indices referenced by each meshlet
+    std::vector<u8> triangles; // Meshlet-local vertex indices
+};
+
+// Greedily grows meshlets of at most `max_vertices` vertices (<= 255) and `max_triangles` triangles over a triangle
+// list, preferring adjacent triangles that add the fewest new vertices and stay closest to the meshlet center.
+void build_meshlets(MeshletMesh &out, const u32 *indices, usize index_count, const f32 *positions,
+                    usize vertex_count, usize max_vertices, usize max_triangles);
+
+// Builds meshlets and their bounds for an indexed or non-indexed mode 4 primitive
+bool build_meshlets(const Model &model, const Primitive &primitive, MeshletMesh &out, usize max_vertices = 64,
+                    usize max_triangles = 124);
+
+// Builds meshlets for every primitive of every mesh across worker threads; `out[mesh][primitive]` stays empty for
+// primitives that are not triangle lists
+bool build_meshlets(const Model &model, std::vector<std::vector<MeshletMesh>> &out, usize max_vertices = 64,
+                    usize max_triangles = 124);
+
+}; // namespace gltf
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "gltf.hpp"
+#include "types.hpp"
+#include <vector>
+
+namespace gltf {
+
+// Structure-of-arrays copy of the transform fields of Model::nodes, indexed by node. Passes that touch every node
+// each frame (animation, hierarchy evaluation) stream these arrays instead of the nodes, which interleave transforms
+// with names, child lists and other cold data.
+struct NodeTransforms {
+    std::vector<Vec3> translations;
+    std::vector<Vec4> rotations;
+    std::vector<Vec3> scales;
+    std::vector<u8> matrix_nodes; // 1 where the node uses `matrix`, whose value then lives in `locals`
+    std::vector<Mat4> locals;
+    std::vector<Mat4> worlds;
+    std::vector<f32> weights;        // Morph target weights of node n at [weight_offsets[n], weight_offsets[n + 1])
+    std::vector<u32> weight_offsets; // Node count + 1 entries
+    std::vector<u32> parents;        // UINT32_MAX for roots
+    std::vector<u32> order;          // Parents before children
+    std::vector<u8> dirty;           // Per node: edited since the last push_node_transforms()
+    std::vector<u32> edited;         // Nodes with `dirty` set
+};
+
+// Sizes the store for the model's nodes, derives the hierarchy and copies every node's transform and morph weights
+// (the node's, else its mesh's, else zeros for each morph target). Runs again after nodes are added or removed or
+// `children` changes.
+void build_node_transforms(const Model &model, NodeTransforms &transforms);
+
+// Copies the transform of the listed nodes from the model, e.g. after edits through the Model-side API
+void pull_node_transforms(const Model &model, NodeTransforms &transforms, const u32 *nodes, usize count);
+
+// Edits on the store: TRS setters switch a matrix node to TRS and mark the node for push_node_transforms()
+void set_node_translation(NodeTransforms &transforms, u32 node, const Vec3 &translation);
+void set_node_rotation(NodeTransforms &transforms, u32 node, const Vec4 &rotation);
+void set_node_scale(NodeTransforms &transforms, u32 node, const Vec3 &scale);
+void set_node_matrix(NodeTransforms &transforms, u32 node, const Mat4 &matrix);
+void mark_node_dirty(NodeTransforms &transforms, u32 node);
+
+// Writes the edited nodes and their morph weights back to Model::nodes, queues them in Model::transforms and clears
+// the edit list
+void push_node_transforms(NodeTransforms &transforms, Model &model);
+
+// Recomputes `locals` of TRS nodes and `worlds` of every node, in `order`
+void update_node_matrices(NodeTransforms &transforms);
+
+}; // namespace gltf
@@ -0,0 +1,18 @@
+#pragma once
+
+#include "gltf.hpp"
+#include "types.hpp"
+
+namespace gltf {
+
+// Adds a NORMAL accessor to a mode 4 primitive. Smooth normals average the area-weighted face normals of every
+// triangle around a position, so UV seams do not show up as hard edges. Flat normals give each triangle its own
+// vertices, turning the primitive into a non-indexed one. Existing normals are kept unless `overwrite` is set.
+bool generate_normals(Model &model, Primitive &primitive, bool flat = false, bool overwrite = false);
+
+// Adds a TANGENT accessor (xyz tangent, w bitangent sign) to a mode 4 primitive from its NORMAL and TEXCOORD_0,
+// generating smooth normals first if needed. Follows the MikkTSpace construction: per-corner tangents are projected
+// onto the vertex normal and angle-weighted before being averaged. Existing tangents are kept unless `overwrite`.
+bool generate_tangents(Model &model, Primitive &primitive, bool overwrite = false);
+
+}; // namespace gltf
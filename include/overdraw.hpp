@@ -0,0 +1,24 @@
+#pragma once
+
+#include "gltf.hpp"
+#include "types.hpp"
+
+namespace gltf {
+
+// Splits a cache-optimized triangle list into clusters and sorts them so outward-facing clusters draw first.
+// `threshold` bounds the vertex cache regression: each cluster may have an ACMR of at most threshold times the ACMR
+// of the cache run it was split from (1.05 is a good default). At 1.0 or below clusters are only split where the
+// cache-optimized order already restarted with three misses, and are moved as a whole.
+void optimize_overdraw(u32 *indices, usize index_count, const f32 *positions, usize vertex_count, usize cache_size,
+                       f32 threshold);
+
+// Reorders the index accessor of an indexed mode 4 primitive in place. Primitives whose material uses BLEND are left
+// untouched, since their draw order is visible. Run optimize_vertex_cache() first.
+bool optimize_overdraw(Model &model, Primitive &primitive, f32 threshold = 1.05f, usize cache_size = 16);
+
+// Applies optimize_overdraw() to every opaque triangle primitive, spreading index accessors across worker threads.
+// An accessor shared by several primitives is reordered once; accessors overlapping another accessor's bytes are
+// first moved to their own copy (see unshare_accessors()).
+bool optimize_overdraw(Model &model, f32 threshold = 1.05f, usize cache_size = 16);
+
+}; // namespace gltf
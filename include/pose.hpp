@@ -0,0 +1,58 @@
+#pragma once
+
+#include "animation.hpp"
+#include "gltf.hpp"
+#include "node_transforms.hpp"
+#include "types.hpp"
+#include <vector>
+
+namespace gltf {
+
+// Local transforms of the joints of a skeleton as contiguous arrays, indexed by joint. Blending streams these
+// arrays four joints per SIMD operation.
+struct Pose {
+    std::vector<Vec3> translations;
+    std::vector<Vec4> rotations;
+    std::vector<Vec3> scales;
+};
+
+// Joints of one skin, in the order of Skin::joints
+struct Skeleton {
+    u32 skin = UINT32_MAX;
+    std::vector<u32> joints;      // Model node of every joint
+    std::vector<u32> parents;     // Joint of the closest ancestor that is a joint, UINT32_MAX for none
+    std::vector<u32> node_joints; // Model node -> joint, UINT32_MAX for nodes outside the skin
+    Pose rest;                    // The joints' node transforms at build time, matrices decomposed
+};
+
+// Resolves the joints of `skin`. Fails when the skin or one of its joints does not exist.
+bool build_skeleton(const Model &model, u32 skin, Skeleton &skeleton);
+
+// Sizes `pose` for the skeleton and fills it with the rest pose. The blending functions below never allocate once
+// their output has been initialized this way, so each character can keep its poses across frames and update them on
+// any worker thread.
+void init_pose(const Skeleton &skeleton, Pose &pose);
+
+// Per-joint weights: `weight` for `joint` and its descendants, 0 elsewhere, e.g. to layer an upper-body clip
+void build_joint_mask(const Skeleton &skeleton, u32 joint, f32 weight, std::vector<f32> &mask);
+
+// Rest pose overwritten by the clip's translation, rotation and scale tracks that target joints of the skeleton
+void sample_pose(const Skeleton &skeleton, const AnimationClip &clip, f32 time, AnimationCursor &cursor, Pose &pose);
+
+// Cross-fade: joint j moves from `a` to `b` by weight * mask[j] (by `weight` alone when `mask` is null).
+// Translations and scales are lerped, rotations nlerped along the shorter arc. `out` may alias `a` or `b`.
+void blend_poses(const Pose &a, const Pose &b, f32 weight, const f32 *mask, Pose &out);
+
+// Difference of `pose` from `reference` for add_pose(): translation offsets, rotations relative to the reference
+// rotation and scale ratios
+void make_additive_pose(const Pose &pose, const Pose &reference, Pose &additive);
+
+// Layers an additive pose onto `base` by weight * mask[j], so adding make_additive_pose(p, r) to `r` at weight 1
+// yields `p`. `out` may alias `base`.
+void add_pose(const Pose &base, const Pose &additive, f32 weight, const f32 *mask, Pose &out);
+
+// Writes the pose to the skeleton's joint nodes
+void apply_pose(const Skeleton &skeleton, const Pose &pose, NodeTransforms &transforms);
+void apply_pose(const Skeleton &skeleton, const Pose &pose, Model &model);
+
+}; // namespace gltf
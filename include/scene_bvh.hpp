@@ -0,0 +1,62 @@
+#pragma once
+
+#include "gltf.hpp"
+#include "types.hpp"
+#include <vector>
+
+namespace gltf {
+
+// One mesh primitive instanced by one node, with its world-space box
+struct SceneBvhItem {
+    u32 node = 0;
+    u32 mesh = 0;
+    u32 primitive = 0;
+    Vec3 min;
+    Vec3 max;
+};
+
+// 32-byte flattened node. Inner nodes have `count` 0 and their children at `first` and `first + 1`; leaves reference
+// `count` items starting at `first`. Children always come after their parent.
+struct SceneBvhNode {
+    Vec3 min;
+    u32 first = 0;
+    Vec3 max;
+    u32 count = 0;
+};
+
+struct SceneBvh {
+    std::vector<SceneBvhNode> nodes; // nodes[0] is the root
+    std::vector<SceneBvhItem> items; // Grouped by leaf
+    u32 scene = UINT32_MAX;
+};
+
+// Six planes (x, y, z normal, w distance); points with dot(xyz, p) + w >= 0 are inside
+struct Frustum {
+    Vec4 planes[6];
+};
+
+struct SceneBvhHit {
+    u32 item = 0;        // Index into SceneBvh::items
+    f32 distance = 0.0f; // Ray parameter where the item box is entered
+};
+
+// Extracts the planes of an OpenGL-style (-w <= z <= w) view-projection matrix, as produced for glTF cameras
+Frustum frustum_from_matrix(const Mat4 &view_projection);
+
+// Builds a binned-SAH BVH over the world-space bounds of every primitive reachable from `scene`. World bounds come
+// from update_bounds(), which is called first. The upper levels are split on the calling thread, the subtrees below
+// them are built in parallel and spliced into one flat array.
+bool build_scene_bvh(Model &model, u32 scene, SceneBvh &bvh, u32 max_leaf_items = 4);
+
+// Recomputes item boxes from the current node transforms and refits every BVH node bottom-up without changing the
+// topology. Cheap enough to run per frame after animation; rebuild when objects move far from where they started.
+void refit_scene_bvh(Model &model, SceneBvh &bvh);
+
+// Queries append indices into `bvh.items` whose boxes pass the test. Frustum and box queries are conservative box
+// tests; ray hits are sorted by entry distance and limited to [0, max_distance].
+void query_frustum(const SceneBvh &bvh, const Frustum &frustum, std::vector<u32> &items);
+void query_aabb(const SceneBvh &bvh, const Vec3 &min, const Vec3 &max, std::vector<u32> &items);
+void query_ray(const SceneBvh &bvh, const Vec3 &origin, const Vec3 &direction, f32 max_distance,
+               std::vector<SceneBvhHit> &hits);
+
+}; // namespace gltf
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "gltf.hpp"
+#include "types.hpp"
+#include <vector>
+
+namespace gltf {
+
+struct SimplifyOptions {
+    f32 target_ratio = 0.5f;  // Fraction of triangles to keep
+    f32 target_error = 0.01f; // Maximum geometric deviation, relative to the mesh extent
+    bool lock_border = false; // Keep open mesh borders in place (e.g. for meshes stitched to neighbours)
+};
+
+// Quadric error metric edge-collapse simplification of a triangle list. Vertices only ever move onto other existing
+// vertices, so attribute data stays valid. Vertices sharing a position with different attributes (UV / normal seams)
+// collapse together along the seam, and open borders only collapse along the border. Returns the number of indices
+// written to `destination`, which must hold `index_count` entries. `result_error` receives the relative error reached.
+usize simplify(u32 *destination, const u32 *indices, usize index_count, const f32 *positions, usize vertex_count,
+               usize target_index_count, f32 target_error, bool lock_border, f32 *result_error = nullptr);
+
+// Writes a simplified copy of `source` into `out`, sharing its vertex accessors and adding a new index accessor
+bool simplify_primitive(Model &model, const Primitive &source, Primitive &out,
+                        const SimplifyOptions &options = SimplifyOptions(), f32 *result_error = nullptr);
+
+struct LodOptions {
+    std::vector<f32> ratios = {0.5f, 0.25f, 0.125f};
+    f32 target_error = 0.05f;
+    bool lock_border = false;
+    // Also create a node per level and link them from the source node through the MSFT_lod extension
+    bool msft_lod = false;
+};
+
+// Builds one simplified mesh per ratio for every mesh in the model, simplifying primitives across worker threads.
+// `lod_meshes[mesh]` receives the new mesh indices, finest first.
+bool generate_lods(Model &model, const LodOptions &options = LodOptions(),
+                   std::vector<std::vector<u32>> *lod_meshes = nullptr);
+
+}; // namespace gltf
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "gltf.hpp"
+#include "types.hpp"
+#include <vector>
+
+namespace gltf {
+
+// Skinning matrices of one skin, indexed by joint: world(joint) * inverse bind matrix
+struct JointPalette {
+    u32 skin = UINT32_MAX;
+    std::vector<u32> joints;         // Model node of every joint
+    std::vector<Mat4> inverse_binds; // Identity when the skin has no inverse bind matrices
+    std::vector<Mat4> matrices;
+
+    // The matrices split into a rigid part and a scale, 12 floats per joint: rotation (x, y, z, w), dual part of the
+    // unit dual quaternion (x, y, z, w) and scale (x, y, z, 0). Empty unless built for dual quaternion skinning.
+    std::vector<f32> dual_quaternions;
+};
+
+// Resolves the joints and reads the inverse bind matrices of `skin`; the matrices start out as identity. With
+// `dual_quaternions`, update_joint_palette() also fills JointPalette::dual_quaternions.
+bool build_joint_palette(const Model &model, u32 skin, JointPalette &palette, bool dual_quaternions = false);
+
+// Recomputes the skinning matrices from world matrices indexed by model node, such as Model::transforms.world or
+// NodeTransforms::worlds. Skinned vertices come out in world space, ignoring the transform of the mesh node as glTF
+// requires; passing `mesh_node` brings them into that node's local space instead.
+bool update_joint_palette(JointPalette &palette, const std::vector<Mat4> &worlds, u32 mesh_node = UINT32_MAX);
+
+// Bind pose of a skinned primitive, decoded once so every frame only streams tightly packed floats. Each vertex keeps
+// four influences per JOINTS_n / WEIGHTS_n pair, with weights renormalized to sum to 1 and sorted heaviest first.
+struct SkinBinding {
+    usize vertex_count = 0;
+    u32 influences = 0;       // Influences per vertex
+    u32 joint_count = 0;      // One past the largest joint index referenced
+    std::vector<u32> joints;  // vertex * influences + k
+    std::vector<f32> weights; // vertex * influences + k
+    std::vector<Vec3> positions;
+    std::vector<Vec3> normals;  // Empty without a NORMAL attribute
+    std::vector<Vec4> tangents; // Empty without a TANGENT attribute
+};
+
+// Decodes POSITION, NORMAL, TANGENT and every JOINTS_n / WEIGHTS_n pair of `primitive`, accepting any component type
+// the attributes are stored as. Vertices whose weights are all zero follow their first joint.
+bool bind_skinned_primitive(const Model &model, const Primitive &primitive, SkinBinding &binding);
+
+struct SkinnedVertices {
+    std::vector<Vec3> positions;
+    std::vector<Vec3> normals;
+    std::vector<Vec4> tangents; // w keeps the bitangent sign of the bind pose
+};
+
+// Linear blend skinning: every vertex is transformed by the weighted sum of its joints' palette matrices. Normals
+// and tangents use the upper 3x3 of that matrix and are renormalized, which is exact for rotations and uniform
+// scales. `out` is only resized when its size differs from the binding, so it can be reused across frames. Vertices
+// are processed in parallel blocks.
+bool skin_vertices(const SkinBinding &binding, const JointPalette &palette, SkinnedVertices &out);
+
+// Dual quaternion skinning: blends the joints' rigid transforms as dual quaternions, which keeps volume where linear
+// blending collapses twisted joints into a "candy wrapper". Joint scales are blended linearly and applied before the
+// rigid transform; shear in the palette matrices is dropped. Needs a palette built with `dual_quaternions`. Vertices
+// are processed four at a time in parallel blocks.
+bool skin_vertices_dual_quaternion(const SkinBinding &binding, const JointPalette &palette, SkinnedVertices &out);
+
+}; // namespace gltf
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "gltf.hpp"
+#include "types.hpp"
+
+namespace gltf {
+
+// Primitive modes
+constexpr i32 MODE_POINTS = 0;
+constexpr i32 MODE_LINES = 1;
+constexpr i32 MODE_LINE_LOOP = 2;
+constexpr i32 MODE_LINE_STRIP = 3;
+constexpr i32 MODE_TRIANGLES = 4;
+constexpr i32 MODE_TRIANGLE_STRIP = 5;
+constexpr i32 MODE_TRIANGLE_FAN = 6;
+
+// Index value used to restart strips and fans in the u32 kernels below; it becomes 0xffff / 0xff when written with a
+// narrower component type
+constexpr u32 RESTART_INDEX = UINT32_MAX;
+
+// Triangle list from a strip or fan, following the glTF winding rules. Degenerate triangles are dropped and
+// RESTART_INDEX starts a new strip / fan. `destination` must hold (count - 2) * 3 indices. Returns indices written.
+usize strip_to_list(u32 *destination, const u32 *indices, usize count);
+usize fan_to_list(u32 *destination, const u32 *indices, usize count);
+
+// Greedy stripification of a triangle list. Strips are separated by RESTART_INDEX when `use_restart` is set, or
+// stitched with degenerate triangles otherwise. `destination` must hold (count / 3) * 6 indices. Returns indices
+// written.
+usize list_to_strip(u32 *destination, const u32 *indices, usize count, bool use_restart);
+
+// Rewrites a TRIANGLE_STRIP or TRIANGLE_FAN primitive (indexed or not) as an indexed TRIANGLES primitive
+bool convert_to_triangles(Model &model, Primitive &primitive);
+
+// Rewrites a TRIANGLES primitive as an indexed TRIANGLE_STRIP. With `only_if_smaller`, the primitive is left as a list
+// when the strip would need more indices. Primitive restart is not part of core glTF, so `use_restart` is meant for
+// runtime use rather than for files that are saved.
+bool convert_to_strip(Model &model, Primitive &primitive, bool use_restart = false, bool only_if_smaller = true);
+
+}; // namespace gltf
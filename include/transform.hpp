@@ -0,0 +1,60 @@
+#pragma once
+
+#include "gltf.hpp"
+#include "types.hpp"
+#include <vector>
+
+namespace gltf {
+
+// Local matrix of a node: `matrix` when set, T * R * S otherwise
+Mat4 local_transform(const Node &node);
+
+// World matrices of the nodes of one scene, stored contiguously in topological order. Entries [0, trunk_end) are the
+// upper levels of large hierarchies and are evaluated on the calling thread; the remaining entries are grouped into
+// independent subtree ranges [ranges[j], ranges[j + 1]) that only depend on the trunk and are evaluated in parallel.
+struct WorldTransforms {
+    u32 scene = UINT32_MAX;
+    std::vector<u32> nodes;     // Model node of every entry, parents before children
+    std::vector<u32> parents;   // Entry of the parent, UINT32_MAX for scene roots
+    std::vector<u32> entries;   // Model node -> entry, UINT32_MAX for nodes outside the scene
+    std::vector<Mat4> matrices; // World matrix of every entry
+    u32 trunk_end = 0;
+    std::vector<u32> ranges;
+};
+
+// Lays out the entries of `scene`. Only needs to run again when the hierarchy changes.
+bool build_transform_order(const Model &model, u32 scene, WorldTransforms &transforms);
+
+// Recomputes every world matrix from the current node transforms using an existing layout
+void update_world_transforms(const Model &model, WorldTransforms &transforms);
+
+// build_transform_order() followed by update_world_transforms()
+bool compute_world_transforms(const Model &model, u32 scene, WorldTransforms &transforms);
+
+// Parent of every node (UINT32_MAX for roots) and an order listing parents before children, covering all nodes of the
+// model. A node listed as a child more than once keeps its first parent; cycles are broken by detaching a node.
+void build_node_hierarchy(const Model &model, std::vector<u32> &parents, std::vector<u32> &order);
+
+// Edits through Model::transforms: each setter changes the node and queues it, update_transforms() then recomputes
+// only the queued nodes and their descendants. Setting a TRS component on a node that uses `matrix` decomposes the
+// matrix first and switches the node to TRS.
+void set_translation(Model &model, u32 node, const Vec3 &translation);
+void set_rotation(Model &model, u32 node, const Vec4 &rotation);
+void set_scale(Model &model, u32 node, const Vec3 &scale);
+void set_matrix(Model &model, u32 node, const Mat4 &matrix);
+
+// Queues a node whose fields were edited directly
+void mark_transform_dirty(Model &model, u32 node);
+
+// Brings Model::transforms.world up to date and lists the recomputed nodes in Model::transforms.changed, which the
+// next call overwrites. The recomputed subtrees are also queued for update_bounds() in Model::bounds. The first call,
+// and the first after invalidate_transforms(), evaluates every node.
+void update_transforms(Model &model);
+
+// Cached world matrix of a node as of the last update_transforms()
+const Mat4 &world_transform(const Model &model, u32 node);
+
+// Forces a full rebuild, required after changing `children` or adding and removing nodes
+void invalidate_transforms(Model &model);
+
+}; // namespace gltf
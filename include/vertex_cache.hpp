@@ -0,0 +1,38 @@
+#pragma once
+
+#include "gltf.hpp"
+#include "types.hpp"
+
+namespace gltf {
+
+struct VertexCacheStats {
+    usize triangles = 0;
+    usize vertices = 0;       // Distinct vertices referenced by the index buffer
+    usize transforms = 0;     // Simulated FIFO cache misses
+    f32 acmr = 0.0f;          // Average cache miss ratio, transforms per triangle (0.5 - 3.0)
+    f32 atvr = 0.0f;          // Average transform to vertex ratio (1.0 is optimal)
+};
+
+struct VertexCacheReport {
+    VertexCacheStats before;
+    VertexCacheStats after;
+};
+
+// Simulates a FIFO post-transform cache of `cache_size` entries over a triangle list
+VertexCacheStats analyze_vertex_cache(const u32 *indices, usize index_count, usize vertex_count, usize cache_size);
+
+// Reorders the triangles of a triangle list in place for post-transform cache locality (Tipsify)
+void optimize_vertex_cache(u32 *indices, usize index_count, usize vertex_count, usize cache_size);
+
+// Optimizes the index accessor of a mode 4 (TRIANGLES) primitive in place. Non-indexed or non-triangle primitives are
+// left untouched and reported as success.
+bool optimize_vertex_cache(Model &model, Primitive &primitive, usize cache_size = 16,
+                           VertexCacheReport *report = nullptr);
+
+// Optimizes every triangle primitive of every mesh, spreading primitives across worker threads. An index accessor
+// shared by several primitives is processed once; accessors whose bytes overlap another accessor's are first moved
+// to their own copy (see unshare_accessors()), so no accessor is reordered under another. `report` accumulates
+// totals over all processed accessors.
+bool optimize_vertex_cache(Model &model, usize cache_size = 16, VertexCacheReport *report = nullptr);
+
+}; // namespace gltf
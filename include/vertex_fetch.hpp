@@ -0,0 +1,16 @@
+#pragma once
+
+#include "gltf.hpp"
+#include "types.hpp"
+
+namespace gltf {
+
+// Fills `remap` (vertex_count entries) so vertices are numbered in order of first use by `indices`; unreferenced
+// vertices map to UINT32_MAX. Returns the number of referenced vertices.
+usize build_vertex_fetch_remap(u32 *remap, const u32 *indices, usize index_count, usize vertex_count);
+
+// Rewrites all attribute accessors of an indexed primitive into first-use order, dropping unreferenced vertices, and
+// replaces its index accessor with one referencing the new vertex order. Best run after optimize_vertex_cache().
+bool optimize_vertex_fetch(Model &model, Primitive &primitive);
+
+}; // namespace gltf
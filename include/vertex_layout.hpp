@@ -0,0 +1,19 @@
+#pragma once
+
+#include "gltf.hpp"
+#include "types.hpp"
+#include <string>
+#include <vector>
+
+namespace gltf {
+
+// Rewrites all attributes of `primitive` into a single interleaved buffer view. Attributes named in `order` come
+// first, in that order, followed by the remaining ones. Each attribute starts at a multiple of `alignment` (at least
+// 4, as required by the spec) and the vertex stride is padded to the same alignment.
+bool interleave_primitive(Model &model, Primitive &primitive, const std::vector<std::string> &order,
+                          usize alignment = 4);
+
+// Rewrites every attribute of `primitive` into its own tightly packed buffer view (structure-of-arrays)
+bool deinterleave_primitive(Model &model, Primitive &primitive, usize alignment = 4);
+
+}; // namespace gltf
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "gltf.hpp"
+#include "types.hpp"
+
+namespace gltf {
+
+struct WeldOptions {
+    // When non-zero, float POSITION / NORMAL components are snapped to a grid of this size and vertices merge when they
+    // land in the same cell, so merged values differ by less than the epsilon. This is grid snapping, not a distance
+    // test: values closer than the epsilon but on opposite sides of a cell boundary stay separate.
+    f32 position_epsilon = 0.0f;
+    f32 normal_epsilon = 0.0f;
+};
+
+struct WeldStats {
+    usize vertices_before = 0;
+    usize vertices_after = 0;
+};
+
+// Merges vertices of `primitive` whose attribute values are identical (or share a grid cell, see WeldOptions), writing
+// the unique vertices into new accessors and adding / rewriting the index accessor to reference them.
+bool weld_primitive(Model &model, Primitive &primitive, const WeldOptions &options = WeldOptions(),
+                    WeldStats *stats = nullptr);
+
+}; // namespace gltf
@@ -0,0 +1,605 @@
+#include "accessor.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+namespace gltf {
+
+usize component_size(i32 component_type) {
+    switch (component_type) {
+    case COMPONENT_BYTE:
+    case COMPONENT_UNSIGNED_BYTE:
+        return 1;
+    case COMPONENT_SHORT:
+    case COMPONENT_UNSIGNED_SHORT:
+        return 2;
+    case COMPONENT_UNSIGNED_INT:
+    case COMPONENT_FLOAT:
+        return 4;
+    default:
+        return 0;
+    }
+}
+
+usize component_count(const std::string &type) {
+    if (type == "SCALAR") return 1;
+    if (type == "VEC2") return 2;
+    if (type == "VEC3") return 3;
+    if (type == "VEC4") return 4;
+    if (type == "MAT2") return 4;
+    if (type == "MAT3") return 9;
+    if (type == "MAT4") return 16;
+    return 0;
+}
+
+usize element_size(const Accessor &accessor) {
+    return component_size(accessor.component_type) * component_count(accessor.type);
+}
+
+bool view_accessor(const Model &model, u32 accessor, AccessorView &out) {
+    if (accessor >= model.accessors.size()) return false;
+
+    const Accessor &acc = model.accessors[accessor];
+    if (acc.buffer_view >= model.buffer_views.size()) return false;
+
+    const BufferView &view = model.buffer_views[acc.buffer_view];
+    if (view.buffer >= model.buffers.size()) return false;
+
+    const Buffer &buffer = model.buffers[view.buffer];
+    if (!buffer.loaded) return false;
+
+    usize size = element_size(acc);
+    if (size == 0) return false;
+
+    usize stride = view.byte_stride != 0 ? view.byte_stride : size;
+    usize start = view.byte_offset + acc.byte_offset;
+    if (acc.count > 0 && start + (acc.count - 1) * stride + size > buffer.data.size()) return false;
+
+    out.data = buffer.data.data() + start;
+    out.stride = stride;
+    out.count = acc.count;
+    out.components = component_count(acc.type);
+    out.component_type = acc.component_type;
+    out.normalized = acc.normalized;
+    return true;
+}
+
+void read_components(const u8 *src, i32 component_type, bool normalized, usize n, f32 *out) {
+    for (usize i = 0; i < n; i++) {
+        switch (component_type) {
+        case COMPONENT_FLOAT: {
+            f32 v;
+            std::memcpy(&v, src + i * 4, 4);
+            out[i] = v;
+        } break;
+        case COMPONENT_BYTE: {
+            i8 v = (i8)src[i];
+            out[i] = normalized ? std::max(v / 127.0f, -1.0f) : (f32)v;
+        } break;
+        case COMPONENT_UNSIGNED_BYTE: {
+            u8 v = src[i];
+            out[i] = normalized ? v / 255.0f : (f32)v;
+        } break;
+        case COMPONENT_SHORT: {
+            i16 v;
+            std::memcpy(&v, src + i * 2, 2);
+            out[i] = normalized ? std::max(v / 32767.0f, -1.0f) : (f32)v;
+        } break;
+        case COMPONENT_UNSIGNED_SHORT: {
+            u16 v;
+            std::memcpy(&v, src + i * 2, 2);
+            out[i] = normalized ? v / 65535.0f : (f32)v;
+        } break;
+        case COMPONENT_UNSIGNED_INT: {
+            u32 v;
+            std::memcpy(&v, src + i * 4, 4);
+            out[i] = (f32)v;
+        } break;
+        default:
+            out[i] = 0.0f;
+        }
+    }
+}
+
+void write_components(u8 *dst, i32 component_type, bool normalized, usize n, const f32 *in) {
+    for (usize i = 0; i < n; i++) {
+        f32 v = in[i];
+        switch (component_type) {
+        case COMPONENT_FLOAT:
+            std::memcpy(dst + i * 4, &v, 4);
+            break;
+        case COMPONENT_BYTE: {
+            i8 q = (i8)(normalized ? std::round(std::min(std::max(v, -1.0f), 1.0f) * 127.0f) : v);
+            dst[i] = (u8)q;
+        } break;
+        case COMPONENT_UNSIGNED_BYTE:
+            dst[i] = (u8)(normalized ? std::round(std::min(std::max(v, 0.0f), 1.0f) * 255.0f) : v);
+            break;
+        case COMPONENT_SHORT: {
+            i16 q = (i16)(normalized ? std::round(std::min(std::max(v, -1.0f), 1.0f) * 32767.0f) : v);
+            std::memcpy(dst + i * 2, &q, 2);
+        } break;
+        case COMPONENT_UNSIGNED_SHORT: {
+            u16 q = (u16)(normalized ? std::round(std::min(std::max(v, 0.0f), 1.0f) * 65535.0f) : v);
+            std::memcpy(dst + i * 2, &q, 2);
+        } break;
+        case COMPONENT_UNSIGNED_INT: {
+            u32 q = (u32)v;
+            std::memcpy(dst + i * 4, &q, 4);
+        } break;
+        default:
+            break;
+        }
+    }
+}
+
+u32 read_index(const u8 *src, i32 component_type) {
+    switch (component_type) {
+    case COMPONENT_UNSIGNED_BYTE:
+        return src[0];
+    case COMPONENT_UNSIGNED_SHORT: {
+        u16 v;
+        std::memcpy(&v, src, 2);
+        return v;
+    }
+    case COMPONENT_UNSIGNED_INT: {
+        u32 v;
+        std::memcpy(&v, src, 4);
+        return v;
+    }
+    default:
+        return 0;
+    }
+}
+
+void write_index(u8 *dst, i32 component_type, u32 value) {
+    switch (component_type) {
+    case COMPONENT_UNSIGNED_BYTE:
+        dst[0] = (u8)value;
+        break;
+    case COMPONENT_UNSIGNED_SHORT: {
+        u16 v = (u16)value;
+        std::memcpy(dst, &v, 2);
+    } break;
+    case COMPONENT_UNSIGNED_INT:
+        std::memcpy(dst, &value, 4);
+        break;
+    default:
+        break;
+    }
+}
+
+bool read_indices(const Model &model, u32 accessor, usize vertex_count, std::vector<u32> &out) {
+    if (accessor == UINT32_MAX) {
+        out.resize(vertex_count);
+        for (usize i = 0; i < vertex_count; i++) {
+            out[i] = (u32)i;
+        }
+        return true;
+    }
+
+    AccessorView view;
+    if (!view_accessor(model, accessor, view) || view.components != 1) return false;
+
+    out.resize(view.count);
+    for (usize i = 0; i < view.count; i++) {
+        out[i] = read_index(view.element(i), view.component_type);
+    }
+
+    return true;
+}
+
+bool write_indices(Model &model, u32 accessor, const std::vector<u32> &indices) {
+    AccessorView view;
+    if (!view_accessor(model, accessor, view) || view.components != 1 || view.count != indices.size()) return false;
+
+    // The view points into the model's own buffer, so it is safe to write through
+    u8 *data = const_cast<u8 *>(view.data);
+    for (usize i = 0; i < indices.size(); i++) {
+        write_index(data + i * view.stride, view.component_type, indices[i]);
+    }
+
+    return true;
+}
+
+bool read_floats(const Model &model, u32 accessor, std::vector<f32> &out) {
+    AccessorView view;
+    if (!view_accessor(model, accessor, view)) return false;
+
+    out.resize(view.count * view.components);
+    for (usize i = 0; i < view.count; i++) {
+        read_components(view.element(i), view.component_type, view.normalized, view.components,
+                        out.data() + i * view.components);
+    }
+
+    return true;
+}
+
+u32 add_buffer(Model &model, std::vector<u8> data) {
+    Buffer buffer;
+    buffer.byte_length = data.size();
+    buffer.data = std::move(data);
+    buffer.loaded = true;
+
+    model.buffers.push_back(std::move(buffer));
+    return (u32)(model.buffers.size() - 1);
+}
+
+u32 add_buffer_view(Model &model, u32 buffer, usize byte_offset, usize byte_length, usize byte_stride, i32 target) {
+    BufferView view;
+    view.buffer = buffer;
+    view.byte_offset = byte_offset;
+    view.byte_length = byte_length;
+    view.byte_stride = byte_stride;
+    view.target = target;
+
+    model.buffer_views.push_back(view);
+    return (u32)(model.buffer_views.size() - 1);
+}
+
+u32 add_accessor(Model &model, const Accessor &accessor) {
+    model.accessors.push_back(accessor);
+    return (u32)(model.accessors.size() - 1);
+}
+
+u32 append_buffer_view(Model &model, const void *data, usize byte_length, usize byte_stride, i32 target,
+                       usize alignment) {
+    // Loaded or external buffers are never grown; the working buffer is one the helpers created themselves
+    if (model.working_buffer >= model.buffers.size() || !model.buffers[model.working_buffer].loaded ||
+        !model.buffers[model.working_buffer].uri.empty()) {
+        model.working_buffer = add_buffer(model, {});
+    }
+
+    // Views are kept at least 4-byte aligned so every accessor within them stays aligned to its component size
+    Buffer &buffer = model.buffers[model.working_buffer];
+    alignment = std::max<usize>((alignment + 3) & ~(usize)3, 4);
+    usize offset = (buffer.data.size() + alignment - 1) / alignment * alignment;
+    buffer.data.resize(offset + byte_length, 0);
+    if (byte_length > 0) std::memcpy(buffer.data.data() + offset, data, byte_length);
+    buffer.byte_length = buffer.data.size();
+
+    return add_buffer_view(model, model.working_buffer, offset, byte_length, byte_stride, target);
+}
+
+usize unshare_accessors(Model &model, const std::vector<u32> &accessors) {
+    struct Range {
+        u32 buffer;
+        usize begin;
+        usize end;
+        u32 accessor;
+    };
+
+    // Bytes of every readable accessor within its buffer, whichever view it goes through
+    std::vector<Range> ranges;
+    for (u32 a = 0; a < model.accessors.size(); a++) {
+        AccessorView view;
+        if (!view_accessor(model, a, view) || view.count == 0) continue;
+
+        u32 buffer = model.buffer_views[model.accessors[a].buffer_view].buffer;
+        usize begin = (usize)(view.data - model.buffers[buffer].data.data());
+        usize end = begin + (view.count - 1) * view.stride + element_size(model.accessors[a]);
+        ranges.push_back({buffer, begin, end, a});
+    }
+    std::sort(ranges.begin(), ranges.end(), [](const Range &a, const Range &b) {
+        return a.buffer != b.buffer ? a.buffer < b.buffer : a.begin < b.begin;
+    });
+
+    // Ranges still open where another one begins overlap it
+    std::vector<u8> shared(model.accessors.size(), 0);
+    std::vector<const Range *> open;
+    for (const Range &range : ranges) {
+        open.erase(std::remove_if(open.begin(), open.end(),
+                                  [&](const Range *r) { return r->buffer != range.buffer || r->end <= range.begin; }),
+                   open.end());
+        for (const Range *r : open) shared[r->accessor] = shared[range.accessor] = 1;
+        open.push_back(&range);
+    }
+
+    usize copied = 0;
+    std::vector<u8> data;
+    for (u32 a : accessors) {
+        if (a >= model.accessors.size() || !shared[a]) continue;
+        shared[a] = 0;
+
+        AccessorView view;
+        view_accessor(model, a, view);
+        Accessor &accessor = model.accessors[a];
+        i32 target = model.buffer_views[accessor.buffer_view].target;
+
+        // Vertex attribute elements must start on 4-byte boundaries
+        usize size = element_size(accessor);
+        usize stride = target == TARGET_ARRAY_BUFFER ? (size + 3) & ~(usize)3 : size;
+        data.assign(view.count * stride, 0);
+        for (usize i = 0; i < view.count; i++) std::memcpy(data.data() + i * stride, view.element(i), size);
+
+        accessor.buffer_view = append_buffer_view(model, data.data(), data.size(), stride == size ? 0 : stride, target,
+                                                  component_size(accessor.component_type));
+        accessor.byte_offset = 0;
+        copied++;
+    }
+    return copied;
+}
+
+u32 add_index_accessor(Model &model, const std::vector<u32> &indices, u32 vertex_count) {
+    // 0xffff is reserved as the primitive restart value
+    i32 component_type = vertex_count < 0xffff ? COMPONENT_UNSIGNED_SHORT : COMPONENT_UNSIGNED_INT;
+    usize size = component_size(component_type);
+
+    std::vector<u8> data(indices.size() * size);
+    for (usize i = 0; i < indices.size(); i++) {
+        write_index(data.data() + i * size, component_type, indices[i]);
+    }
+
+    u32 view = append_buffer_view(model, data.data(), data.size(), 0, TARGET_ELEMENT_ARRAY_BUFFER);
+
+    Accessor accessor;
+    accessor.buffer_view = view;
+    accessor.component_type = component_type;
+    accessor.count = indices.size();
+    accessor.type = "SCALAR";
+    return add_accessor(model, accessor);
+}
+
+u32 add_float_accessor(Model &model, const std::vector<f32> &values, const std::string &type, i32 target) {
+    usize components = component_count(type);
+    if (components == 0) return UINT32_MAX;
+
+    u32 view = append_buffer_view(model, values.data(), values.size() * sizeof(f32), 0, target);
+
+    Accessor accessor;
+    accessor.buffer_view = view;
+    accessor.component_type = COMPONENT_FLOAT;
+    accessor.count = values.size() / components;
+    accessor.type = type;
+
+    if (accessor.count > 0) {
+        accessor.min.assign(values.begin(), values.begin() + components);
+        accessor.max.assign(values.begin(), values.begin() + components);
+        for (usize i = 1; i < accessor.count; i++) {
+            for (usize c = 0; c < components; c++) {
+                accessor.min[c] = std::min(accessor.min[c], values[i * components + c]);
+                accessor.max[c] = std::max(accessor.max[c], values[i * components + c]);
+            }
+        }
+    }
+
+    return add_accessor(model, accessor);
+}
+
+// Recomputes min / max of an accessor whose elements live at `data` with `stride` bytes between them
+static void update_min_max(Accessor &accessor, const u8 *data, usize stride) {
+    usize components = component_count(accessor.type);
+    accessor.min.assign(components, 0.0f);
+    accessor.max.assign(components, 0.0f);
+
+    f32 value[16];
+    for (usize i = 0; i < accessor.count; i++) {
+        read_components(data + i * stride, accessor.component_type, accessor.normalized, components, value);
+        for (usize c = 0; c < components; c++) {
+            accessor.min[c] = i == 0 ? value[c] : std::min(accessor.min[c], value[c]);
+            accessor.max[c] = i == 0 ? value[c] : std::max(accessor.max[c], value[c]);
+        }
+    }
+}
+
+bool remap_vertices(Model &model, Primitive &primitive, const std::vector<u32> &remap, usize vertex_count) {
+    std::vector<u32> source(vertex_count, 0);
+    for (usize i = 0; i < remap.size(); i++) {
+        if (remap[i] == UINT32_MAX) continue;
+        if (remap[i] >= vertex_count) return false;
+        source[remap[i]] = (u32)i;
+    }
+
+    if (primitive_vertex_count(model, primitive) != remap.size()) return false;
+    return gather_vertices(model, primitive, source);
+}
+
+bool gather_vertices(Model &model, Primitive &primitive, const std::vector<u32> &source) {
+    usize vertex_count = source.size();
+
+    struct Stream {
+        std::map<std::string, u32> *owner;
+        std::string name;
+        u32 accessor;
+        AccessorView view;
+        usize size;
+        usize stride;
+        usize offset;
+    };
+
+    // Morph target displacements are per-vertex too and are gathered along with the attributes
+    std::vector<std::map<std::string, u32> *> owners(1, &primitive.attributes);
+    for (auto &target : primitive.targets) owners.push_back(&target);
+
+    std::vector<Stream> streams;
+    usize length = 0;
+    for (std::map<std::string, u32> *owner : owners) {
+        for (const auto &attr : *owner) {
+            Stream stream;
+            stream.owner = owner;
+            stream.name = attr.first;
+            stream.accessor = attr.second;
+            if (!view_accessor(model, attr.second, stream.view)) return false;
+
+            // Vertex attribute elements must start on 4-byte boundaries
+            stream.size = element_size(model.accessors[attr.second]);
+            stream.stride = (stream.size + 3) & ~(usize)3;
+            stream.offset = length;
+            length += stream.stride * vertex_count;
+            streams.push_back(stream);
+        }
+    }
+
+    std::vector<u8> data(length, 0);
+    for (const Stream &stream : streams) {
+        u8 *dst = data.data() + stream.offset;
+        for (usize i = 0; i < vertex_count; i++) {
+            if (source[i] >= stream.view.count) return false;
+            std::memcpy(dst + i * stream.stride, stream.view.element(source[i]), stream.size);
+        }
+    }
+
+    for (const Stream &stream : streams) {
+        const u8 *stream_data = data.data() + stream.offset;
+        u32 view = append_buffer_view(model, stream_data, stream.stride * vertex_count,
+                                      stream.stride == stream.size ? 0 : stream.stride, TARGET_ARRAY_BUFFER);
+
+        Accessor accessor = model.accessors[stream.accessor];
+        accessor.buffer_view = view;
+        accessor.byte_offset = 0;
+        accessor.count = vertex_count;
+        if (!accessor.min.empty() || !accessor.max.empty()) update_min_max(accessor, stream_data, stream.stride);
+
+        (*stream.owner)[stream.name] = add_accessor(model, accessor);
+    }
+
+    return true;
+}
+
+u32 add_normalized_accessor(Model &model, const std::vector<f32> &values, const std::string &type, i32 component_type,
+                            i32 target) {
+    usize components = component_count(type);
+    usize size = component_size(component_type);
+    if (components == 0 || size == 0 || size > 2) return UINT32_MAX;
+
+    std::vector<u8> data(values.size() * size);
+    if (!values.empty()) write_components(data.data(), component_type, true, values.size(), values.data());
+
+    u32 view = append_buffer_view(model, data.data(), data.size(), 0, target);
+
+    Accessor accessor;
+    accessor.buffer_view = view;
+    accessor.component_type = component_type;
+    accessor.normalized = true;
+    accessor.count = values.size() / components;
+    accessor.type = type;
+    return add_accessor(model, accessor);
+}
+
+// Calls `visit` on every accessor index stored in the model
+template <typename Visit> static void visit_accessors(Model &model, Visit visit) {
+    for (Mesh &mesh : model.meshes) {
+        for (Primitive &primitive : mesh.primitives) {
+            for (auto &attr : primitive.attributes) visit(attr.second);
+            visit(primitive.indices);
+            for (auto &target : primitive.targets) {
+                for (auto &attr : target) visit(attr.second);
+            }
+        }
+    }
+    for (Skin &skin : model.skins) visit(skin.inverse_bind_matrices);
+    for (Animation &animation : model.animations) {
+        for (AnimationSampler &sampler : animation.samplers) {
+            visit(sampler.input);
+            visit(sampler.output);
+        }
+    }
+}
+
+void compact_accessors(Model &model) {
+    std::vector<u32> remap(model.accessors.size(), UINT32_MAX);
+    visit_accessors(model, [&](u32 &accessor) {
+        if (accessor < remap.size()) remap[accessor] = 0;
+    });
+
+    std::vector<Accessor> accessors;
+    for (usize i = 0; i < model.accessors.size(); i++) {
+        if (remap[i] == UINT32_MAX) continue;
+
+        remap[i] = (u32)accessors.size();
+        accessors.push_back(model.accessors[i]);
+    }
+
+    visit_accessors(model, [&](u32 &accessor) {
+        if (accessor < remap.size()) accessor = remap[accessor];
+    });
+    model.accessors = accessors;
+}
+
+bool compact_buffers(Model &model) {
+    std::vector<u32> view_remap(model.buffer_views.size(), UINT32_MAX);
+    for (const Accessor &accessor : model.accessors) {
+        if (accessor.buffer_view < view_remap.size()) view_remap[accessor.buffer_view] = 0;
+    }
+    for (const Image &image : model.images) {
+        if (image.uri.empty() && image.buffer_view < view_remap.size()) view_remap[image.buffer_view] = 0;
+    }
+
+    // Every original buffer is dropped below, so nothing may change unless all referenced data can be copied
+    for (usize i = 0; i < model.buffer_views.size(); i++) {
+        if (view_remap[i] == UINT32_MAX) continue;
+
+        const BufferView &view = model.buffer_views[i];
+        if (view.buffer >= model.buffers.size() || !model.buffers[view.buffer].loaded ||
+            view.byte_offset + view.byte_length > model.buffers[view.buffer].data.size()) {
+            std::cerr << "Cannot compact buffers: buffer view " << i << " is out of range or its buffer is not loaded"
+                      << std::endl;
+            return false;
+        }
+    }
+
+    // Accessors need their offset into the buffer, view offset included, aligned to their component size. Each view
+    // is aligned to the largest component size it holds (at least 4) and keeps its original offset modulo that, so
+    // an accessor whose alignment relied on where its view started stays aligned too.
+    std::vector<usize> alignments(model.buffer_views.size(), 4);
+    for (const Accessor &accessor : model.accessors) {
+        if (accessor.buffer_view >= alignments.size()) continue;
+        usize &alignment = alignments[accessor.buffer_view];
+        alignment = std::max(alignment, component_size(accessor.component_type));
+    }
+
+    std::vector<u8> data;
+    std::vector<BufferView> views;
+    for (usize i = 0; i < model.buffer_views.size(); i++) {
+        if (view_remap[i] == UINT32_MAX) continue;
+
+        BufferView view = model.buffer_views[i];
+        const Buffer &buffer = model.buffers[view.buffer];
+
+        usize alignment = alignments[i], phase = view.byte_offset % alignment;
+        usize offset = (data.size() + alignment - 1 - phase) / alignment * alignment + phase;
+        data.resize(offset + view.byte_length, 0);
+        if (view.byte_length > 0) {
+            std::memcpy(data.data() + offset, buffer.data.data() + view.byte_offset, view.byte_length);
+        }
+
+        view.buffer = 0;
+        view.byte_offset = offset;
+        view_remap[i] = (u32)views.size();
+        views.push_back(view);
+    }
+
+    for (Accessor &accessor : model.accessors) {
+        if (accessor.buffer_view < view_remap.size()) accessor.buffer_view = view_remap[accessor.buffer_view];
+    }
+    for (Image &image : model.images) {
+        if (image.uri.empty() && image.buffer_view < view_remap.size()) {
+            image.buffer_view = view_remap[image.buffer_view];
+        }
+    }
+
+    model.buffer_views = views;
+    model.buffers.clear();
+    model.working_buffer = data.empty() ? UINT32_MAX : add_buffer(model, std::move(data));
+    return true;
+}
+
+usize primitive_vertex_count(const Model &model, const Primitive &primitive) {
+    usize count = 0;
+    bool first = true;
+
+    for (const auto &attr : primitive.attributes) {
+        if (attr.second >= model.accessors.size()) return 0;
+
+        usize n = model.accessors[attr.second].count;
+        if (!first && n != count) return 0;
+
+        count = n;
+        first = false;
+    }
+
+    return count;
+}
+
+}; // namespace gltf
@@ -0,0 +1,639 @@
+#include "animation.hpp"
+#include "math.hpp"
+#include "parallel.hpp"
+#include "simd.hpp"
+#include "transform.hpp"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+namespace gltf {
+
+static f32 key_time(const AccessorView &input, usize key) {
+    f32 time;
+    std::memcpy(&time, input.element(key), sizeof(time));
+    return time;
+}
+
+// Output element holding the value of `key`; CUBICSPLINE stores (in-tangent, value, out-tangent) per key
+static usize value_element(const AnimationTrack &track, usize key) {
+    return track.interpolation == INTERPOLATION_CUBICSPLINE ? key * 3 + 1 : key;
+}
+
+// Decodes `n` tightly packed normalized i16 components, four per conversion. Groups of four are loaded straight
+// from `src` while `readable` components remain, so a VEC3 only goes through a copy at the end of the accessor.
+static void decode_i16(const u8 *src, usize n, usize readable, f32 *out) {
+    const F4 unit = f4_splat(1.0f / 32767.0f), lowest = f4_splat(-1.0f);
+    for (usize i = 0; i < n; i += 4) {
+        usize m = std::min<usize>(4, n - i);
+        F4 values;
+        if (readable >= i + 4) {
+            values = f4_from_i16((const i16 *)(src + i * sizeof(i16)));
+        } else {
+            i16 raw[4] = {0, 0, 0, 0};
+            for (usize j = 0; j < m; j++) std::memcpy(&raw[j], src + (i + j) * sizeof(i16), sizeof(i16));
+            values = f4_from_i16(raw);
+        }
+
+        values = f4_max(values * unit, lowest);
+        if (m == 4) {
+            f4_store(out + i, values);
+        } else {
+            f32 lanes[4];
+            f4_store(lanes, values);
+            for (usize j = 0; j < m; j++) out[i + j] = lanes[j];
+        }
+    }
+}
+
+// Reads `n` values starting at value `first` of output element `element`. Weights are stored as scalars, one output
+// element per morph target.
+static void read_values(const AnimationTrack &track, usize element, usize first, usize n, f32 *out) {
+    const AccessorView &output = track.output;
+    if (output.components == track.width && output.component_type == COMPONENT_FLOAT) {
+        std::memcpy(out, output.element(element) + first * sizeof(f32), n * sizeof(f32));
+        return;
+    }
+    if (output.component_type == COMPONENT_SHORT && output.normalized &&
+        output.stride == output.components * sizeof(i16)) {
+        // Tightly packed, so value `first` of element `element` sits at the same offset for scalar weights
+        usize value = element * track.width + first;
+        decode_i16(output.data + value * sizeof(i16), n, output.count * output.components - value, out);
+        return;
+    }
+    if (output.components == track.width) {
+        const u8 *src = output.element(element) + first * component_size(output.component_type);
+        read_components(src, output.component_type, output.normalized, n, out);
+        return;
+    }
+
+    for (usize j = 0; j < n; j++) {
+        read_components(output.element(element * track.width + first + j), output.component_type, output.normalized, 1,
+                        out + j);
+    }
+}
+
+// Last key whose time is <= `time`, given input[0] <= time < input[count - 1]. The key found by the previous lookup
+// is tried first, then its successor, so playback moving forward by less than a keyframe per step never searches.
+static usize find_key(const AccessorView &input, f32 time, u32 &cursor) {
+    usize key = cursor;
+    if (key + 1 < input.count && key_time(input, key) <= time) {
+        if (time < key_time(input, key + 1)) return key;
+        if (key + 2 < input.count && time < key_time(input, key + 2)) {
+            cursor = (u32)(key + 1);
+            return key + 1;
+        }
+    }
+
+    usize lo = 0, hi = input.count - 1;
+    while (hi - lo > 1) {
+        usize mid = lo + (hi - lo) / 2;
+        if (key_time(input, mid) <= time) {
+            lo = mid;
+        } else {
+            hi = mid;
+        }
+    }
+    cursor = (u32)lo;
+    return lo;
+}
+
+void sample_track(const AnimationTrack &track, f32 time, f32 *out) {
+    u32 cursor = 0;
+    sample_track(track, time, out, cursor);
+}
+
+// Keyframes around a sample time: `key` blended towards key + 1 by `t`, or `key` alone when the time clamps to either
+// end of the track or the sampler steps
+struct KeySpan {
+    usize key = 0;
+    f32 t = 0.0f;
+    f32 dt = 0.0f;    // Interval length, scales CUBICSPLINE tangents
+    f32 begin = 0.0f; // Times of `key` and key + 1 when blending
+    f32 end = 0.0f;
+    bool single = true;
+};
+
+static KeySpan locate_key(const AnimationTrack &track, f32 time, u32 &cursor) {
+    KeySpan span;
+    usize count = track.input.count;
+    if (count == 1 || time <= key_time(track.input, 0)) {
+        cursor = 0;
+        return span;
+    }
+    if (time >= key_time(track.input, count - 1)) {
+        cursor = (u32)(count - 2);
+        span.key = count - 1;
+        return span;
+    }
+
+    span.key = find_key(track.input, time, cursor);
+    if (track.interpolation == INTERPOLATION_STEP) return span;
+
+    span.begin = key_time(track.input, span.key);
+    span.end = key_time(track.input, span.key + 1);
+    span.dt = span.end - span.begin;
+    span.t = span.dt > 0.0f ? (time - span.begin) / span.dt : 0.0f;
+    span.single = false;
+    return span;
+}
+
+// Interpolates the stored values; range-quantized tracks still need dequantize() afterwards
+static void interpolate(const AnimationTrack &track, f32 time, f32 *out, u32 &cursor) {
+    KeySpan span = locate_key(track, time, cursor);
+    if (span.single) {
+        read_values(track, value_element(track, span.key), 0, track.width, out);
+        return;
+    }
+
+    usize key = span.key;
+    f32 t = span.t, dt = span.dt;
+
+    // Four values at a time, so rotations are always interpolated as a whole quaternion
+    for (usize first = 0; first < track.width; first += 4) {
+        usize n = std::min<usize>(4, track.width - first);
+        f32 a[4], b[4];
+        read_values(track, value_element(track, key), first, n, a);
+        read_values(track, value_element(track, key + 1), first, n, b);
+
+        if (track.interpolation == INTERPOLATION_LINEAR) {
+            if (track.path == ANIMATION_PATH_ROTATION) {
+                Vec4 q = quat_slerp({a[0], a[1], a[2], a[3]}, {b[0], b[1], b[2], b[3]}, t);
+                out[0] = q.x, out[1] = q.y, out[2] = q.z, out[3] = q.w;
+            } else {
+                for (usize j = 0; j < n; j++) out[first + j] = a[j] + (b[j] - a[j]) * t;
+            }
+            continue;
+        }
+
+        // Cubic Hermite between the values, with the tangents scaled by the key interval
+        f32 out_tangent[4], in_tangent[4];
+        read_values(track, key * 3 + 2, first, n, out_tangent);
+        read_values(track, (key + 1) * 3, first, n, in_tangent);
+
+        f32 t2 = t * t, t3 = t2 * t;
+        f32 h00 = 2.0f * t3 - 3.0f * t2 + 1.0f, h10 = (t3 - 2.0f * t2 + t) * dt;
+        f32 h01 = -2.0f * t3 + 3.0f * t2, h11 = (t3 - t2) * dt;
+        for (usize j = 0; j < n; j++) {
+            out[first + j] = h00 * a[j] + h10 * out_tangent[j] + h01 * b[j] + h11 * in_tangent[j];
+        }
+
+        if (track.path == ANIMATION_PATH_ROTATION) {
+            Vec4 q = quat_normalize({out[0], out[1], out[2], out[3]});
+            out[0] = q.x, out[1] = q.y, out[2] = q.z, out[3] = q.w;
+        }
+    }
+}
+
+// The range mapping is affine and Hermite basis weights of the values sum to 1, so it commutes with interpolation
+static void dequantize(const AnimationTrack &track, f32 *values) {
+    values[0] = track.dequantize_offset.x + track.dequantize_scale.x * values[0];
+    values[1] = track.dequantize_offset.y + track.dequantize_scale.y * values[1];
+    values[2] = track.dequantize_offset.z + track.dequantize_scale.z * values[2];
+}
+
+void sample_track(const AnimationTrack &track, f32 time, f32 *out, u32 &cursor) {
+    if (track.input.count == 0) return;
+
+    interpolate(track, time, out, cursor);
+    if (track.dequantize) dequantize(track, out);
+}
+
+bool parse_animation_path(const std::string &path, u8 &out) {
+    if (path == "translation") {
+        out = ANIMATION_PATH_TRANSLATION;
+    } else if (path == "rotation") {
+        out = ANIMATION_PATH_ROTATION;
+    } else if (path == "scale") {
+        out = ANIMATION_PATH_SCALE;
+    } else if (path == "weights") {
+        out = ANIMATION_PATH_WEIGHTS;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+static bool parse_interpolation(const std::string &interpolation, u8 &out) {
+    if (interpolation == "STEP") {
+        out = INTERPOLATION_STEP;
+    } else if (interpolation == "LINEAR" || interpolation.empty()) {
+        out = INTERPOLATION_LINEAR;
+    } else if (interpolation == "CUBICSPLINE") {
+        out = INTERPOLATION_CUBICSPLINE;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool view_animation_sampler(const Model &model, u32 animation, u32 sampler, u8 path, AnimationTrack &track) {
+    track = AnimationTrack();
+    track.path = path;
+    if (animation >= model.animations.size() || sampler >= model.animations[animation].samplers.size()) {
+        std::cerr << "Cannot view animation sampler: sampler " << sampler << " of animation " << animation
+                  << " does not exist" << std::endl;
+        return false;
+    }
+    const AnimationSampler &source = model.animations[animation].samplers[sampler];
+
+    if (!parse_interpolation(source.interpolation, track.interpolation)) {
+        std::cerr << "Cannot view animation sampler: unknown interpolation " << source.interpolation << std::endl;
+        return false;
+    }
+    if (!view_accessor(model, source.input, track.input) || !view_accessor(model, source.output, track.output)) {
+        std::cerr << "Cannot view animation sampler: sampler " << sampler << " has unreadable accessors" << std::endl;
+        return false;
+    }
+    if (track.input.component_type != COMPONENT_FLOAT || track.input.components != 1) {
+        std::cerr << "Cannot view animation sampler: keyframe times must be float scalars" << std::endl;
+        return false;
+    }
+    if (track.output.component_type != COMPONENT_FLOAT && !track.output.normalized) {
+        std::cerr << "Cannot view animation sampler: keyframe values must be float or normalized" << std::endl;
+        return false;
+    }
+
+    usize per_key = track.interpolation == INTERPOLATION_CUBICSPLINE ? 3 : 1;
+    usize keys = track.input.count;
+    if (path == ANIMATION_PATH_WEIGHTS) {
+        track.width = keys > 0 ? (u32)(track.output.count / (keys * per_key)) : 0;
+        if (track.output.components != 1) track.width = 0;
+    } else {
+        track.width = path == ANIMATION_PATH_ROTATION ? 4 : 3;
+        if (track.output.components != track.width) track.width = 0;
+    }
+
+    usize elements = keys * per_key * (track.output.components == track.width ? 1 : track.width);
+    if (keys == 0 || track.width == 0 || track.output.count != elements) {
+        std::cerr << "Cannot view animation sampler: sampler " << sampler << " output does not match its target path"
+                  << std::endl;
+        return false;
+    }
+
+    if (!source.dequantize_offset.empty() || !source.dequantize_scale.empty()) {
+        bool ranged = path == ANIMATION_PATH_TRANSLATION || path == ANIMATION_PATH_SCALE;
+        if (!ranged || source.dequantize_offset.size() != 3 || source.dequantize_scale.size() != 3) {
+            std::cerr << "Cannot view animation sampler: sampler " << sampler << " has an invalid quantization range"
+                      << std::endl;
+            return false;
+        }
+
+        const std::vector<f32> &offset = source.dequantize_offset, &scale = source.dequantize_scale;
+        track.dequantize = true;
+        track.dequantize_offset = {offset[0], offset[1], offset[2]};
+        track.dequantize_scale = {scale[0], scale[1], scale[2]};
+    }
+    return true;
+}
+
+bool build_animation_clip(const Model &model, u32 animation, AnimationClip &clip) {
+    clip = AnimationClip();
+    if (animation >= model.animations.size()) {
+        std::cerr << "Cannot build animation clip: animation " << animation << " does not exist" << std::endl;
+        return false;
+    }
+    clip.animation = animation;
+
+    const Animation &source = model.animations[animation];
+    bool timed = false;
+    for (const AnimationChannel &channel : source.channels) {
+        // Channels targeting something other than a node property (e.g. through extensions) are not ours to sample
+        u8 path;
+        if (channel.target.node >= model.nodes.size() || !parse_animation_path(channel.target.path, path)) continue;
+
+        AnimationTrack track;
+        if (!view_animation_sampler(model, animation, channel.sampler, path, track)) return false;
+        track.node = channel.target.node;
+
+        f32 first = key_time(track.input, 0), last = key_time(track.input, track.input.count - 1);
+        clip.start = timed ? std::min(clip.start, first) : first;
+        clip.end = timed ? std::max(clip.end, last) : last;
+        timed = true;
+
+        clip.tracks.push_back(track);
+    }
+
+    return true;
+}
+
+void reset_animation_cursor(const AnimationClip &clip, AnimationCursor &cursor) {
+    cursor.keys.assign(clip.tracks.size(), 0);
+}
+
+// Without a cursor every track starts its lookup from key 0, which degrades to a binary search
+static u32 *track_cursor(const AnimationClip &clip, AnimationCursor *cursor, usize t, u32 &scratch) {
+    if (cursor && cursor->keys.size() == clip.tracks.size()) return &cursor->keys[t];
+
+    scratch = 0;
+    return &scratch;
+}
+
+static void apply(const AnimationClip &clip, f32 time, Model &model, AnimationCursor *cursor) {
+    f32 values[4];
+    u32 scratch;
+    for (usize t = 0; t < clip.tracks.size(); t++) {
+        const AnimationTrack &track = clip.tracks[t];
+        u32 &key = *track_cursor(clip, cursor, t, scratch);
+        if (track.path == ANIMATION_PATH_WEIGHTS) {
+            std::vector<f32> &weights = model.nodes[track.node].weights;
+            weights.resize(track.width);
+            sample_track(track, time, weights.data(), key);
+            continue;
+        }
+
+        sample_track(track, time, values, key);
+        if (track.path == ANIMATION_PATH_TRANSLATION) {
+            set_translation(model, track.node, {values[0], values[1], values[2]});
+        } else if (track.path == ANIMATION_PATH_ROTATION) {
+            set_rotation(model, track.node, {values[0], values[1], values[2], values[3]});
+        } else {
+            set_scale(model, track.node, {values[0], values[1], values[2]});
+        }
+    }
+}
+
+static void apply(const AnimationClip &clip, f32 time, NodeTransforms &transforms, AnimationCursor *cursor) {
+    f32 values[4];
+    u32 scratch;
+    for (usize t = 0; t < clip.tracks.size(); t++) {
+        const AnimationTrack &track = clip.tracks[t];
+        u32 &key = *track_cursor(clip, cursor, t, scratch);
+        if (track.node >= transforms.locals.size()) continue;
+
+        if (track.path == ANIMATION_PATH_WEIGHTS) {
+            // The store sizes each node's weights from its mesh; a track disagreeing with it is ignored
+            u32 begin = transforms.weight_offsets[track.node];
+            if (transforms.weight_offsets[track.node + 1] - begin != track.width) continue;
+
+            sample_track(track, time, transforms.weights.data() + begin, key);
+            mark_node_dirty(transforms, track.node);
+            continue;
+        }
+
+        sample_track(track, time, values, key);
+        if (track.path == ANIMATION_PATH_TRANSLATION) {
+            set_node_translation(transforms, track.node, {values[0], values[1], values[2]});
+        } else if (track.path == ANIMATION_PATH_ROTATION) {
+            set_node_rotation(transforms, track.node, {values[0], values[1], values[2], values[3]});
+        } else {
+            set_node_scale(transforms, track.node, {values[0], values[1], values[2]});
+        }
+    }
+}
+
+void apply_animation(const AnimationClip &clip, f32 time, Model &model) {
+    apply(clip, time, model, nullptr);
+}
+
+void apply_animation(const AnimationClip &clip, f32 time, Model &model, AnimationCursor &cursor) {
+    if (cursor.keys.size() != clip.tracks.size()) reset_animation_cursor(clip, cursor);
+    apply(clip, time, model, &cursor);
+}
+
+void apply_animation(const AnimationClip &clip, f32 time, NodeTransforms &transforms) {
+    apply(clip, time, transforms, nullptr);
+}
+
+void apply_animation(const AnimationClip &clip, f32 time, NodeTransforms &transforms, AnimationCursor &cursor) {
+    if (cursor.keys.size() != clip.tracks.size()) reset_animation_cursor(clip, cursor);
+    apply(clip, time, transforms, &cursor);
+}
+
+void init_animation_batch(const AnimationClip &clip, u32 instances, AnimationBatch &batch) {
+    batch.instances = instances;
+    batch.cursors.assign(clip.tracks.size() * instances, 0);
+    batch.rows.resize(clip.tracks.size());
+
+    u32 rows = 0;
+    for (usize t = 0; t < clip.tracks.size(); t++) {
+        batch.rows[t] = rows;
+        rows += clip.tracks[t].width;
+    }
+    batch.values.assign((usize)rows * instances, 0.0f);
+}
+
+static bool batch_matches(const AnimationClip &clip, const AnimationBatch &batch) {
+    return batch.cursors.size() == clip.tracks.size() * batch.instances && batch.rows.size() == clip.tracks.size();
+}
+
+// Slerp weight for nlerp: nudges t so the normalized lerp follows slerp's constant angular speed. The correction is a
+// polynomial in the cosine between the quaternions (fit by Kapoulkine, "Approximating slerp"), so it runs four lanes
+// at once where slerp would need per-lane trigonometry.
+static F4 slerp_weight(F4 cosine, F4 t) {
+    F4 d = f4_abs(cosine);
+    F4 a = f4_splat(1.0904f) + d * (f4_splat(-3.2452f) + d * (f4_splat(3.55645f) - d * f4_splat(1.43519f)));
+    F4 b = f4_splat(0.848013f) + d * (f4_splat(-1.06021f) + d * f4_splat(0.215638f));
+    F4 centered = t - f4_splat(0.5f);
+    F4 k = a * centered * centered + b;
+    return t + t * centered * (t - f4_splat(1.0f)) * k;
+}
+
+// Key lookups for four lanes of instances. A lane whose time equals the previous lane's, or falls within the same
+// keyframe interval, takes that span without a lookup, so instances playing close together share the work.
+static void locate_lanes(const AnimationTrack &track, const f32 *times, u32 **cursors, KeySpan *spans) {
+    for (usize lane = 0; lane < 4; lane++) {
+        f32 time = times[lane];
+        if (lane > 0) {
+            const KeySpan &previous = spans[lane - 1];
+            bool inside = !previous.single && previous.begin <= time && time < previous.end;
+            if (time == times[lane - 1] || inside) {
+                spans[lane] = previous;
+                if (time != times[lane - 1]) spans[lane].t = (time - previous.begin) / previous.dt;
+                *cursors[lane] = *cursors[lane - 1];
+                continue;
+            }
+        }
+        spans[lane] = locate_key(track, time, *cursors[lane]);
+    }
+}
+
+// Interpolates values [first, first + n) of a track, n <= 4, for four located lanes. out[c] holds value first + c of
+// every lane. Keyframes are read once per distinct span; when all lanes share one they are broadcast instead of
+// transposed.
+static void interpolate_lanes(const AnimationTrack &track, const KeySpan *spans, usize first, usize n, F4 *out) {
+    bool cubic = track.interpolation == INTERPOLATION_CUBICSPLINE;
+    f32 keys[4][4][4]; // [lane][a, b, out tangent of a, in tangent of b][value]
+    bool uniform = true;
+    for (usize lane = 0; lane < 4; lane++) {
+        const KeySpan &span = spans[lane];
+        f32(*row)[4] = keys[lane];
+        if (lane > 0 && span.key == spans[lane - 1].key && span.single == spans[lane - 1].single) {
+            std::memcpy(row, keys[lane - 1], sizeof(keys[lane]));
+            continue;
+        }
+        uniform = lane == 0;
+
+        std::memset(row, 0, sizeof(keys[lane]));
+        read_values(track, value_element(track, span.key), first, n, row[0]);
+        if (span.single) {
+            // Blending a key with itself, with zero tangents for CUBICSPLINE, returns the key
+            std::memcpy(row[1], row[0], sizeof(row[1]));
+            continue;
+        }
+
+        read_values(track, value_element(track, span.key + 1), first, n, row[1]);
+        if (cubic) {
+            read_values(track, span.key * 3 + 2, first, n, row[2]);
+            read_values(track, (span.key + 1) * 3, first, n, row[3]);
+        }
+    }
+
+    F4 a[4], b[4], m0[4], m1[4];
+    if (uniform) {
+        for (usize c = 0; c < 4; c++) {
+            a[c] = f4_splat(keys[0][0][c]);
+            b[c] = f4_splat(keys[0][1][c]);
+            m0[c] = f4_splat(keys[0][2][c]);
+            m1[c] = f4_splat(keys[0][3][c]);
+        }
+    } else {
+        for (usize lane = 0; lane < 4; lane++) {
+            a[lane] = f4_load(keys[lane][0]);
+            b[lane] = f4_load(keys[lane][1]);
+            m0[lane] = f4_load(keys[lane][2]);
+            m1[lane] = f4_load(keys[lane][3]);
+        }
+        f4_transpose(a[0], a[1], a[2], a[3]);
+        f4_transpose(b[0], b[1], b[2], b[3]);
+        if (cubic) {
+            f4_transpose(m0[0], m0[1], m0[2], m0[3]);
+            f4_transpose(m1[0], m1[1], m1[2], m1[3]);
+        }
+    }
+    F4 vt = f4_set(spans[0].t, spans[1].t, spans[2].t, spans[3].t);
+
+    if (cubic) {
+        F4 vdt = f4_set(spans[0].dt, spans[1].dt, spans[2].dt, spans[3].dt), t2 = vt * vt, t3 = t2 * vt;
+        F4 h00 = f4_splat(2.0f) * t3 - f4_splat(3.0f) * t2 + f4_splat(1.0f);
+        F4 h10 = (t3 - f4_splat(2.0f) * t2 + vt) * vdt;
+        F4 h01 = f4_splat(3.0f) * t2 - f4_splat(2.0f) * t3;
+        F4 h11 = (t3 - t2) * vdt;
+        for (usize c = 0; c < 4; c++) out[c] = h00 * a[c] + h10 * m0[c] + h01 * b[c] + h11 * m1[c];
+    } else if (track.path == ANIMATION_PATH_ROTATION) {
+        // Shortest arc: flip b's weight when the quaternions lie in opposite hemispheres
+        F4 cosine = a[0] * b[0] + a[1] * b[1] + a[2] * b[2] + a[3] * b[3];
+        F4 wb = slerp_weight(cosine, vt);
+        F4 wa = f4_splat(1.0f) - wb;
+        wb = f4_select(cosine < f4_splat(0.0f), f4_splat(0.0f) - wb, wb);
+        for (usize c = 0; c < 4; c++) out[c] = a[c] * wa + b[c] * wb;
+    } else {
+        for (usize c = 0; c < 4; c++) out[c] = a[c] + (b[c] - a[c]) * vt;
+    }
+
+    if (track.path == ANIMATION_PATH_ROTATION) {
+        F4 length = f4_sqrt(out[0] * out[0] + out[1] * out[1] + out[2] * out[2] + out[3] * out[3]);
+        F4 scale = f4_select(length > f4_splat(0.0f), f4_splat(1.0f) / length, f4_splat(0.0f));
+        for (usize c = 0; c < 4; c++) out[c] = out[c] * scale;
+    }
+
+    if (track.dequantize) {
+        out[0] = f4_splat(track.dequantize_offset.x) + f4_splat(track.dequantize_scale.x) * out[0];
+        out[1] = f4_splat(track.dequantize_offset.y) + f4_splat(track.dequantize_scale.y) * out[1];
+        out[2] = f4_splat(track.dequantize_offset.z) + f4_splat(track.dequantize_scale.z) * out[2];
+    }
+}
+
+void sample_animation_batch(const AnimationClip &clip, AnimationBatch &batch, const f32 *times, u32 first,
+                            u32 count) {
+    if (!batch_matches(clip, batch)) return;
+
+    u32 end = std::min(first + count, batch.instances);
+    for (usize t = 0; t < clip.tracks.size(); t++) {
+        const AnimationTrack &track = clip.tracks[t];
+        if (track.input.count == 0) continue;
+        u32 *cursors = batch.cursors.data() + t * batch.instances;
+        f32 *rows = batch.values.data() + (usize)batch.rows[t] * batch.instances;
+
+        for (u32 i = first; i < end; i += 4) {
+            // A partial group repeats its last instance in the spare lanes, on a copy of its cursor
+            u32 lanes = std::min<u32>(4, end - i), spare = cursors[i + lanes - 1];
+            f32 lane_times[4];
+            u32 *lane_cursors[4];
+            for (u32 lane = 0; lane < 4; lane++) {
+                lane_times[lane] = times[i + std::min(lane, lanes - 1)];
+                lane_cursors[lane] = lane < lanes ? &cursors[i + lane] : &spare;
+            }
+
+            KeySpan spans[4];
+            locate_lanes(track, lane_times, lane_cursors, spans);
+            for (u32 value = 0; value < track.width; value += 4) {
+                u32 n = std::min<u32>(4, track.width - value);
+                F4 lanes_out[4];
+                interpolate_lanes(track, spans, value, n, lanes_out);
+
+                for (u32 c = 0; c < n; c++) {
+                    f32 *row = rows + (usize)(value + c) * batch.instances + i;
+                    if (lanes == 4) {
+                        f4_store(row, lanes_out[c]);
+                        continue;
+                    }
+                    f32 lane_values[4];
+                    f4_store(lane_values, lanes_out[c]);
+                    for (u32 lane = 0; lane < lanes; lane++) row[lane] = lane_values[lane];
+                }
+            }
+        }
+    }
+}
+
+void sample_animation_batch(const AnimationClip &clip, AnimationBatch &batch, const f32 *times) {
+    if (!batch_matches(clip, batch)) init_animation_batch(clip, batch.instances, batch);
+
+    usize ranges = (batch.instances + ANIMATION_BATCH_RANGE - 1) / ANIMATION_BATCH_RANGE;
+    parallel_for(ranges, [&](usize r) {
+        sample_animation_batch(clip, batch, times, (u32)(r * ANIMATION_BATCH_RANGE), ANIMATION_BATCH_RANGE);
+    });
+}
+
+// Writes one sampled TRS value to a pose; matrix nodes go through the setters, which decompose them first
+static void write_pose(NodeTransforms &pose, const AnimationTrack &track, const f32 *value) {
+    u32 node = track.node;
+    if (node >= pose.locals.size()) return;
+
+    if (pose.matrix_nodes[node]) {
+        if (track.path == ANIMATION_PATH_TRANSLATION) {
+            set_node_translation(pose, node, {value[0], value[1], value[2]});
+        } else if (track.path == ANIMATION_PATH_ROTATION) {
+            set_node_rotation(pose, node, {value[0], value[1], value[2], value[3]});
+        } else {
+            set_node_scale(pose, node, {value[0], value[1], value[2]});
+        }
+        return;
+    }
+
+    if (track.path == ANIMATION_PATH_TRANSLATION) {
+        pose.translations[node] = {value[0], value[1], value[2]};
+    } else if (track.path == ANIMATION_PATH_ROTATION) {
+        pose.rotations[node] = {value[0], value[1], value[2], value[3]};
+    } else {
+        pose.scales[node] = {value[0], value[1], value[2]};
+    }
+    if (!pose.dirty[node]) mark_node_dirty(pose, node);
+}
+
+void apply_animation_batch(const AnimationClip &clip, const AnimationBatch &batch, u32 instance,
+                           NodeTransforms &transforms) {
+    if (!batch_matches(clip, batch) || instance >= batch.instances) return;
+
+    for (usize t = 0; t < clip.tracks.size(); t++) {
+        const AnimationTrack &track = clip.tracks[t];
+        if (track.node >= transforms.locals.size()) continue;
+        const f32 *column = batch.values.data() + (usize)batch.rows[t] * batch.instances + instance;
+
+        if (track.path == ANIMATION_PATH_WEIGHTS) {
+            u32 begin = transforms.weight_offsets[track.node];
+            if (transforms.weight_offsets[track.node + 1] - begin != track.width) continue;
+
+            for (u32 c = 0; c < track.width; c++) transforms.weights[begin + c] = column[(usize)c * batch.instances];
+            mark_node_dirty(transforms, track.node);
+            continue;
+        }
+
+        f32 value[4];
+        for (u32 c = 0; c < track.width; c++) value[c] = column[(usize)c * batch.instances];
+        write_pose(transforms, track, value);
+    }
+}
+
+}; // namespace gltf
@@ -0,0 +1,302 @@
+#include "bounds.hpp"
+#include "accessor.hpp"
+#include "math.hpp"
+#include "parallel.hpp"
+#include "transform.hpp"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <iostream>
+#include <vector>
+
+namespace gltf {
+
+static f32 distance(const Vec3 &a, const Vec3 &b) {
+    f32 dx = a.x - b.x, dy = a.y - b.y, dz = a.z - b.z;
+    return std::sqrt(dx * dx + dy * dy + dz * dz);
+}
+
+bool compute_primitive_bounds(const Model &model, const Primitive &primitive, Bounds &bounds) {
+    bounds = Bounds();
+
+    std::vector<f32> positions;
+    auto position = primitive.attributes.find("POSITION");
+    if (position == primitive.attributes.end() || position->second >= model.accessors.size() ||
+        model.accessors[position->second].type != "VEC3" || !read_floats(model, position->second, positions)) {
+        std::cerr << "Cannot compute bounds: primitive has no readable VEC3 POSITION attribute" << std::endl;
+        return false;
+    }
+    if (positions.empty()) return true;
+
+    f32 lo[3] = {FLT_MAX, FLT_MAX, FLT_MAX};
+    f32 hi[3] = {-FLT_MAX, -FLT_MAX, -FLT_MAX};
+    for (usize i = 0; i < positions.size(); i += 3) {
+        for (usize c = 0; c < 3; c++) {
+            lo[c] = std::min(lo[c], positions[i + c]);
+            hi[c] = std::max(hi[c], positions[i + c]);
+        }
+    }
+
+    // Every target can push a vertex by at most its own displacement extent, independently of the other targets
+    f32 displacement = 0.0f;
+    std::vector<f32> offsets;
+    for (const auto &target : primitive.targets) {
+        auto target_position = target.find("POSITION");
+        if (target_position == target.end() || !read_floats(model, target_position->second, offsets)) continue;
+
+        f32 target_lo[3] = {0.0f, 0.0f, 0.0f};
+        f32 target_hi[3] = {0.0f, 0.0f, 0.0f};
+        f32 longest = 0.0f;
+        for (usize i = 0; i + 2 < offsets.size(); i += 3) {
+            for (usize c = 0; c < 3; c++) {
+                target_lo[c] = std::min(target_lo[c], offsets[i + c]);
+                target_hi[c] = std::max(target_hi[c], offsets[i + c]);
+            }
+            longest = std::max(longest, offsets[i] * offsets[i] + offsets[i + 1] * offsets[i + 1] +
+                                            offsets[i + 2] * offsets[i + 2]);
+        }
+
+        for (usize c = 0; c < 3; c++) {
+            lo[c] += target_lo[c];
+            hi[c] += target_hi[c];
+        }
+        displacement += std::sqrt(longest);
+    }
+
+    bounds.min = {lo[0], lo[1], lo[2]};
+    bounds.max = {hi[0], hi[1], hi[2]};
+    bounds.center = {(lo[0] + hi[0]) * 0.5f, (lo[1] + hi[1]) * 0.5f, (lo[2] + hi[2]) * 0.5f};
+
+    // Sphere around the box center, tighter than the box's circumsphere for rounded shapes
+    f32 radius = 0.0f;
+    for (usize i = 0; i < positions.size(); i += 3) {
+        radius = std::max(radius, distance(bounds.center, {positions[i], positions[i + 1], positions[i + 2]}));
+    }
+    bounds.radius = radius + displacement;
+
+    return true;
+}
+
+void merge_bounds(Bounds &bounds, const Bounds &other) {
+    if (other.empty()) return;
+    if (bounds.empty()) {
+        bounds = other;
+        return;
+    }
+
+    bounds.min = {std::min(bounds.min.x, other.min.x), std::min(bounds.min.y, other.min.y),
+                  std::min(bounds.min.z, other.min.z)};
+    bounds.max = {std::max(bounds.max.x, other.max.x), std::max(bounds.max.y, other.max.y),
+                  std::max(bounds.max.z, other.max.z)};
+
+    f32 d = distance(bounds.center, other.center);
+    if (d + other.radius <= bounds.radius) return;
+    if (d + bounds.radius <= other.radius) {
+        bounds.center = other.center;
+        bounds.radius = other.radius;
+        return;
+    }
+
+    // Smallest sphere enclosing both: spans from the far side of one to the far side of the other
+    f32 radius = (d + bounds.radius + other.radius) * 0.5f;
+    f32 t = (radius - bounds.radius) / d;
+    bounds.center = {bounds.center.x + (other.center.x - bounds.center.x) * t,
+                     bounds.center.y + (other.center.y - bounds.center.y) * t,
+                     bounds.center.z + (other.center.z - bounds.center.z) * t};
+    bounds.radius = radius;
+}
+
+Bounds transform_bounds(const Bounds &bounds, const Mat4 &matrix) {
+    if (bounds.empty()) return bounds;
+
+    const f32 center[3] = {(bounds.min.x + bounds.max.x) * 0.5f, (bounds.min.y + bounds.max.y) * 0.5f,
+                           (bounds.min.z + bounds.max.z) * 0.5f};
+    const f32 extent[3] = {(bounds.max.x - bounds.min.x) * 0.5f, (bounds.max.y - bounds.min.y) * 0.5f,
+                           (bounds.max.z - bounds.min.z) * 0.5f};
+
+    // Box center transforms as a point, the half extents through the absolute 3x3 part (Arvo)
+    Vec3 box_center = transform_point(matrix, {center[0], center[1], center[2]});
+    Vec3 sphere_center = transform_point(matrix, bounds.center);
+    f32 box_extent[3];
+    for (usize row = 0; row < 3; row++) {
+        box_extent[row] = 0.0f;
+        for (usize c = 0; c < 3; c++) box_extent[row] += std::fabs(matrix.cols[c][row]) * extent[c];
+    }
+
+    f32 scale = 0.0f;
+    for (usize c = 0; c < 3; c++) {
+        scale = std::max(scale, matrix.cols[c][0] * matrix.cols[c][0] + matrix.cols[c][1] * matrix.cols[c][1] +
+                                    matrix.cols[c][2] * matrix.cols[c][2]);
+    }
+
+    Bounds result;
+    result.min = {box_center.x - box_extent[0], box_center.y - box_extent[1], box_center.z - box_extent[2]};
+    result.max = {box_center.x + box_extent[0], box_center.y + box_extent[1], box_center.z + box_extent[2]};
+    result.center = sphere_center;
+    result.radius = bounds.radius * std::sqrt(scale);
+    return result;
+}
+
+static void update_mesh_bounds(Model &model, const std::vector<u32> &meshes) {
+    BoundsCache &cache = model.bounds;
+
+    std::vector<std::pair<u32, u32>> jobs;
+    for (u32 mesh : meshes) {
+        cache.primitives[mesh].assign(model.meshes[mesh].primitives.size(), Bounds());
+        for (u32 p = 0; p < model.meshes[mesh].primitives.size(); p++) jobs.push_back(std::make_pair(mesh, p));
+    }
+
+    const Model &source = model;
+    parallel_for(jobs.size(), [&](usize j) {
+        compute_primitive_bounds(source, source.meshes[jobs[j].first].primitives[jobs[j].second],
+                                 cache.primitives[jobs[j].first][jobs[j].second]);
+    });
+
+    for (u32 mesh : meshes) {
+        cache.meshes[mesh] = Bounds();
+        for (const Bounds &bounds : cache.primitives[mesh]) merge_bounds(cache.meshes[mesh], bounds);
+    }
+}
+
+static Bounds refit_node(const Model &model, u32 n) {
+    const BoundsCache &cache = model.bounds;
+    const TransformCache &transforms = model.transforms;
+    const Node &node = model.nodes[n];
+
+    Bounds bounds;
+    if (node.mesh < cache.meshes.size()) bounds = transform_bounds(cache.meshes[node.mesh], transforms.world[n]);
+    for (u32 child : node.children) {
+        if (child < model.nodes.size() && transforms.parents[child] == n) merge_bounds(bounds, cache.nodes[child]);
+    }
+    return bounds;
+}
+
+void update_bounds(Model &model) {
+    BoundsCache &cache = model.bounds;
+    usize node_count = model.nodes.size();
+
+    bool full = !cache.valid || cache.meshes.size() != model.meshes.size() || cache.nodes.size() != node_count;
+    std::vector<u32> meshes;
+    if (full) {
+        cache.primitives.assign(model.meshes.size(), std::vector<Bounds>());
+        cache.meshes.assign(model.meshes.size(), Bounds());
+        cache.nodes.assign(node_count, Bounds());
+        cache.marks.assign(node_count, 0);
+        invalidate_transforms(model);
+
+        meshes.resize(model.meshes.size());
+        for (u32 m = 0; m < meshes.size(); m++) meshes[m] = m;
+    } else {
+        for (u32 mesh : cache.dirty_meshes) {
+            if (mesh < model.meshes.size()) meshes.push_back(mesh);
+        }
+        std::sort(meshes.begin(), meshes.end());
+        meshes.erase(std::unique(meshes.begin(), meshes.end()), meshes.end());
+    }
+    cache.dirty_meshes.clear();
+    update_mesh_bounds(model, meshes);
+
+    // Subtrees moved since the last call, by this update_transforms() or by any made in between, are refit whole. A
+    // root below another listed root is covered by the ancestor's walk, so `changed` lists disjoint subtrees with
+    // parents before their descendants, and walking it backwards refits bottom-up.
+    update_transforms(model);
+    const TransformCache &transforms = model.transforms;
+    std::vector<u32> roots;
+    if (full || cache.refit_all) {
+        for (u32 n = 0; n < node_count; n++) {
+            if (transforms.parents[n] == UINT32_MAX) roots.push_back(n);
+        }
+    } else {
+        for (u32 root : cache.moved_roots) {
+            if (root < node_count) roots.push_back(root);
+        }
+        std::sort(roots.begin(), roots.end());
+        roots.erase(std::unique(roots.begin(), roots.end()), roots.end());
+    }
+    cache.moved_roots.clear();
+    cache.refit_all = false;
+
+    const u32 CHANGED = UINT32_MAX;
+    for (u32 root : roots) cache.marks[root] = CHANGED;
+    std::vector<u32> changed, stack;
+    for (u32 root : roots) {
+        bool covered = false;
+        for (u32 p = transforms.parents[root]; p != UINT32_MAX && !covered; p = transforms.parents[p]) {
+            covered = cache.marks[p] == CHANGED;
+        }
+        if (covered) continue;
+
+        stack.assign(1, root);
+        while (!stack.empty()) {
+            u32 n = stack.back();
+            stack.pop_back();
+            cache.marks[n] = CHANGED;
+            changed.push_back(n);
+            for (u32 child : model.nodes[n].children) {
+                if (child < node_count && transforms.parents[child] == n) stack.push_back(child);
+            }
+        }
+    }
+    for (usize i = changed.size(); i-- > 0;) cache.nodes[changed[i]] = refit_node(model, changed[i]);
+
+    // The remaining refits start at the parents of changed subtrees and at the nodes using a re-read mesh, and
+    // climb to the roots. Other marks hold depth + 1, so each climb stops at the first node already queued.
+    std::vector<u32> seeds;
+    for (u32 n : changed) {
+        u32 parent = transforms.parents[n];
+        if (parent != UINT32_MAX && cache.marks[parent] != CHANGED) seeds.push_back(parent);
+    }
+    if (!full && !meshes.empty()) {
+        std::vector<u8> reread(model.meshes.size(), 0);
+        for (u32 mesh : meshes) reread[mesh] = 1;
+        for (u32 n = 0; n < node_count; n++) {
+            u32 mesh = model.nodes[n].mesh;
+            if (mesh < reread.size() && reread[mesh] && cache.marks[n] != CHANGED) seeds.push_back(n);
+        }
+    }
+
+    std::vector<std::pair<u32, u32>> refits; // Depth, node
+    std::vector<u32> chain;
+    for (u32 seed : seeds) {
+        chain.clear();
+        u32 base = 0;
+        for (u32 n = seed; n != UINT32_MAX; n = transforms.parents[n]) {
+            if (cache.marks[n] != 0) {
+                base = cache.marks[n];
+                break;
+            }
+            chain.push_back(n);
+        }
+        for (usize i = 0; i < chain.size(); i++) {
+            cache.marks[chain[i]] = base + (u32)(chain.size() - i);
+            refits.push_back(std::make_pair(cache.marks[chain[i]], chain[i]));
+        }
+    }
+
+    std::sort(refits.begin(), refits.end(), std::greater<std::pair<u32, u32>>());
+    for (const auto &refit : refits) cache.nodes[refit.second] = refit_node(model, refit.second);
+
+    for (u32 n : changed) cache.marks[n] = 0;
+    for (const auto &refit : refits) cache.marks[refit.second] = 0;
+    cache.valid = true;
+}
+
+void invalidate_mesh_bounds(Model &model, u32 mesh) {
+    model.bounds.dirty_meshes.push_back(mesh);
+}
+
+void invalidate_bounds(Model &model) {
+    model.bounds.valid = false;
+}
+
+Bounds scene_bounds(const Model &model, u32 scene) {
+    Bounds bounds;
+    if (scene >= model.scenes.size()) return bounds;
+
+    for (u32 node : model.scenes[scene].nodes) {
+        if (node < model.bounds.nodes.size()) merge_bounds(bounds, model.bounds.nodes[node]);
+    }
+    return bounds;
+}
+
+}; // namespace gltf
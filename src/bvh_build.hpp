@@ -0,0 +1,236 @@
+#pragma once
+
+#include "gltf.hpp"
+#include "parallel.hpp"
+#include "types.hpp"
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+namespace gltf {
+
+// Binned SAH BVH construction shared by the scene and mesh BVHs. `Ref` is anything with `Vec3 min, max`; `Node` has
+// `Vec3 min, max` and `u32 first, count` with the flattened layout described in scene_bvh.hpp.
+
+// Binned SAH parameters; splits below MEDIAN_DEPTH fall back to median splits so traversal stacks stay bounded
+static const usize BVH_BIN_COUNT = 16;
+static const usize BVH_MEDIAN_DEPTH = 32;
+static const usize BVH_STACK_SIZE = 96;
+static const f32 BVH_TRAVERSAL_COST = 1.0f;
+
+struct BvhBox {
+    f32 min[3] = {FLT_MAX, FLT_MAX, FLT_MAX};
+    f32 max[3] = {-FLT_MAX, -FLT_MAX, -FLT_MAX};
+
+    void grow(const Vec3 &lo, const Vec3 &hi) {
+        min[0] = std::min(min[0], lo.x), min[1] = std::min(min[1], lo.y), min[2] = std::min(min[2], lo.z);
+        max[0] = std::max(max[0], hi.x), max[1] = std::max(max[1], hi.y), max[2] = std::max(max[2], hi.z);
+    }
+
+    void grow(const BvhBox &other) {
+        for (usize c = 0; c < 3; c++) {
+            min[c] = std::min(min[c], other.min[c]);
+            max[c] = std::max(max[c], other.max[c]);
+        }
+    }
+
+    f32 area() const {
+        if (min[0] > max[0]) return 0.0f;
+
+        f32 dx = max[0] - min[0], dy = max[1] - min[1], dz = max[2] - min[2];
+        return dx * dy + dy * dz + dz * dx;
+    }
+};
+
+// Twice the box center along `axis`; only used for ordering and binning
+template <typename Ref> static f32 bvh_centroid(const Ref &ref, usize axis) {
+    return axis == 0 ? ref.min.x + ref.max.x : axis == 1 ? ref.min.y + ref.max.y : ref.min.z + ref.max.z;
+}
+
+struct BvhBuildTask {
+    u32 node;
+    u32 begin;
+    u32 end;
+    u32 depth;
+};
+
+template <typename Ref, typename Node> struct BvhBuilder {
+    std::vector<Ref> &refs;
+    u32 max_leaf_size;
+    u32 task_depth;
+
+    // Returns the partition point of [begin, end), or `begin` when the range should stay a leaf
+    u32 split(u32 begin, u32 end, u32 depth, const BvhBox &bounds) {
+        u32 count = end - begin;
+        if (count <= 1) return begin;
+
+        BvhBox centroids;
+        for (u32 i = begin; i < end; i++) {
+            Vec3 c = {bvh_centroid(refs[i], 0), bvh_centroid(refs[i], 1), bvh_centroid(refs[i], 2)};
+            centroids.grow(c, c);
+        }
+
+        usize widest = 0;
+        for (usize axis = 1; axis < 3; axis++) {
+            if (centroids.max[axis] - centroids.min[axis] > centroids.max[widest] - centroids.min[widest]) {
+                widest = axis;
+            }
+        }
+
+        // All centroids coincide: only splitting by count can make progress
+        if (centroids.max[widest] - centroids.min[widest] <= 0.0f) {
+            return count > max_leaf_size ? begin + count / 2 : begin;
+        }
+
+        if (depth >= BVH_MEDIAN_DEPTH) {
+            u32 middle = begin + count / 2;
+            std::nth_element(refs.begin() + begin, refs.begin() + middle, refs.begin() + end,
+                             [&](const Ref &a, const Ref &b) {
+                                 return bvh_centroid(a, widest) < bvh_centroid(b, widest);
+                             });
+            return middle;
+        }
+
+        f32 best_cost = FLT_MAX;
+        usize best_axis = 0, best_bin = 0;
+        for (usize axis = 0; axis < 3; axis++) {
+            f32 extent = centroids.max[axis] - centroids.min[axis];
+            if (extent <= 0.0f) continue;
+
+            f32 scale = BVH_BIN_COUNT / extent;
+            BvhBox bins[BVH_BIN_COUNT];
+            u32 counts[BVH_BIN_COUNT] = {};
+            for (u32 i = begin; i < end; i++) {
+                usize bin = (usize)((bvh_centroid(refs[i], axis) - centroids.min[axis]) * scale);
+                bin = std::min(BVH_BIN_COUNT - 1, bin);
+                bins[bin].grow(refs[i].min, refs[i].max);
+                counts[bin]++;
+            }
+
+            // Right-to-left sweep stores the cost of everything after each boundary, left-to-right combines it
+            f32 right_cost[BVH_BIN_COUNT];
+            BvhBox right;
+            u32 right_count = 0;
+            for (usize b = BVH_BIN_COUNT - 1; b > 0; b--) {
+                right.grow(bins[b]);
+                right_count += counts[b];
+                right_cost[b - 1] = right.area() * right_count;
+            }
+
+            BvhBox left;
+            u32 left_count = 0;
+            for (usize b = 0; b + 1 < BVH_BIN_COUNT; b++) {
+                left.grow(bins[b]);
+                left_count += counts[b];
+                if (left_count == 0 || left_count == count) continue;
+
+                f32 cost = left.area() * left_count + right_cost[b];
+                if (cost < best_cost) {
+                    best_cost = cost;
+                    best_axis = axis;
+                    best_bin = b;
+                }
+            }
+        }
+
+        f32 area = bounds.area();
+        f32 split_cost = area > 0.0f ? BVH_TRAVERSAL_COST + best_cost / area : FLT_MAX;
+        if (best_cost == FLT_MAX || (count <= max_leaf_size && split_cost >= (f32)count)) {
+            return count > max_leaf_size ? begin + count / 2 : begin;
+        }
+
+        f32 scale = BVH_BIN_COUNT / (centroids.max[best_axis] - centroids.min[best_axis]);
+        auto middle = std::partition(refs.begin() + begin, refs.begin() + end, [&](const Ref &ref) {
+            usize bin = (usize)((bvh_centroid(ref, best_axis) - centroids.min[best_axis]) * scale);
+            return std::min(BVH_BIN_COUNT - 1, bin) <= best_bin;
+        });
+        return (u32)(middle - refs.begin());
+    }
+
+    // Builds the subtree of [begin, end) rooted at `nodes[node]`. With `tasks` set, ranges at `task_depth` are
+    // recorded for later instead of being built.
+    void build(std::vector<Node> &nodes, u32 node, u32 begin, u32 end, u32 depth, std::vector<BvhBuildTask> *tasks) {
+        if (tasks && depth >= task_depth) {
+            tasks->push_back({node, begin, end, depth});
+            return;
+        }
+
+        BvhBox bounds;
+        for (u32 i = begin; i < end; i++) bounds.grow(refs[i].min, refs[i].max);
+        nodes[node].min = {bounds.min[0], bounds.min[1], bounds.min[2]};
+        nodes[node].max = {bounds.max[0], bounds.max[1], bounds.max[2]};
+
+        u32 middle = split(begin, end, depth, bounds);
+        if (middle == begin || middle == end) {
+            nodes[node].first = begin;
+            nodes[node].count = end - begin;
+            return;
+        }
+
+        u32 child = (u32)nodes.size();
+        nodes.resize(nodes.size() + 2);
+        nodes[node].first = child;
+        nodes[node].count = 0;
+
+        build(nodes, child, begin, middle, depth + 1, tasks);
+        build(nodes, child + 1, middle, end, depth + 1, tasks);
+    }
+};
+
+// Reorders `refs` into leaf order and fills `nodes`. The upper levels are split on the calling thread, the subtrees
+// below them are built in parallel and spliced into one array.
+template <typename Ref, typename Node> void build_bvh(std::vector<Ref> &refs, std::vector<Node> &nodes, u32 max_leaf) {
+    nodes.clear();
+    if (refs.empty()) return;
+
+    // Enough top-level subtrees to keep every thread busy even when they end up unbalanced
+    u32 threads = std::max<u32>(std::thread::hardware_concurrency(), 1);
+    u32 task_depth = 0;
+    while (task_depth < 12 && (1u << task_depth) < threads * 4) task_depth++;
+    if (threads == 1) task_depth = UINT32_MAX;
+
+    BvhBuilder<Ref, Node> builder = {refs, std::max<u32>(max_leaf, 1), task_depth};
+    std::vector<BvhBuildTask> tasks;
+    nodes.resize(1);
+    builder.build(nodes, 0, 0, (u32)refs.size(), 0, &tasks);
+
+    std::vector<std::vector<Node>> subtrees(tasks.size());
+    parallel_for(tasks.size(), [&](usize t) {
+        subtrees[t].resize(1);
+        builder.build(subtrees[t], 0, tasks[t].begin, tasks[t].end, tasks[t].depth, nullptr);
+    });
+
+    // Subtree root i replaces the placeholder node, the rest is appended with child links shifted accordingly
+    for (usize t = 0; t < tasks.size(); t++) {
+        u32 offset = (u32)nodes.size() - 1;
+        for (usize i = 0; i < subtrees[t].size(); i++) {
+            Node node = subtrees[t][i];
+            if (node.count == 0) node.first += offset;
+
+            if (i == 0) {
+                nodes[tasks[t].node] = node;
+            } else {
+                nodes.push_back(node);
+            }
+        }
+    }
+}
+
+// Slab test; returns the entry distance or FLT_MAX on a miss
+static inline f32 bvh_ray_box(const f32 *origin, const f32 *inverse, f32 max_distance, const Vec3 &min,
+                              const Vec3 &max) {
+    f32 lo[3] = {min.x, min.y, min.z};
+    f32 hi[3] = {max.x, max.y, max.z};
+
+    f32 enter = 0.0f, exit = max_distance;
+    for (usize c = 0; c < 3; c++) {
+        f32 t0 = (lo[c] - origin[c]) * inverse[c];
+        f32 t1 = (hi[c] - origin[c]) * inverse[c];
+        enter = std::max(enter, std::min(t0, t1));
+        exit = std::min(exit, std::max(t0, t1));
+    }
+
+    return enter <= exit ? enter : FLT_MAX;
+}
+
+}; // namespace gltf
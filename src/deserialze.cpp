@@ -3,6 +3,7 @@
 #include "base_64.hpp"
 #include "fs.hpp"
 #include "gltf.hpp"
+#include <cstring>
 #include <fstream>
 #include <iostream>
 #include <sstream>
@@ -45,9 +46,11 @@ bool Model::get_bool(const json_value_s *value) {
 json_value_s *find_member(const json_object_s *object, const char *name) {
     if (!object) return nullptr;
 
+    // Sizes must match as well, otherwise "scene" would be found when looking up "scenes"
+    usize length = std::strlen(name);
     json_object_element_s *element = object->start;
     while (element) {
-        if (strncmp(element->name->string, name, element->name->string_size) == 0) {
+        if (element->name->string_size == length && std::strncmp(element->name->string, name, length) == 0) {
             return element->value;
         }
         element = element->next;
@@ -223,7 +226,7 @@ Model Model::load_from_memory(bool &success, const u8 *data, usize length) {
 // }
 
 bool Model::parse(const json_value_s *root) {
-    buffers.clear();
+    // Buffers are kept, they may already hold the BIN chunk of a GLB file
     buffer_views.clear();
     accessors.clear();
     images.clear();
@@ -892,6 +895,32 @@ bool Model::parse_meshes(const json_object_s *json) {
                             }
                         }
 
+                        // Morph targets
+                        json_value_s *targets_value = find_member(prim_obj, "targets");
+                        if (targets_value && targets_value->type == json_type_array) {
+                            const json_array_s *targets_array = (const json_array_s *)targets_value->payload;
+                            json_array_element_s *target_element = targets_array->start;
+
+                            while (target_element) {
+                                std::map<std::string, u32> target;
+                                if (target_element->value->type == json_type_object) {
+                                    const json_object_s *target_obj =
+                                        (const json_object_s *)target_element->value->payload;
+                                    json_object_element_s *attr_element = target_obj->start;
+
+                                    while (attr_element) {
+                                        std::string attr_name(attr_element->name->string,
+                                                              attr_element->name->string_size);
+                                        target[attr_name] = get_int(attr_element->value);
+                                        attr_element = attr_element->next;
+                                    }
+                                }
+
+                                primitive.targets.push_back(target);
+                                target_element = target_element->next;
+                            }
+                        }
+
                         // Indices
                         json_value_s *indices_value = find_member(prim_obj, "indices");
                         if (indices_value) {
@@ -1096,6 +1125,38 @@ bool Model::parse_nodes(const json_object_s *json) {
                 }
             }
 
+            // Morph target weights
+            json_value_s *weights_value = find_member(node_obj, "weights");
+            if (weights_value && weights_value->type == json_type_array) {
+                const json_array_s *weights_array = (const json_array_s *)weights_value->payload;
+                json_array_element_s *weight_element = weights_array->start;
+
+                while (weight_element) {
+                    node.weights.push_back(get_float(weight_element->value));
+                    weight_element = weight_element->next;
+                }
+            }
+
+            // Extensions
+            json_value_s *extensions_value = find_member(node_obj, "extensions");
+            if (extensions_value && extensions_value->type == json_type_object) {
+                const json_object_s *extensions_obj = (const json_object_s *)extensions_value->payload;
+
+                json_value_s *lod_value = find_member(extensions_obj, "MSFT_lod");
+                if (lod_value && lod_value->type == json_type_object) {
+                    json_value_s *ids_value = find_member((const json_object_s *)lod_value->payload, "ids");
+                    if (ids_value && ids_value->type == json_type_array) {
+                        const json_array_s *ids_array = (const json_array_s *)ids_value->payload;
+                        json_array_element_s *id_element = ids_array->start;
+
+                        while (id_element) {
+                            node.lods.push_back(get_int(id_element->value));
+                            id_element = id_element->next;
+                        }
+                    }
+                }
+            }
+
             // Name
             json_value_s *name_value = find_member(node_obj, "name");
             if (name_value) {
@@ -1196,6 +1257,36 @@ bool Model::parse_animations(const json_object_s *json) {
                             sampler.interpolation = "LINEAR";
                         }
 
+                        // Range quantization written by quantize_animations()
+                        json_value_s *extensions_value = find_member(sampler_obj, "extensions");
+                        json_value_s *dequantize_value =
+                            extensions_value && extensions_value->type == json_type_object
+                                ? find_member((const json_object_s *)extensions_value->payload,
+                                              "XIUXIU_animation_dequantize")
+                                : nullptr;
+                        if (dequantize_value && dequantize_value->type == json_type_object) {
+                            const json_object_s *dequantize_obj = (const json_object_s *)dequantize_value->payload;
+                            json_value_s *offset_value = find_member(dequantize_obj, "offset");
+                            json_value_s *scale_value = find_member(dequantize_obj, "scale");
+
+                            if (offset_value && offset_value->type == json_type_array && scale_value &&
+                                scale_value->type == json_type_array) {
+                                json_array_element_s *offset_element =
+                                    ((const json_array_s *)offset_value->payload)->start;
+                                while (offset_element) {
+                                    sampler.dequantize_offset.push_back(get_float(offset_element->value));
+                                    offset_element = offset_element->next;
+                                }
+
+                                json_array_element_s *scale_element =
+                                    ((const json_array_s *)scale_value->payload)->start;
+                                while (scale_element) {
+                                    sampler.dequantize_scale.push_back(get_float(scale_element->value));
+                                    scale_element = scale_element->next;
+                                }
+                            }
+                        }
+
                         animation.samplers.push_back(sampler);
                     }
 
@@ -0,0 +1,156 @@
+#include "index_format.hpp"
+#include "accessor.hpp"
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define GLTF_INDEX_SSE2 1
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define GLTF_INDEX_NEON 1
+#endif
+
+namespace gltf {
+
+i32 minimal_index_type(u32 max_index, bool allow_u8) {
+    if (allow_u8 && max_index < 0xff) return COMPONENT_UNSIGNED_BYTE;
+    if (max_index < 0xffff) return COMPONENT_UNSIGNED_SHORT;
+    return COMPONENT_UNSIGNED_INT;
+}
+
+static void narrow_u32_to_u16(u16 *dst, const u32 *src, usize count) {
+    usize i = 0;
+#if defined(GLTF_INDEX_SSE2)
+    // SSE2 only has a signed 32 -> 16 bit pack, so values are biased into the signed range and back
+    const __m128i bias32 = _mm_set1_epi32(0x8000);
+    const __m128i bias16 = _mm_set1_epi16((i16)0x8000);
+    for (; i + 8 <= count; i += 8) {
+        __m128i a = _mm_sub_epi32(_mm_loadu_si128((const __m128i *)(src + i)), bias32);
+        __m128i b = _mm_sub_epi32(_mm_loadu_si128((const __m128i *)(src + i + 4)), bias32);
+        _mm_storeu_si128((__m128i *)(dst + i), _mm_xor_si128(_mm_packs_epi32(a, b), bias16));
+    }
+#elif defined(GLTF_INDEX_NEON)
+    for (; i + 8 <= count; i += 8) {
+        uint16x4_t a = vmovn_u32(vld1q_u32(src + i));
+        uint16x4_t b = vmovn_u32(vld1q_u32(src + i + 4));
+        vst1q_u16(dst + i, vcombine_u16(a, b));
+    }
+#endif
+    for (; i < count; i++) dst[i] = (u16)src[i];
+}
+
+static void widen_u16_to_u32(u32 *dst, const u16 *src, usize count) {
+    usize i = 0;
+#if defined(GLTF_INDEX_SSE2)
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 8 <= count; i += 8) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(src + i));
+        _mm_storeu_si128((__m128i *)(dst + i), _mm_unpacklo_epi16(v, zero));
+        _mm_storeu_si128((__m128i *)(dst + i + 4), _mm_unpackhi_epi16(v, zero));
+    }
+#elif defined(GLTF_INDEX_NEON)
+    for (; i + 8 <= count; i += 8) {
+        uint16x8_t v = vld1q_u16(src + i);
+        vst1q_u32(dst + i, vmovl_u16(vget_low_u16(v)));
+        vst1q_u32(dst + i + 4, vmovl_u16(vget_high_u16(v)));
+    }
+#endif
+    for (; i < count; i++) dst[i] = src[i];
+}
+
+void convert_indices(u8 *dst, i32 dst_type, const u8 *src, i32 src_type, usize count) {
+    if (dst_type == src_type) {
+        std::memcpy(dst, src, count * component_size(src_type));
+        return;
+    }
+
+    // Aligned fast paths; glTF requires index accessors to be aligned to their component size
+    if (src_type == COMPONENT_UNSIGNED_INT && dst_type == COMPONENT_UNSIGNED_SHORT && ((usize)src & 3) == 0 &&
+        ((usize)dst & 1) == 0) {
+        narrow_u32_to_u16(reinterpret_cast<u16 *>(dst), reinterpret_cast<const u32 *>(src), count);
+        return;
+    }
+
+    if (src_type == COMPONENT_UNSIGNED_SHORT && dst_type == COMPONENT_UNSIGNED_INT && ((usize)src & 1) == 0 &&
+        ((usize)dst & 3) == 0) {
+        widen_u16_to_u32(reinterpret_cast<u32 *>(dst), reinterpret_cast<const u16 *>(src), count);
+        return;
+    }
+
+    usize src_size = component_size(src_type);
+    usize dst_size = component_size(dst_type);
+    for (usize i = 0; i < count; i++) {
+        write_index(dst + i * dst_size, dst_type, read_index(src + i * src_size, src_type));
+    }
+}
+
+static bool convert_index_accessor(Model &model, u32 accessor, i32 component_type) {
+    AccessorView view;
+    if (!view_accessor(model, accessor, view) || view.components != 1) {
+        std::cerr << "Cannot convert indices: index accessor has no readable data" << std::endl;
+        return false;
+    }
+
+    if (view.component_type == component_type) return true;
+
+    usize size = component_size(component_type);
+    std::vector<u8> data(view.count * size);
+
+    if (view.stride == component_size(view.component_type)) {
+        convert_indices(data.data(), component_type, view.data, view.component_type, view.count);
+    } else {
+        for (usize i = 0; i < view.count; i++) {
+            write_index(data.data() + i * size, component_type, read_index(view.element(i), view.component_type));
+        }
+    }
+
+    u32 buffer_view = append_buffer_view(model, data.data(), data.size(), 0, TARGET_ELEMENT_ARRAY_BUFFER);
+
+    Accessor &acc = model.accessors[accessor];
+    acc.buffer_view = buffer_view;
+    acc.byte_offset = 0;
+    acc.component_type = component_type;
+    return true;
+}
+
+bool narrow_indices(Model &model, Primitive &primitive, bool allow_u8) {
+    if (primitive.indices == UINT32_MAX) return true;
+
+    AccessorView view;
+    if (!view_accessor(model, primitive.indices, view) || view.components != 1) {
+        std::cerr << "Cannot narrow indices: index accessor has no readable data" << std::endl;
+        return false;
+    }
+
+    u32 max_index = 0;
+    for (usize i = 0; i < view.count; i++) {
+        u32 index = read_index(view.element(i), view.component_type);
+        if (index > max_index) max_index = index;
+    }
+
+    i32 component_type = minimal_index_type(max_index, allow_u8);
+    if (component_size(component_type) >= component_size(view.component_type)) return true;
+
+    return convert_index_accessor(model, primitive.indices, component_type);
+}
+
+bool widen_indices(Model &model, Primitive &primitive) {
+    if (primitive.indices == UINT32_MAX) return true;
+
+    return convert_index_accessor(model, primitive.indices, COMPONENT_UNSIGNED_INT);
+}
+
+bool narrow_indices(Model &model, bool allow_u8) {
+    bool success = true;
+    for (Mesh &mesh : model.meshes) {
+        for (Primitive &primitive : mesh.primitives) {
+            success &= narrow_indices(model, primitive, allow_u8);
+        }
+    }
+
+    return success;
+}
+
+}; // namespace gltf
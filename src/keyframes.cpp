@@ -0,0 +1,365 @@
+#include "keyframes.hpp"
+#include "accessor.hpp"
+#include "animation.hpp"
+#include "math.hpp"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <iostream>
+#include <map>
+#include <vector>
+
+namespace gltf {
+
+// Input accessors written so far, keyed by their key times
+typedef std::map<std::vector<f32>, u32> TimeAccessors;
+
+struct SamplerKeys {
+    u32 sampler;
+    u8 path;
+    u32 width;
+    std::vector<f32> times;
+    std::vector<f32> values; // `width` per key
+    usize keys_before;
+};
+
+static void interpolate(u8 path, const f32 *a, const f32 *b, f32 t, u32 width, f32 *out) {
+    if (path == ANIMATION_PATH_ROTATION) {
+        Vec4 q = quat_slerp({a[0], a[1], a[2], a[3]}, {b[0], b[1], b[2], b[3]}, t);
+        out[0] = q.x;
+        out[1] = q.y;
+        out[2] = q.z;
+        out[3] = q.w;
+        return;
+    }
+
+    for (u32 c = 0; c < width; c++) out[c] = a[c] + (b[c] - a[c]) * t;
+}
+
+// Whether `approximation` may stand in for the key value `exact`, by the metric of the animated path
+static bool within_tolerance(u8 path, const f32 *exact, const f32 *approximation, u32 width,
+                             const KeyframeOptions &options) {
+    switch (path) {
+    case ANIMATION_PATH_TRANSLATION: {
+        f32 dx = exact[0] - approximation[0], dy = exact[1] - approximation[1], dz = exact[2] - approximation[2];
+        return dx * dx + dy * dy + dz * dz <= options.translation_tolerance * options.translation_tolerance;
+    }
+    case ANIMATION_PATH_ROTATION: {
+        f32 dot = exact[0] * approximation[0] + exact[1] * approximation[1] + exact[2] * approximation[2] +
+                  exact[3] * approximation[3];
+        f32 angle = 2.0f * std::acos(std::min(std::fabs(dot), 1.0f));
+        return angle <= options.rotation_tolerance;
+    }
+    case ANIMATION_PATH_SCALE:
+        // Relative, except around zero where a ratio stops meaning anything
+        for (u32 c = 0; c < 3; c++) {
+            f32 reference = std::max(std::fabs(exact[c]), 1e-3f);
+            if (std::fabs(exact[c] - approximation[c]) > options.scale_tolerance * reference) return false;
+        }
+        return true;
+    default:
+        for (u32 c = 0; c < width; c++) {
+            if (std::fabs(exact[c] - approximation[c]) > options.weight_tolerance) return false;
+        }
+        return true;
+    }
+}
+
+// Whether interpolating keys `first` and `last` reproduces every key between them
+static bool span_fits(const SamplerKeys &keys, usize first, usize last, const KeyframeOptions &options) {
+    u32 width = keys.width;
+    const f32 *a = &keys.values[first * width], *b = &keys.values[last * width];
+    f32 duration = keys.times[last] - keys.times[first];
+
+    f32 value[4];
+    std::vector<f32> wide(width > 4 ? width : 0);
+    f32 *approximation = width > 4 ? wide.data() : value;
+
+    for (usize k = first + 1; k < last; k++) {
+        f32 t = duration > 0.0f ? (keys.times[k] - keys.times[first]) / duration : 0.0f;
+        interpolate(keys.path, a, b, t, width, approximation);
+        if (!within_tolerance(keys.path, &keys.values[k * width], approximation, width, options)) return false;
+    }
+    return true;
+}
+
+// Indices of the keys to keep for LINEAR interpolation. From each kept key the span is first grown exponentially,
+// then the longest fitting end is found by bisection between the last span that fit and the first that did not.
+static void reduce_linear(const SamplerKeys &keys, const KeyframeOptions &options, std::vector<usize> &kept) {
+    usize n = keys.times.size();
+    kept.assign(1, 0);
+
+    usize first = 0;
+    while (first + 1 < n) {
+        usize good = first + 1, bad = n;
+        for (usize step = 2;; step *= 2) {
+            usize last = std::min(first + step, n - 1);
+            if (last <= good) break;
+
+            if (!span_fits(keys, first, last, options)) {
+                bad = last;
+                break;
+            }
+            good = last;
+        }
+
+        while (bad - good > 1) {
+            usize middle = good + (bad - good) / 2;
+            if (span_fits(keys, first, middle, options)) {
+                good = middle;
+            } else {
+                bad = middle;
+            }
+        }
+
+        kept.push_back(good);
+        first = good;
+    }
+}
+
+// STEP keys only matter where the value changes; the last key is kept to preserve the duration
+static void reduce_step(const SamplerKeys &keys, const KeyframeOptions &options, std::vector<usize> &kept) {
+    usize n = keys.times.size();
+    u32 width = keys.width;
+    kept.assign(1, 0);
+
+    for (usize k = 1; k < n; k++) {
+        const f32 *previous = &keys.values[kept.back() * width];
+        if (k == n - 1 || !within_tolerance(keys.path, &keys.values[k * width], previous, width, options)) {
+            kept.push_back(k);
+        }
+    }
+}
+
+// Key times the sampler is resampled at: every 1 / rate seconds from its first key, plus its last key
+static void resample_times(const AnimationTrack &track, f32 rate, std::vector<f32> &times) {
+    f32 start, end;
+    read_components(track.input.element(0), COMPONENT_FLOAT, false, 1, &start);
+    read_components(track.input.element(track.input.count - 1), COMPONENT_FLOAT, false, 1, &end);
+
+    times.clear();
+    usize steps = end > start ? (usize)std::ceil((end - start) * rate - 1e-3f) : 0;
+    for (usize i = 0; i < steps; i++) times.push_back((f32)(start + (f64)i / rate));
+    times.push_back(end);
+}
+
+// Path animated by the channels of `sampler`; false when no channel uses it or they disagree
+static bool sampler_path(const Animation &animation, u32 sampler, u8 &path) {
+    bool found = false;
+    for (const AnimationChannel &channel : animation.channels) {
+        u8 channel_path;
+        if (channel.sampler != sampler || !parse_animation_path(channel.target.path, channel_path)) continue;
+        if (found && channel_path != path) return false;
+
+        path = channel_path;
+        found = true;
+    }
+    return found;
+}
+
+static bool optimize(Model &model, u32 animation, const KeyframeOptions &options, TimeAccessors &inputs,
+                     KeyframeStats *stats) {
+    if (animation >= model.animations.size()) {
+        std::cerr << "Cannot optimize animation: animation " << animation << " does not exist" << std::endl;
+        return false;
+    }
+
+    // Every sampler is decoded before any accessor is added, since adding buffers may move the data the tracks view
+    std::vector<SamplerKeys> rewritten;
+    const Animation &source = model.animations[animation];
+    for (u32 s = 0; s < source.samplers.size(); s++) {
+        SamplerKeys keys;
+        AnimationTrack track;
+        if (!sampler_path(source, s, keys.path)) continue;
+        if (!view_animation_sampler(model, animation, s, keys.path, track)) return false;
+
+        keys.keys_before = track.input.count;
+        bool resample = options.sample_rate > 0.0f && track.interpolation != INTERPOLATION_STEP;
+        if (!resample && track.interpolation == INTERPOLATION_CUBICSPLINE) {
+            if (stats) {
+                stats->keys_before += keys.keys_before;
+                stats->keys_after += keys.keys_before;
+            }
+            continue;
+        }
+
+        if (resample) {
+            resample_times(track, options.sample_rate, keys.times);
+        } else {
+            keys.times.resize(track.input.count);
+            for (usize k = 0; k < track.input.count; k++) {
+                read_components(track.input.element(k), COMPONENT_FLOAT, false, 1, &keys.times[k]);
+            }
+        }
+
+        keys.sampler = s;
+        keys.width = track.width;
+        keys.values.resize(keys.times.size() * track.width);
+        u32 cursor = 0;
+        for (usize k = 0; k < keys.times.size(); k++) {
+            sample_track(track, keys.times[k], &keys.values[k * track.width], cursor);
+        }
+
+        std::vector<usize> kept;
+        if (track.interpolation == INTERPOLATION_STEP) {
+            reduce_step(keys, options, kept);
+        } else {
+            reduce_linear(keys, options, kept);
+        }
+
+        for (usize k = 0; k < kept.size(); k++) {
+            keys.times[k] = keys.times[kept[k]];
+            std::copy_n(&keys.values[kept[k] * keys.width], keys.width, &keys.values[k * keys.width]);
+        }
+        keys.times.resize(kept.size());
+        keys.values.resize(kept.size() * keys.width);
+
+        rewritten.push_back(std::move(keys));
+    }
+
+    for (const SamplerKeys &keys : rewritten) {
+        auto input = inputs.find(keys.times);
+        if (input == inputs.end()) {
+            input = inputs.emplace(keys.times, add_float_accessor(model, keys.times, "SCALAR", 0)).first;
+        }
+
+        const char *type = keys.path == ANIMATION_PATH_WEIGHTS ? "SCALAR" : keys.width == 4 ? "VEC4" : "VEC3";
+        AnimationSampler &sampler = model.animations[animation].samplers[keys.sampler];
+        sampler.input = input->second;
+        sampler.output = add_float_accessor(model, keys.values, type, 0);
+        sampler.dequantize_offset.clear();
+        sampler.dequantize_scale.clear();
+        if (sampler.interpolation == "CUBICSPLINE") sampler.interpolation = "LINEAR";
+
+        if (stats) {
+            stats->keys_before += keys.keys_before;
+            stats->keys_after += keys.times.size();
+        }
+    }
+
+    return true;
+}
+
+bool optimize_animation(Model &model, u32 animation, const KeyframeOptions &options, KeyframeStats *stats) {
+    TimeAccessors inputs;
+    return optimize(model, animation, options, inputs, stats);
+}
+
+bool optimize_animations(Model &model, const KeyframeOptions &options, KeyframeStats *stats) {
+    TimeAccessors inputs;
+    for (u32 a = 0; a < model.animations.size(); a++) {
+        if (!optimize(model, a, options, inputs, stats)) return false;
+    }
+    return true;
+}
+
+struct QuantizedOutput {
+    u32 sampler;
+    std::vector<f32> values; // In [-1, 1]
+    std::vector<f32> offset; // Range of translations and scales, empty otherwise
+    std::vector<f32> scale;
+};
+
+// Maps every component of a translation or scale sampler into [-1, 1] around the centre of its values. CUBICSPLINE
+// tangents are derivatives, so they only take the scale; the range is widened to cover them too.
+static void quantize_range(const AnimationTrack &track, QuantizedOutput &output) {
+    bool cubic = track.interpolation == INTERPOLATION_CUBICSPLINE;
+    usize elements = output.values.size() / 3;
+
+    output.offset.assign(3, 0.0f);
+    output.scale.assign(3, 1.0f);
+    for (usize c = 0; c < 3; c++) {
+        f32 lo = FLT_MAX, hi = -FLT_MAX, tangent = 0.0f;
+        for (usize e = 0; e < elements; e++) {
+            f32 v = output.values[e * 3 + c];
+            if (cubic && e % 3 != 1) {
+                tangent = std::max(tangent, std::fabs(v));
+            } else {
+                lo = std::min(lo, v);
+                hi = std::max(hi, v);
+            }
+        }
+
+        f32 offset = (lo + hi) * 0.5f, scale = std::max((hi - lo) * 0.5f, tangent);
+        if (!(scale > 0.0f)) scale = 1.0f;
+        output.offset[c] = offset;
+        output.scale[c] = scale;
+
+        for (usize e = 0; e < elements; e++) {
+            f32 &v = output.values[e * 3 + c];
+            v = std::min(std::max((cubic && e % 3 != 1 ? v : v - offset) / scale, -1.0f), 1.0f);
+        }
+    }
+}
+
+static bool quantize(Model &model, u32 animation, const KeyframeQuantizeOptions &options) {
+    if (animation >= model.animations.size()) {
+        std::cerr << "Cannot quantize animation: animation " << animation << " does not exist" << std::endl;
+        return false;
+    }
+
+    // As in optimize(), every output is decoded before any accessor is added
+    std::vector<QuantizedOutput> rewritten;
+    const Animation &source = model.animations[animation];
+    for (u32 s = 0; s < source.samplers.size(); s++) {
+        u8 path;
+        if (!sampler_path(source, s, path)) continue;
+
+        bool selected = path == ANIMATION_PATH_ROTATION      ? options.rotations
+                        : path == ANIMATION_PATH_WEIGHTS     ? options.weights
+                        : path == ANIMATION_PATH_TRANSLATION ? options.translations
+                                                             : options.scales;
+        if (!selected) continue;
+
+        AnimationTrack track;
+        if (!view_animation_sampler(model, animation, s, path, track)) return false;
+        if (track.output.component_type != COMPONENT_FLOAT) continue;
+
+        QuantizedOutput output;
+        output.sampler = s;
+        usize components = track.output.components;
+        output.values.resize(track.output.count * components);
+        for (usize e = 0; e < track.output.count; e++) {
+            f32 *values = &output.values[e * components];
+            read_components(track.output.element(e), COMPONENT_FLOAT, false, components, values);
+        }
+
+        if (path == ANIMATION_PATH_TRANSLATION || path == ANIMATION_PATH_SCALE) {
+            quantize_range(track, output);
+        } else if (path == ANIMATION_PATH_ROTATION && track.interpolation != INTERPOLATION_CUBICSPLINE) {
+            for (usize q = 0; q < output.values.size(); q += 4) {
+                f32 *v = &output.values[q];
+                Vec4 unit = quat_normalize({v[0], v[1], v[2], v[3]});
+                v[0] = unit.x, v[1] = unit.y, v[2] = unit.z, v[3] = unit.w;
+            }
+        }
+
+        // Weights and CUBICSPLINE rotation tangents outside the normalized range would be clamped
+        bool representable = true;
+        for (f32 v : output.values) representable = representable && std::fabs(v) <= 1.0f;
+        if (representable) rewritten.push_back(std::move(output));
+    }
+
+    for (const QuantizedOutput &output : rewritten) {
+        AnimationSampler &sampler = model.animations[animation].samplers[output.sampler];
+        std::string type = model.accessors[sampler.output].type;
+        sampler.output = add_normalized_accessor(model, output.values, type, COMPONENT_SHORT, 0);
+        sampler.dequantize_offset = output.offset;
+        sampler.dequantize_scale = output.scale;
+    }
+
+    return true;
+}
+
+bool quantize_animation(Model &model, u32 animation, const KeyframeQuantizeOptions &options) {
+    return quantize(model, animation, options);
+}
+
+bool quantize_animations(Model &model, const KeyframeQuantizeOptions &options) {
+    for (u32 a = 0; a < model.animations.size(); a++) {
+        if (!quantize(model, a, options)) return false;
+    }
+    return true;
+}
+
+}; // namespace gltf
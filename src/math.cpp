@@ -0,0 +1,251 @@
+#include "math.hpp"
+#include "simd.hpp"
+#include <cfloat>
+#include <cmath>
+
+namespace gltf {
+
+Mat4 mat4_multiply(const Mat4 &a, const Mat4 &b) {
+    F4 a0 = f4_load(a.cols[0]), a1 = f4_load(a.cols[1]), a2 = f4_load(a.cols[2]), a3 = f4_load(a.cols[3]);
+
+    // Column j of the product is a's columns weighted by the components of b's column j
+    Mat4 r;
+    for (usize j = 0; j < 4; j++) {
+        const f32 *c = b.cols[j];
+        f4_store(r.cols[j], a0 * f4_splat(c[0]) + a1 * f4_splat(c[1]) + a2 * f4_splat(c[2]) + a3 * f4_splat(c[3]));
+    }
+    return r;
+}
+
+void mat4_multiply_batch(const Mat4 *a, const Mat4 *b, Mat4 *out, usize count) {
+    for (usize i = 0; i < count; i++) out[i] = mat4_multiply(a[i], b[i]);
+}
+
+Mat4 mat4_transpose(const Mat4 &matrix) {
+    Mat4 r;
+    for (usize c = 0; c < 4; c++) {
+        for (usize row = 0; row < 4; row++) r.cols[row][c] = matrix.cols[c][row];
+    }
+    return r;
+}
+
+bool mat4_inverse(const Mat4 &matrix, Mat4 &inverse) {
+    // 2x2 sub-determinants of the first and last two columns; inverting the transpose and transposing back is the
+    // same as inverting, so the column-major array can be read as rows a[i][j] = cols[i][j]
+    const f32(*a)[4] = matrix.cols;
+    f32 s0 = a[0][0] * a[1][1] - a[1][0] * a[0][1];
+    f32 s1 = a[0][0] * a[1][2] - a[1][0] * a[0][2];
+    f32 s2 = a[0][0] * a[1][3] - a[1][0] * a[0][3];
+    f32 s3 = a[0][1] * a[1][2] - a[1][1] * a[0][2];
+    f32 s4 = a[0][1] * a[1][3] - a[1][1] * a[0][3];
+    f32 s5 = a[0][2] * a[1][3] - a[1][2] * a[0][3];
+    f32 c5 = a[2][2] * a[3][3] - a[3][2] * a[2][3];
+    f32 c4 = a[2][1] * a[3][3] - a[3][1] * a[2][3];
+    f32 c3 = a[2][1] * a[3][2] - a[3][1] * a[2][2];
+    f32 c2 = a[2][0] * a[3][3] - a[3][0] * a[2][3];
+    f32 c1 = a[2][0] * a[3][2] - a[3][0] * a[2][2];
+    f32 c0 = a[2][0] * a[3][1] - a[3][0] * a[2][1];
+
+    f32 det = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+    if (!(std::fabs(det) >= FLT_MIN) || !std::isfinite(det)) return false;
+
+    F4 scale = f4_splat(1.0f / det);
+    F4 r0 = f4_set(a[1][1] * c5 - a[1][2] * c4 + a[1][3] * c3, -a[0][1] * c5 + a[0][2] * c4 - a[0][3] * c3,
+                   a[3][1] * s5 - a[3][2] * s4 + a[3][3] * s3, -a[2][1] * s5 + a[2][2] * s4 - a[2][3] * s3);
+    F4 r1 = f4_set(-a[1][0] * c5 + a[1][2] * c2 - a[1][3] * c1, a[0][0] * c5 - a[0][2] * c2 + a[0][3] * c1,
+                   -a[3][0] * s5 + a[3][2] * s2 - a[3][3] * s1, a[2][0] * s5 - a[2][2] * s2 + a[2][3] * s1);
+    F4 r2 = f4_set(a[1][0] * c4 - a[1][1] * c2 + a[1][3] * c0, -a[0][0] * c4 + a[0][1] * c2 - a[0][3] * c0,
+                   a[3][0] * s4 - a[3][1] * s2 + a[3][3] * s0, -a[2][0] * s4 + a[2][1] * s2 - a[2][3] * s0);
+    F4 r3 = f4_set(-a[1][0] * c3 + a[1][1] * c1 - a[1][2] * c0, a[0][0] * c3 - a[0][1] * c1 + a[0][2] * c0,
+                   -a[3][0] * s3 + a[3][1] * s1 - a[3][2] * s0, a[2][0] * s3 - a[2][1] * s1 + a[2][2] * s0);
+
+    f4_store(inverse.cols[0], r0 * scale);
+    f4_store(inverse.cols[1], r1 * scale);
+    f4_store(inverse.cols[2], r2 * scale);
+    f4_store(inverse.cols[3], r3 * scale);
+    return true;
+}
+
+bool mat4_affine_inverse(const Mat4 &matrix, Mat4 &inverse) {
+    const f32 *x = matrix.cols[0], *y = matrix.cols[1], *z = matrix.cols[2];
+
+    // Rows of the inverse 3x3 block are the cross products of the other two columns over the determinant
+    f32 yz[3] = {y[1] * z[2] - y[2] * z[1], y[2] * z[0] - y[0] * z[2], y[0] * z[1] - y[1] * z[0]};
+    f32 zx[3] = {z[1] * x[2] - z[2] * x[1], z[2] * x[0] - z[0] * x[2], z[0] * x[1] - z[1] * x[0]};
+    f32 xy[3] = {x[1] * y[2] - x[2] * y[1], x[2] * y[0] - x[0] * y[2], x[0] * y[1] - x[1] * y[0]};
+
+    f32 det = x[0] * yz[0] + x[1] * yz[1] + x[2] * yz[2];
+    if (!(std::fabs(det) >= FLT_MIN) || !std::isfinite(det)) return false;
+
+    F4 scale = f4_splat(1.0f / det);
+    F4 c0 = f4_set(yz[0], zx[0], xy[0], 0.0f) * scale;
+    F4 c1 = f4_set(yz[1], zx[1], xy[1], 0.0f) * scale;
+    F4 c2 = f4_set(yz[2], zx[2], xy[2], 0.0f) * scale;
+    const f32 *t = matrix.cols[3];
+    F4 c3 = f4_set(0.0f, 0.0f, 0.0f, 1.0f) - (c0 * f4_splat(t[0]) + c1 * f4_splat(t[1]) + c2 * f4_splat(t[2]));
+
+    f4_store(inverse.cols[0], c0);
+    f4_store(inverse.cols[1], c1);
+    f4_store(inverse.cols[2], c2);
+    f4_store(inverse.cols[3], c3);
+    return true;
+}
+
+Mat4 compose_trs(const Vec3 &translation, const Vec4 &rotation, const Vec3 &scale) {
+    const Vec4 &q = rotation;
+    f32 xx = q.x * q.x, yy = q.y * q.y, zz = q.z * q.z;
+    f32 xy = q.x * q.y, xz = q.x * q.z, yz = q.y * q.z;
+    f32 xw = q.x * q.w, yw = q.y * q.w, zw = q.z * q.w;
+
+    Mat4 m;
+    m.cols[0][0] = (1.0f - 2.0f * (yy + zz)) * scale.x;
+    m.cols[0][1] = 2.0f * (xy + zw) * scale.x;
+    m.cols[0][2] = 2.0f * (xz - yw) * scale.x;
+    m.cols[0][3] = 0.0f;
+    m.cols[1][0] = 2.0f * (xy - zw) * scale.y;
+    m.cols[1][1] = (1.0f - 2.0f * (xx + zz)) * scale.y;
+    m.cols[1][2] = 2.0f * (yz + xw) * scale.y;
+    m.cols[1][3] = 0.0f;
+    m.cols[2][0] = 2.0f * (xz + yw) * scale.z;
+    m.cols[2][1] = 2.0f * (yz - xw) * scale.z;
+    m.cols[2][2] = (1.0f - 2.0f * (xx + yy)) * scale.z;
+    m.cols[2][3] = 0.0f;
+    m.cols[3][0] = translation.x;
+    m.cols[3][1] = translation.y;
+    m.cols[3][2] = translation.z;
+    m.cols[3][3] = 1.0f;
+    return m;
+}
+
+void decompose_trs(const Mat4 &matrix, Vec3 &translation, Vec4 &rotation, Vec3 &scale) {
+    const f32(*c)[4] = matrix.cols;
+    translation = {c[3][0], c[3][1], c[3][2]};
+
+    f32 s[3];
+    for (usize i = 0; i < 3; i++) s[i] = std::sqrt(c[i][0] * c[i][0] + c[i][1] * c[i][1] + c[i][2] * c[i][2]);
+
+    f32 det = c[0][0] * (c[1][1] * c[2][2] - c[2][1] * c[1][2]) - c[1][0] * (c[0][1] * c[2][2] - c[2][1] * c[0][2]) +
+              c[2][0] * (c[0][1] * c[1][2] - c[1][1] * c[0][2]);
+    if (det < 0.0f) s[0] = -s[0];
+    scale = {s[0], s[1], s[2]};
+
+    // Rotation part r[column][row], then Shepperd's method picking the largest diagonal term for stability
+    f32 r[3][3];
+    for (usize i = 0; i < 3; i++) {
+        f32 inv = s[i] != 0.0f ? 1.0f / s[i] : 0.0f;
+        for (usize j = 0; j < 3; j++) r[i][j] = c[i][j] * inv;
+    }
+
+    f32 trace = r[0][0] + r[1][1] + r[2][2];
+    Vec4 q;
+    if (trace > 0.0f) {
+        f32 k = 0.5f / std::sqrt(trace + 1.0f);
+        q = {(r[1][2] - r[2][1]) * k, (r[2][0] - r[0][2]) * k, (r[0][1] - r[1][0]) * k, 0.25f / k};
+    } else if (r[0][0] > r[1][1] && r[0][0] > r[2][2]) {
+        f32 k = 0.5f / std::sqrt(1.0f + r[0][0] - r[1][1] - r[2][2]);
+        q = {0.25f / k, (r[1][0] + r[0][1]) * k, (r[2][0] + r[0][2]) * k, (r[1][2] - r[2][1]) * k};
+    } else if (r[1][1] > r[2][2]) {
+        f32 k = 0.5f / std::sqrt(1.0f + r[1][1] - r[0][0] - r[2][2]);
+        q = {(r[1][0] + r[0][1]) * k, 0.25f / k, (r[2][1] + r[1][2]) * k, (r[2][0] - r[0][2]) * k};
+    } else {
+        f32 k = 0.5f / std::sqrt(1.0f + r[2][2] - r[0][0] - r[1][1]);
+        q = {(r[2][0] + r[0][2]) * k, (r[2][1] + r[1][2]) * k, 0.25f / k, (r[0][1] - r[1][0]) * k};
+    }
+
+    f32 length = std::sqrt(q.x * q.x + q.y * q.y + q.z * q.z + q.w * q.w);
+    rotation = length > 0.0f ? Vec4{q.x / length, q.y / length, q.z / length, q.w / length} : Vec4{0, 0, 0, 1};
+}
+
+Vec4 quat_multiply(const Vec4 &a, const Vec4 &b) {
+    return {a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y, a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x,
+            a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w, a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z};
+}
+
+Vec4 quat_normalize(const Vec4 &q) {
+    f32 length = std::sqrt(q.x * q.x + q.y * q.y + q.z * q.z + q.w * q.w);
+    if (length == 0.0f) return {0.0f, 0.0f, 0.0f, 1.0f};
+
+    Vec4 r;
+    f4_store(&r.x, f4_load(&q.x) * f4_splat(1.0f / length));
+    return r;
+}
+
+// a * wa + b * wb; callers negate wb when the quaternions lie in opposite hemispheres so the blend takes the short arc
+static Vec4 quat_blend(const Vec4 &a, const Vec4 &b, f32 wa, f32 wb) {
+    Vec4 r;
+    f4_store(&r.x, f4_load(&a.x) * f4_splat(wa) + f4_load(&b.x) * f4_splat(wb));
+    return r;
+}
+
+Vec4 quat_nlerp(const Vec4 &a, const Vec4 &b, f32 t) {
+    f32 d = a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w;
+    return quat_normalize(quat_blend(a, b, 1.0f - t, d < 0.0f ? -t : t));
+}
+
+Vec4 quat_slerp(const Vec4 &a, const Vec4 &b, f32 t) {
+    f32 d = a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w;
+    f32 sign = d < 0.0f ? -1.0f : 1.0f;
+    d *= sign;
+
+    // sin(theta) loses precision near zero, where the arc is short enough for nlerp anyway
+    if (d > 0.9995f) return quat_normalize(quat_blend(a, b, 1.0f - t, t * sign));
+
+    f32 theta = std::acos(d);
+    f32 inv_sin = 1.0f / std::sin(theta);
+    return quat_blend(a, b, std::sin((1.0f - t) * theta) * inv_sin, std::sin(t * theta) * inv_sin * sign);
+}
+
+Vec3 quat_rotate(const Vec4 &q, const Vec3 &v) {
+    // v + 2w (q x v) + 2 q x (q x v)
+    f32 cx = q.y * v.z - q.z * v.y, cy = q.z * v.x - q.x * v.z, cz = q.x * v.y - q.y * v.x;
+    cx += cx, cy += cy, cz += cz;
+    return {v.x + q.w * cx + q.y * cz - q.z * cy, v.y + q.w * cy + q.z * cx - q.x * cz,
+            v.z + q.w * cz + q.x * cy - q.y * cx};
+}
+
+Vec3 transform_point(const Mat4 &matrix, const Vec3 &point) {
+    Vec3 r;
+    transform_points(matrix, &point, &r, 1);
+    return r;
+}
+
+Vec3 transform_vector(const Mat4 &matrix, const Vec3 &vector) {
+    Vec3 r;
+    transform_vectors(matrix, &vector, &r, 1);
+    return r;
+}
+
+template <bool Points> static void transform_batch(const Mat4 &matrix, const Vec3 *in, Vec3 *out, usize count) {
+    F4 c0 = f4_load(matrix.cols[0]), c1 = f4_load(matrix.cols[1]), c2 = f4_load(matrix.cols[2]);
+    F4 c3 = Points ? f4_load(matrix.cols[3]) : f4_splat(0.0f);
+
+    // Four vectors per iteration. Each result is staged 3 floats after the previous one (its spare lane is overwritten
+    // by the next), then the 12 packed floats go out as three 16-byte stores that end exactly at out[i + 3]. All four
+    // inputs are read before anything is written, so `out` may alias `in`.
+    usize i = 0;
+    for (; i + 4 <= count; i += 4) {
+        f32 packed[16];
+        for (usize k = 0; k < 4; k++) {
+            const Vec3 &v = in[i + k];
+            f4_store(packed + k * 3, c0 * f4_splat(v.x) + c1 * f4_splat(v.y) + c2 * f4_splat(v.z) + c3);
+        }
+
+        f32 *po = &out[i].x;
+        for (usize k = 0; k < 3; k++) f4_store(po + k * 4, f4_load(packed + k * 4));
+    }
+    for (; i < count; i++) {
+        f32 r[4];
+        f4_store(r, c0 * f4_splat(in[i].x) + c1 * f4_splat(in[i].y) + c2 * f4_splat(in[i].z) + c3);
+        out[i] = {r[0], r[1], r[2]};
+    }
+}
+
+void transform_points(const Mat4 &matrix, const Vec3 *in, Vec3 *out, usize count) {
+    transform_batch<true>(matrix, in, out, count);
+}
+
+void transform_vectors(const Mat4 &matrix, const Vec3 *in, Vec3 *out, usize count) {
+    transform_batch<false>(matrix, in, out, count);
+}
+
+}; // namespace gltf
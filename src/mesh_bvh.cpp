@@ -0,0 +1,365 @@
+#include "mesh_bvh.hpp"
+#include "bvh_build.hpp"
+#include "parallel.hpp"
+#include "simd.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+namespace gltf {
+
+struct TriangleRef {
+    Vec3 min;
+    u32 primitive;
+    Vec3 max;
+    u32 triangle;
+};
+
+static inline void fetch_position(const AccessorView &view, u32 vertex, f32 *out) {
+    const u8 *element = view.element(vertex);
+    if (view.component_type == COMPONENT_FLOAT) {
+        std::memcpy(out, element, 3 * sizeof(f32));
+    } else {
+        read_components(element, view.component_type, view.normalized, 3, out);
+    }
+}
+
+static inline void fetch_triangle(const MeshBvhSource &source, u32 triangle, f32 (*out)[3]) {
+    for (u32 k = 0; k < 3; k++) {
+        u32 corner = triangle * 3 + k;
+        u32 vertex = source.indices.count ? read_index(source.indices.element(corner), source.indices.component_type)
+                                          : corner;
+        fetch_position(source.positions, vertex, out[k]);
+    }
+}
+
+static u32 triangle_count(const MeshBvhSource &source) {
+    return (u32)((source.indices.count ? source.indices.count : source.positions.count) / 3);
+}
+
+bool build_mesh_bvh(const Model &model, u32 mesh, MeshBvh &bvh, u32 max_leaf_triangles) {
+    bvh.nodes.clear();
+    bvh.triangles.clear();
+    bvh.sources.clear();
+    bvh.mesh = mesh;
+
+    if (mesh >= model.meshes.size()) {
+        std::cerr << "Cannot build mesh BVH: mesh " << mesh << " does not exist" << std::endl;
+        return false;
+    }
+
+    const std::vector<Primitive> &primitives = model.meshes[mesh].primitives;
+    bvh.sources.resize(primitives.size());
+
+    std::vector<u32> offsets(primitives.size() + 1, 0);
+    for (usize p = 0; p < primitives.size(); p++) {
+        const Primitive &primitive = primitives[p];
+        MeshBvhSource &source = bvh.sources[p];
+        offsets[p + 1] = offsets[p];
+        if (primitive.mode != 4) continue;
+
+        auto position = primitive.attributes.find("POSITION");
+        if (position == primitive.attributes.end() || !view_accessor(model, position->second, source.positions) ||
+            source.positions.components != 3) {
+            std::cerr << "Cannot build mesh BVH: primitive " << p << " has no readable VEC3 POSITION" << std::endl;
+            return false;
+        }
+        if (primitive.indices != UINT32_MAX &&
+            (!view_accessor(model, primitive.indices, source.indices) || source.indices.components != 1)) {
+            std::cerr << "Cannot build mesh BVH: primitive " << p << " has no readable indices" << std::endl;
+            return false;
+        }
+
+        // Validate indices once so queries can fetch without bounds checks
+        for (usize i = 0; i < source.indices.count; i++) {
+            if (read_index(source.indices.element(i), source.indices.component_type) >= source.positions.count) {
+                std::cerr << "Cannot build mesh BVH: primitive " << p << " has out of range indices" << std::endl;
+                return false;
+            }
+        }
+
+        offsets[p + 1] += triangle_count(source);
+    }
+
+    std::vector<TriangleRef> refs(offsets.back());
+    parallel_for(primitives.size(), [&](usize p) {
+        for (u32 t = 0; t < offsets[p + 1] - offsets[p]; t++) {
+            f32 v[3][3];
+            fetch_triangle(bvh.sources[p], t, v);
+
+            TriangleRef &ref = refs[offsets[p] + t];
+            ref.primitive = (u32)p;
+            ref.triangle = t;
+            ref.min = {std::min(v[0][0], std::min(v[1][0], v[2][0])), std::min(v[0][1], std::min(v[1][1], v[2][1])),
+                       std::min(v[0][2], std::min(v[1][2], v[2][2]))};
+            ref.max = {std::max(v[0][0], std::max(v[1][0], v[2][0])), std::max(v[0][1], std::max(v[1][1], v[2][1])),
+                       std::max(v[0][2], std::max(v[1][2], v[2][2]))};
+        }
+    });
+
+    build_bvh(refs, bvh.nodes, max_leaf_triangles);
+
+    bvh.triangles.resize(refs.size());
+    for (usize i = 0; i < refs.size(); i++) {
+        bvh.triangles[i].primitive = refs[i].primitive;
+        bvh.triangles[i].triangle = refs[i].triangle;
+    }
+
+    return true;
+}
+
+// Up to four triangles in SoA form: first vertex and the two edges leaving it
+struct TrianglePack {
+    F4 v0[3], e1[3], e2[3];
+    u32 count;
+};
+
+static void load_pack(const MeshBvh &bvh, u32 first, u32 count, TrianglePack &pack) {
+    f32 v0[3][4], e1[3][4], e2[3][4];
+    for (u32 lane = 0; lane < 4; lane++) {
+        // Unused lanes repeat the last triangle and are masked out by the callers
+        const MeshBvhTriangle &triangle = bvh.triangles[first + std::min(lane, count - 1)];
+
+        f32 v[3][3];
+        fetch_triangle(bvh.sources[triangle.primitive], triangle.triangle, v);
+        for (usize c = 0; c < 3; c++) {
+            v0[c][lane] = v[0][c];
+            e1[c][lane] = v[1][c] - v[0][c];
+            e2[c][lane] = v[2][c] - v[0][c];
+        }
+    }
+
+    for (usize c = 0; c < 3; c++) {
+        pack.v0[c] = f4_load(v0[c]);
+        pack.e1[c] = f4_load(e1[c]);
+        pack.e2[c] = f4_load(e2[c]);
+    }
+    pack.count = count;
+}
+
+// Moller-Trumbore on four lanes. Each lane pairs one ray with one triangle; the caller broadcasts whichever side is
+// shared. Returns the lane mask of hits in [0, t_max) with t, u, v filled in.
+static inline F4 intersect4(const F4 *o, const F4 *d, const F4 *v0, const F4 *e1, const F4 *e2, F4 t_max, F4 &t,
+                            F4 &u, F4 &v) {
+    F4 px = d[1] * e2[2] - d[2] * e2[1];
+    F4 py = d[2] * e2[0] - d[0] * e2[2];
+    F4 pz = d[0] * e2[1] - d[1] * e2[0];
+    F4 det = e1[0] * px + e1[1] * py + e1[2] * pz;
+    F4 inv = f4_splat(1.0f) / det;
+
+    F4 sx = o[0] - v0[0], sy = o[1] - v0[1], sz = o[2] - v0[2];
+    u = (sx * px + sy * py + sz * pz) * inv;
+
+    F4 qx = sy * e1[2] - sz * e1[1];
+    F4 qy = sz * e1[0] - sx * e1[2];
+    F4 qz = sx * e1[1] - sy * e1[0];
+    v = (d[0] * qx + d[1] * qy + d[2] * qz) * inv;
+    t = (e2[0] * qx + e2[1] * qy + e2[2] * qz) * inv;
+
+    // Parallel rays give an infinite reciprocal and NaN barycentrics, which fail every comparison below
+    F4 zero = f4_splat(0.0f);
+    return (f4_abs(det) > f4_splat(1e-30f)) & (u >= zero) & (v >= zero) & (u + v <= f4_splat(1.0f)) & (t >= zero) &
+           (t < t_max);
+}
+
+static const u32 LANE_MASKS[5] = {0x0, 0x1, 0x3, 0x7, 0xf};
+
+// Single-ray traversal shared by the closest-hit and any-hit queries
+static bool trace(const MeshBvh &bvh, const Vec3 &origin, const Vec3 &direction, f32 max_distance, MeshHit *hit) {
+    if (bvh.nodes.empty()) return false;
+
+    const f32 o[3] = {origin.x, origin.y, origin.z};
+    const f32 inverse[3] = {1.0f / direction.x, 1.0f / direction.y, 1.0f / direction.z};
+    const F4 ray_o[3] = {f4_splat(origin.x), f4_splat(origin.y), f4_splat(origin.z)};
+    const F4 ray_d[3] = {f4_splat(direction.x), f4_splat(direction.y), f4_splat(direction.z)};
+
+    f32 closest = max_distance;
+    bool found = false;
+    if (bvh_ray_box(o, inverse, closest, bvh.nodes[0].min, bvh.nodes[0].max) == FLT_MAX) return false;
+
+    u32 stack[BVH_STACK_SIZE];
+    usize size = 0;
+    stack[size++] = 0;
+
+    while (size > 0) {
+        const MeshBvhNode &node = bvh.nodes[stack[--size]];
+
+        if (node.count > 0) {
+            for (u32 first = node.first; first < node.first + node.count; first += 4) {
+                TrianglePack pack;
+                load_pack(bvh, first, std::min(4u, node.first + node.count - first), pack);
+
+                F4 t, u, v;
+                u32 mask = f4_mask(intersect4(ray_o, ray_d, pack.v0, pack.e1, pack.e2, f4_splat(closest), t, u, v)) &
+                           LANE_MASKS[pack.count];
+                if (!mask) continue;
+                if (!hit) return true;
+
+                f32 ts[4], us[4], vs[4];
+                f4_store(ts, t), f4_store(us, u), f4_store(vs, v);
+                for (u32 lane = 0; lane < 4; lane++) {
+                    if (!(mask & (1u << lane)) || ts[lane] >= closest) continue;
+
+                    closest = ts[lane];
+                    found = true;
+                    hit->distance = ts[lane];
+                    hit->primitive = bvh.triangles[first + lane].primitive;
+                    hit->triangle = bvh.triangles[first + lane].triangle;
+                    hit->u = us[lane];
+                    hit->v = vs[lane];
+                }
+            }
+            continue;
+        }
+
+        // Children entered beyond the closest hit so far are culled; the nearer one is visited first
+        const MeshBvhNode &a = bvh.nodes[node.first];
+        const MeshBvhNode &b = bvh.nodes[node.first + 1];
+        f32 left = bvh_ray_box(o, inverse, closest, a.min, a.max);
+        f32 right = bvh_ray_box(o, inverse, closest, b.min, b.max);
+        u32 near_child = left <= right ? node.first : node.first + 1;
+        u32 far_child = left <= right ? node.first + 1 : node.first;
+
+        if (std::max(left, right) != FLT_MAX) stack[size++] = far_child;
+        if (std::min(left, right) != FLT_MAX) stack[size++] = near_child;
+    }
+
+    return found;
+}
+
+bool intersect_ray(const MeshBvh &bvh, const Vec3 &origin, const Vec3 &direction, f32 max_distance, MeshHit &hit) {
+    hit = MeshHit();
+    return trace(bvh, origin, direction, max_distance, &hit);
+}
+
+bool intersect_any(const MeshBvh &bvh, const Vec3 &origin, const Vec3 &direction, f32 max_distance) {
+    return trace(bvh, origin, direction, max_distance, nullptr);
+}
+
+// Four rays against one node box; returns the lanes that enter it before their current closest hit
+static inline F4 packet_box(const F4 *o, const F4 *inverse, F4 t_max, const MeshBvhNode &node, F4 &enter) {
+    F4 t0x = (f4_splat(node.min.x) - o[0]) * inverse[0], t1x = (f4_splat(node.max.x) - o[0]) * inverse[0];
+    F4 t0y = (f4_splat(node.min.y) - o[1]) * inverse[1], t1y = (f4_splat(node.max.y) - o[1]) * inverse[1];
+    F4 t0z = (f4_splat(node.min.z) - o[2]) * inverse[2], t1z = (f4_splat(node.max.z) - o[2]) * inverse[2];
+
+    enter = f4_max(f4_max(f4_min(t0x, t1x), f4_min(t0y, t1y)), f4_max(f4_min(t0z, t1z), f4_splat(0.0f)));
+    F4 exit = f4_min(f4_min(f4_max(t0x, t1x), f4_max(t0y, t1y)), f4_min(f4_max(t0z, t1z), t_max));
+    return enter <= exit;
+}
+
+static inline f32 index_bits(u32 index) {
+    f32 bits;
+    std::memcpy(&bits, &index, sizeof(bits));
+    return bits;
+}
+
+static void trace_packet(const MeshBvh &bvh, const Vec3 *origins, const Vec3 *directions, u32 count,
+                         f32 max_distance, MeshHit *hits) {
+    // Unused lanes repeat the last ray; their results are simply not written back
+    f32 o[3][4], d[3][4], inv[3][4];
+    for (u32 lane = 0; lane < 4; lane++) {
+        const Vec3 &origin = origins[std::min(lane, count - 1)];
+        const Vec3 &direction = directions[std::min(lane, count - 1)];
+        o[0][lane] = origin.x, o[1][lane] = origin.y, o[2][lane] = origin.z;
+        d[0][lane] = direction.x, d[1][lane] = direction.y, d[2][lane] = direction.z;
+        for (usize c = 0; c < 3; c++) inv[c][lane] = 1.0f / d[c][lane];
+    }
+
+    F4 ray_o[3], ray_d[3], ray_inv[3];
+    for (usize c = 0; c < 3; c++) {
+        ray_o[c] = f4_load(o[c]);
+        ray_d[c] = f4_load(d[c]);
+        ray_inv[c] = f4_load(inv[c]);
+    }
+
+    F4 closest = f4_splat(max_distance);
+    F4 best_u = f4_splat(0.0f), best_v = f4_splat(0.0f);
+    F4 best_index = f4_splat(index_bits(UINT32_MAX)); // Index into bvh.triangles, bit-cast to ride along the selects
+
+    u32 stack[BVH_STACK_SIZE];
+    usize size = 0;
+    stack[size++] = 0;
+
+    while (size > 0) {
+        const MeshBvhNode &node = bvh.nodes[stack[--size]];
+
+        F4 enter;
+        if (!f4_mask(packet_box(ray_o, ray_inv, closest, node, enter))) continue;
+
+        if (node.count > 0) {
+            for (u32 i = node.first; i < node.first + node.count; i++) {
+                f32 v[3][3];
+                const MeshBvhTriangle &triangle = bvh.triangles[i];
+                fetch_triangle(bvh.sources[triangle.primitive], triangle.triangle, v);
+
+                const F4 v0[3] = {f4_splat(v[0][0]), f4_splat(v[0][1]), f4_splat(v[0][2])};
+                const F4 e1[3] = {f4_splat(v[1][0] - v[0][0]), f4_splat(v[1][1] - v[0][1]),
+                                  f4_splat(v[1][2] - v[0][2])};
+                const F4 e2[3] = {f4_splat(v[2][0] - v[0][0]), f4_splat(v[2][1] - v[0][1]),
+                                  f4_splat(v[2][2] - v[0][2])};
+
+                F4 t, u, w;
+                F4 mask = intersect4(ray_o, ray_d, v0, e1, e2, closest, t, u, w);
+                if (!f4_mask(mask)) continue;
+
+                closest = f4_select(mask, t, closest);
+                best_u = f4_select(mask, u, best_u);
+                best_v = f4_select(mask, w, best_v);
+                best_index = f4_select(mask, f4_splat(index_bits(i)), best_index);
+            }
+            continue;
+        }
+
+        // Children are ordered by the earliest entry over all lanes
+        F4 enter_a, enter_b;
+        u32 mask_a = f4_mask(packet_box(ray_o, ray_inv, closest, bvh.nodes[node.first], enter_a));
+        u32 mask_b = f4_mask(packet_box(ray_o, ray_inv, closest, bvh.nodes[node.first + 1], enter_b));
+        f32 ea[4], eb[4];
+        f4_store(ea, enter_a), f4_store(eb, enter_b);
+
+        f32 first_a = FLT_MAX, first_b = FLT_MAX;
+        for (u32 lane = 0; lane < 4; lane++) {
+            if (mask_a & (1u << lane)) first_a = std::min(first_a, ea[lane]);
+            if (mask_b & (1u << lane)) first_b = std::min(first_b, eb[lane]);
+        }
+
+        u32 near_child = first_a <= first_b ? node.first : node.first + 1;
+        u32 far_child = first_a <= first_b ? node.first + 1 : node.first;
+        if (std::max(first_a, first_b) != FLT_MAX) stack[size++] = far_child;
+        if (std::min(first_a, first_b) != FLT_MAX) stack[size++] = near_child;
+    }
+
+    f32 ts[4], us[4], vs[4], index_lanes[4];
+    f4_store(ts, closest), f4_store(us, best_u), f4_store(vs, best_v), f4_store(index_lanes, best_index);
+    u32 indices[4];
+    std::memcpy(indices, index_lanes, sizeof(indices));
+
+    for (u32 lane = 0; lane < count; lane++) {
+        MeshHit &hit = hits[lane];
+        hit = MeshHit();
+        if (indices[lane] == UINT32_MAX) continue;
+
+        const MeshBvhTriangle &triangle = bvh.triangles[indices[lane]];
+        hit.distance = ts[lane];
+        hit.primitive = triangle.primitive;
+        hit.triangle = triangle.triangle;
+        hit.u = us[lane];
+        hit.v = vs[lane];
+    }
+}
+
+void intersect_rays(const MeshBvh &bvh, const Vec3 *origins, const Vec3 *directions, usize count, f32 max_distance,
+                    MeshHit *hits) {
+    if (bvh.nodes.empty()) {
+        for (usize i = 0; i < count; i++) hits[i] = MeshHit();
+        return;
+    }
+
+    for (usize i = 0; i < count; i += 4) {
+        trace_packet(bvh, origins + i, directions + i, (u32)std::min<usize>(4, count - i), max_distance, hits + i);
+    }
+}
+
+}; // namespace gltf
@@ -0,0 +1,279 @@
+#include "meshlet.hpp"
+#include "accessor.hpp"
+#include "parallel.hpp"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+namespace gltf {
+
+static void triangle_normal(const f32 *a, const f32 *b, const f32 *c, f32 *n) {
+    f32 e1[3] = {b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+    f32 e2[3] = {c[0] - a[0], c[1] - a[1], c[2] - a[2]};
+    n[0] = e1[1] * e2[2] - e1[2] * e2[1];
+    n[1] = e1[2] * e2[0] - e1[0] * e2[2];
+    n[2] = e1[0] * e2[1] - e1[1] * e2[0];
+
+    f32 length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+    if (length > 0.0f) {
+        n[0] /= length;
+        n[1] /= length;
+        n[2] /= length;
+    }
+}
+
+// Ritter's bounding sphere followed by the normal cone of the meshlet's triangles
+static MeshletBounds compute_bounds(const MeshletMesh &mesh, const Meshlet &meshlet, const f32 *positions) {
+    MeshletBounds bounds;
+    const u32 *vertices = mesh.vertices.data() + meshlet.vertex_offset;
+    const u8 *triangles = mesh.triangles.data() + meshlet.triangle_offset;
+
+    const f32 *first = positions + vertices[0] * 3;
+    const f32 *far_a = first;
+    f32 best = -1.0f;
+    for (u32 i = 0; i < meshlet.vertex_count; i++) {
+        const f32 *p = positions + vertices[i] * 3;
+        f32 d = (p[0] - first[0]) * (p[0] - first[0]) + (p[1] - first[1]) * (p[1] - first[1]) +
+                (p[2] - first[2]) * (p[2] - first[2]);
+        if (d > best) best = d, far_a = p;
+    }
+
+    const f32 *far_b = far_a;
+    best = -1.0f;
+    for (u32 i = 0; i < meshlet.vertex_count; i++) {
+        const f32 *p = positions + vertices[i] * 3;
+        f32 d = (p[0] - far_a[0]) * (p[0] - far_a[0]) + (p[1] - far_a[1]) * (p[1] - far_a[1]) +
+                (p[2] - far_a[2]) * (p[2] - far_a[2]);
+        if (d > best) best = d, far_b = p;
+    }
+
+    f32 center[3] = {(far_a[0] + far_b[0]) * 0.5f, (far_a[1] + far_b[1]) * 0.5f, (far_a[2] + far_b[2]) * 0.5f};
+    f32 radius = std::sqrt(best) * 0.5f;
+
+    for (u32 i = 0; i < meshlet.vertex_count; i++) {
+        const f32 *p = positions + vertices[i] * 3;
+        f32 d[3] = {p[0] - center[0], p[1] - center[1], p[2] - center[2]};
+        f32 distance = std::sqrt(d[0] * d[0] + d[1] * d[1] + d[2] * d[2]);
+        if (distance > radius) {
+            f32 shift = (distance - radius) * 0.5f / distance;
+            center[0] += d[0] * shift;
+            center[1] += d[1] * shift;
+            center[2] += d[2] * shift;
+            radius = (radius + distance) * 0.5f;
+        }
+    }
+
+    bounds.center = {center[0], center[1], center[2]};
+    bounds.radius = radius;
+
+    // Cone axis is the average triangle normal, its spread the widest angle to any triangle normal
+    std::vector<f32> normals(meshlet.triangle_count * 3);
+    f32 axis[3] = {0.0f, 0.0f, 0.0f};
+    for (u32 t = 0; t < meshlet.triangle_count; t++) {
+        const f32 *a = positions + vertices[triangles[t * 3 + 0]] * 3;
+        const f32 *b = positions + vertices[triangles[t * 3 + 1]] * 3;
+        const f32 *c = positions + vertices[triangles[t * 3 + 2]] * 3;
+        triangle_normal(a, b, c, &normals[t * 3]);
+
+        axis[0] += normals[t * 3 + 0];
+        axis[1] += normals[t * 3 + 1];
+        axis[2] += normals[t * 3 + 2];
+    }
+
+    f32 axis_length = std::sqrt(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+    bounds.cone_apex = bounds.center;
+    bounds.cone_axis = {0.0f, 0.0f, 0.0f};
+    if (axis_length <= 0.0f) return bounds;
+
+    axis[0] /= axis_length;
+    axis[1] /= axis_length;
+    axis[2] /= axis_length;
+
+    f32 min_dot = 1.0f;
+    for (u32 t = 0; t < meshlet.triangle_count; t++) {
+        const f32 *n = &normals[t * 3];
+        min_dot = std::min(min_dot, n[0] * axis[0] + n[1] * axis[1] + n[2] * axis[2]);
+    }
+
+    bounds.cone_axis = {axis[0], axis[1], axis[2]};
+
+    // Beyond ~84 degrees of spread the cone can never cull anything
+    if (min_dot <= 0.1f) return bounds;
+
+    // The apex is moved back along the axis until it lies behind every triangle plane
+    f32 max_t = 0.0f;
+    for (u32 t = 0; t < meshlet.triangle_count; t++) {
+        const f32 *n = &normals[t * 3];
+        const f32 *p = positions + vertices[triangles[t * 3]] * 3;
+        f32 dc = (center[0] - p[0]) * n[0] + (center[1] - p[1]) * n[1] + (center[2] - p[2]) * n[2];
+        f32 dn = axis[0] * n[0] + axis[1] * n[1] + axis[2] * n[2];
+        max_t = std::max(max_t, dc / dn);
+    }
+
+    bounds.cone_apex = {center[0] - axis[0] * max_t, center[1] - axis[1] * max_t, center[2] - axis[2] * max_t};
+    bounds.cone_cutoff = std::sqrt(1.0f - min_dot * min_dot);
+    return bounds;
+}
+
+void build_meshlets(MeshletMesh &out, const u32 *indices, usize index_count, const f32 *positions,
+                    usize vertex_count, usize max_vertices, usize max_triangles) {
+    out = MeshletMesh();
+    max_vertices = std::min<usize>(std::max<usize>(max_vertices, 3), 255);
+    max_triangles = std::max<usize>(max_triangles, 1);
+
+    usize triangle_count = index_count / 3;
+    for (usize i = 0; i < triangle_count * 3; i++) {
+        if (indices[i] >= vertex_count) return;
+    }
+
+    // Vertex -> triangle adjacency in CSR form
+    std::vector<u32> offsets(vertex_count + 1, 0);
+    for (usize i = 0; i < triangle_count * 3; i++) offsets[indices[i] + 1]++;
+    for (usize v = 0; v < vertex_count; v++) offsets[v + 1] += offsets[v];
+
+    std::vector<u32> adjacency(triangle_count * 3);
+    std::vector<u32> fill(offsets.begin(), offsets.end() - 1);
+    for (usize t = 0; t < triangle_count; t++) {
+        for (usize k = 0; k < 3; k++) adjacency[fill[indices[t * 3 + k]]++] = (u32)t;
+    }
+
+    std::vector<f32> centroids(triangle_count * 3);
+    for (usize t = 0; t < triangle_count; t++) {
+        for (usize k = 0; k < 3; k++) {
+            centroids[t * 3 + k] = (positions[indices[t * 3 + 0] * 3 + k] + positions[indices[t * 3 + 1] * 3 + k] +
+                                    positions[indices[t * 3 + 2] * 3 + k]) /
+                                   3.0f;
+        }
+    }
+
+    std::vector<bool> emitted(triangle_count, false);
+    std::vector<u8> slot(vertex_count, 0xff);
+    usize cursor = 0;
+
+    Meshlet meshlet;
+    f32 center[3] = {0.0f, 0.0f, 0.0f};
+
+    auto finish = [&]() {
+        if (meshlet.triangle_count == 0) return;
+
+        for (u32 i = 0; i < meshlet.vertex_count; i++) slot[out.vertices[meshlet.vertex_offset + i]] = 0xff;
+        out.meshlets.push_back(meshlet);
+
+        meshlet.vertex_offset = (u32)out.vertices.size();
+        meshlet.triangle_offset = (u32)out.triangles.size();
+        meshlet.vertex_count = 0;
+        meshlet.triangle_count = 0;
+    };
+
+    for (usize emitted_count = 0; emitted_count < triangle_count; emitted_count++) {
+        // Best adjacent triangle: fewest new vertices first, then closest to the running meshlet center
+        i64 best = -1;
+        u32 best_new = 4;
+        f32 best_distance = 0.0f;
+
+        for (u32 i = 0; i < meshlet.vertex_count; i++) {
+            u32 v = out.vertices[meshlet.vertex_offset + i];
+            for (u32 a = offsets[v]; a < offsets[v + 1]; a++) {
+                u32 t = adjacency[a];
+                if (emitted[t]) continue;
+
+                u32 added = 0;
+                for (usize k = 0; k < 3; k++) added += slot[indices[t * 3 + k]] == 0xff;
+                if (meshlet.vertex_count + added > max_vertices) continue;
+
+                f32 d[3] = {centroids[t * 3] - center[0], centroids[t * 3 + 1] - center[1],
+                            centroids[t * 3 + 2] - center[2]};
+                f32 distance = d[0] * d[0] + d[1] * d[1] + d[2] * d[2];
+                if (added < best_new || (added == best_new && distance < best_distance)) {
+                    best = t;
+                    best_new = added;
+                    best_distance = distance;
+                }
+            }
+        }
+
+        // No adjacent triangle fits: start a new meshlet from the next unused triangle in index order
+        if (best == -1) {
+            finish();
+            while (emitted[cursor]) cursor++;
+            best = (i64)cursor;
+        }
+
+        const u32 *tri = indices + best * 3;
+        u32 added = 0;
+        for (usize k = 0; k < 3; k++) added += slot[tri[k]] == 0xff;
+        if (meshlet.vertex_count + added > max_vertices || meshlet.triangle_count + 1 > max_triangles) finish();
+
+        for (usize k = 0; k < 3; k++) {
+            if (slot[tri[k]] == 0xff) {
+                slot[tri[k]] = (u8)meshlet.vertex_count++;
+                out.vertices.push_back(tri[k]);
+            }
+            out.triangles.push_back(slot[tri[k]]);
+        }
+
+        // Running average of triangle centroids
+        meshlet.triangle_count++;
+        for (usize k = 0; k < 3; k++) {
+            center[k] += (centroids[best * 3 + k] - center[k]) / (f32)meshlet.triangle_count;
+        }
+
+        emitted[best] = true;
+    }
+
+    finish();
+
+    out.bounds.resize(out.meshlets.size());
+    for (usize m = 0; m < out.meshlets.size(); m++) {
+        out.bounds[m] = compute_bounds(out, out.meshlets[m], positions);
+    }
+}
+
+bool build_meshlets(const Model &model, const Primitive &primitive, MeshletMesh &out, usize max_vertices,
+                    usize max_triangles) {
+    out = MeshletMesh();
+    if (primitive.mode != 4) {
+        std::cerr << "Cannot build meshlets: only TRIANGLES primitives are supported" << std::endl;
+        return false;
+    }
+
+    auto position = primitive.attributes.find("POSITION");
+    std::vector<f32> positions;
+    if (position == primitive.attributes.end() || position->second >= model.accessors.size() ||
+        model.accessors[position->second].type != "VEC3" || !read_floats(model, position->second, positions)) {
+        std::cerr << "Cannot build meshlets: primitive has no readable VEC3 POSITION attribute" << std::endl;
+        return false;
+    }
+
+    std::vector<u32> indices;
+    if (!read_indices(model, primitive.indices, positions.size() / 3, indices)) {
+        std::cerr << "Cannot build meshlets: index accessor has no readable data" << std::endl;
+        return false;
+    }
+
+    build_meshlets(out, indices.data(), indices.size(), positions.data(), positions.size() / 3, max_vertices,
+                   max_triangles);
+    return true;
+}
+
+bool build_meshlets(const Model &model, std::vector<std::vector<MeshletMesh>> &out, usize max_vertices,
+                    usize max_triangles) {
+    std::vector<std::pair<u32, u32>> jobs;
+    out.assign(model.meshes.size(), std::vector<MeshletMesh>());
+    for (usize m = 0; m < model.meshes.size(); m++) {
+        out[m].resize(model.meshes[m].primitives.size());
+        for (usize p = 0; p < model.meshes[m].primitives.size(); p++) {
+            if (model.meshes[m].primitives[p].mode == 4) jobs.push_back(std::make_pair((u32)m, (u32)p));
+        }
+    }
+
+    std::vector<char> results(jobs.size(), 0);
+    parallel_for(jobs.size(), [&](usize i) {
+        const Primitive &primitive = model.meshes[jobs[i].first].primitives[jobs[i].second];
+        results[i] = build_meshlets(model, primitive, out[jobs[i].first][jobs[i].second], max_vertices, max_triangles);
+    });
+
+    return std::find(results.begin(), results.end(), 0) == results.end();
+}
+
+}; // namespace gltf
@@ -0,0 +1,146 @@
+#include "node_transforms.hpp"
+#include "math.hpp"
+#include "transform.hpp"
+#include <algorithm>
+
+namespace gltf {
+
+static void copy_node(const Node &node, NodeTransforms &transforms, u32 n) {
+    transforms.translations[n] = node.translation;
+    transforms.rotations[n] = node.rotation;
+    transforms.scales[n] = node.scale;
+    transforms.matrix_nodes[n] = node.has_matrix ? 1 : 0;
+    transforms.locals[n] = local_transform(node);
+}
+
+// Node weights override the mesh's; targets without a default weight start at zero
+static usize initial_weights(const Model &model, const Node &node, const std::vector<f32> *&values) {
+    values = &node.weights;
+    if (!node.weights.empty() || node.mesh >= model.meshes.size()) return node.weights.size();
+
+    const Mesh &mesh = model.meshes[node.mesh];
+    values = &mesh.weights;
+    usize count = mesh.weights.size();
+    for (const Primitive &primitive : mesh.primitives) count = std::max(count, primitive.targets.size());
+    return count;
+}
+
+void build_node_transforms(const Model &model, NodeTransforms &transforms) {
+    usize node_count = model.nodes.size();
+    transforms.translations.resize(node_count);
+    transforms.rotations.resize(node_count);
+    transforms.scales.resize(node_count);
+    transforms.matrix_nodes.resize(node_count);
+    transforms.locals.resize(node_count);
+    transforms.worlds.assign(node_count, Mat4::identify());
+    transforms.dirty.assign(node_count, 0);
+    transforms.edited.clear();
+
+    build_node_hierarchy(model, transforms.parents, transforms.order);
+    for (u32 n = 0; n < node_count; n++) copy_node(model.nodes[n], transforms, n);
+
+    transforms.weights.clear();
+    transforms.weight_offsets.assign(1, 0);
+    for (u32 n = 0; n < node_count; n++) {
+        const std::vector<f32> *values;
+        usize count = initial_weights(model, model.nodes[n], values);
+
+        usize begin = transforms.weights.size();
+        transforms.weights.resize(begin + count, 0.0f);
+        usize available = std::min(count, values->size());
+        std::copy(values->begin(), values->begin() + available, transforms.weights.begin() + begin);
+        transforms.weight_offsets.push_back((u32)transforms.weights.size());
+    }
+}
+
+void pull_node_transforms(const Model &model, NodeTransforms &transforms, const u32 *nodes, usize count) {
+    for (usize i = 0; i < count; i++) {
+        u32 n = nodes[i];
+        if (n >= model.nodes.size() || n >= transforms.locals.size()) continue;
+
+        const Node &node = model.nodes[n];
+        copy_node(node, transforms, n);
+        u32 begin = transforms.weight_offsets[n];
+        if (node.weights.size() == transforms.weight_offsets[n + 1] - begin) {
+            std::copy(node.weights.begin(), node.weights.end(), transforms.weights.begin() + begin);
+        }
+    }
+}
+
+static bool editable_node(NodeTransforms &transforms, u32 node) {
+    if (node >= transforms.locals.size()) return false;
+
+    if (transforms.matrix_nodes[node]) {
+        decompose_trs(transforms.locals[node], transforms.translations[node], transforms.rotations[node],
+                      transforms.scales[node]);
+        transforms.matrix_nodes[node] = 0;
+    }
+    mark_node_dirty(transforms, node);
+    return true;
+}
+
+void set_node_translation(NodeTransforms &transforms, u32 node, const Vec3 &translation) {
+    if (editable_node(transforms, node)) transforms.translations[node] = translation;
+}
+
+void set_node_rotation(NodeTransforms &transforms, u32 node, const Vec4 &rotation) {
+    if (editable_node(transforms, node)) transforms.rotations[node] = rotation;
+}
+
+void set_node_scale(NodeTransforms &transforms, u32 node, const Vec3 &scale) {
+    if (editable_node(transforms, node)) transforms.scales[node] = scale;
+}
+
+void set_node_matrix(NodeTransforms &transforms, u32 node, const Mat4 &matrix) {
+    if (node >= transforms.locals.size()) return;
+
+    transforms.locals[node] = matrix;
+    transforms.matrix_nodes[node] = 1;
+    mark_node_dirty(transforms, node);
+}
+
+void mark_node_dirty(NodeTransforms &transforms, u32 node) {
+    if (node >= transforms.dirty.size() || transforms.dirty[node]) return;
+
+    transforms.dirty[node] = 1;
+    transforms.edited.push_back(node);
+}
+
+void push_node_transforms(NodeTransforms &transforms, Model &model) {
+    for (u32 n : transforms.edited) {
+        transforms.dirty[n] = 0;
+        if (n >= model.nodes.size()) continue;
+
+        Node &node = model.nodes[n];
+        node.has_matrix = transforms.matrix_nodes[n] != 0;
+        if (node.has_matrix) {
+            node.matrix = transforms.locals[n];
+        } else {
+            node.translation = transforms.translations[n];
+            node.rotation = transforms.rotations[n];
+            node.scale = transforms.scales[n];
+        }
+
+        const f32 *weights = transforms.weights.data();
+        if (transforms.weight_offsets[n + 1] > transforms.weight_offsets[n]) {
+            node.weights.assign(weights + transforms.weight_offsets[n], weights + transforms.weight_offsets[n + 1]);
+        }
+        mark_transform_dirty(model, n);
+    }
+    transforms.edited.clear();
+}
+
+void update_node_matrices(NodeTransforms &transforms) {
+    const Vec3 *translations = transforms.translations.data(), *scales = transforms.scales.data();
+    const Vec4 *rotations = transforms.rotations.data();
+    Mat4 *locals = transforms.locals.data(), *worlds = transforms.worlds.data();
+
+    for (u32 n : transforms.order) {
+        if (!transforms.matrix_nodes[n]) locals[n] = compose_trs(translations[n], rotations[n], scales[n]);
+
+        u32 parent = transforms.parents[n];
+        worlds[n] = parent == UINT32_MAX ? locals[n] : mat4_multiply(worlds[parent], locals[n]);
+    }
+}
+
+}; // namespace gltf
@@ -0,0 +1,334 @@
+#include "normals.hpp"
+#include "accessor.hpp"
+#include "parallel.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+namespace gltf {
+
+// Vertices and triangles are processed in blocks of this many items per worker task
+static const usize BLOCK_SIZE = 4096;
+
+static void cross(const f32 *a, const f32 *b, f32 *out) {
+    out[0] = a[1] * b[2] - a[2] * b[1];
+    out[1] = a[2] * b[0] - a[0] * b[2];
+    out[2] = a[0] * b[1] - a[1] * b[0];
+}
+
+static f32 dot(const f32 *a, const f32 *b) {
+    return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+static bool normalize(f32 *v) {
+    f32 length = std::sqrt(dot(v, v));
+    if (length <= 1e-20f) return false;
+
+    v[0] /= length;
+    v[1] /= length;
+    v[2] /= length;
+    return true;
+}
+
+template <typename F> static void blocks(usize count, F fn) {
+    parallel_for((count + BLOCK_SIZE - 1) / BLOCK_SIZE,
+                 [&](usize b) { fn(b * BLOCK_SIZE, std::min(count, (b + 1) * BLOCK_SIZE)); });
+}
+
+// Vertex -> triangle adjacency in CSR form, keyed by `keys[index]` (vertex or position id)
+static void build_adjacency(const std::vector<u32> &indices, const std::vector<u32> &keys, usize key_count,
+                            std::vector<u32> &offsets, std::vector<u32> &corners) {
+    offsets.assign(key_count + 1, 0);
+    for (u32 index : indices) offsets[keys[index] + 1]++;
+    for (usize k = 0; k < key_count; k++) offsets[k + 1] += offsets[k];
+
+    corners.resize(indices.size());
+    std::vector<u32> fill(offsets.begin(), offsets.end() - 1);
+    for (usize i = 0; i < indices.size(); i++) corners[fill[keys[indices[i]]]++] = (u32)i;
+}
+
+static bool read_positions(const Model &model, const Primitive &primitive, std::vector<f32> &positions) {
+    auto position = primitive.attributes.find("POSITION");
+    if (position == primitive.attributes.end() || position->second >= model.accessors.size() ||
+        model.accessors[position->second].type != "VEC3" || !read_floats(model, position->second, positions)) {
+        std::cerr << "Cannot generate vertex data: primitive has no readable VEC3 POSITION attribute" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+static bool read_triangles(const Model &model, const Primitive &primitive, usize vertex_count,
+                           std::vector<u32> &indices) {
+    if (primitive.mode != 4) {
+        std::cerr << "Cannot generate vertex data: only TRIANGLES primitives are supported" << std::endl;
+        return false;
+    }
+
+    if (!read_indices(model, primitive.indices, vertex_count, indices)) {
+        std::cerr << "Cannot generate vertex data: index accessor has no readable data" << std::endl;
+        return false;
+    }
+
+    indices.resize(indices.size() - indices.size() % 3);
+    for (u32 index : indices) {
+        if (index >= vertex_count) {
+            std::cerr << "Cannot generate vertex data: index " << index << " is out of range" << std::endl;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Maps every vertex to the first vertex sharing its exact position
+static usize position_ids(const std::vector<f32> &positions, std::vector<u32> &ids) {
+    usize vertex_count = positions.size() / 3;
+    usize capacity = 1;
+    while (capacity < vertex_count * 2) capacity <<= 1;
+
+    std::vector<u32> table(capacity, UINT32_MAX);
+    std::vector<f32> canonical;
+    ids.resize(vertex_count);
+
+    for (usize v = 0; v < vertex_count; v++) {
+        // Adding zero folds -0.0 onto 0.0 so both hash and compare equal
+        f32 p[3] = {positions[v * 3] + 0.0f, positions[v * 3 + 1] + 0.0f, positions[v * 3 + 2] + 0.0f};
+        u32 bits[3];
+        std::memcpy(bits, p, sizeof(bits));
+
+        usize slot = ((bits[0] * 73856093u) ^ (bits[1] * 19349663u) ^ (bits[2] * 83492791u)) & (capacity - 1);
+        while (table[slot] != UINT32_MAX && std::memcmp(&canonical[table[slot] * 3], p, sizeof(p)) != 0) {
+            slot = (slot + 1) & (capacity - 1);
+        }
+
+        if (table[slot] == UINT32_MAX) {
+            table[slot] = (u32)(canonical.size() / 3);
+            canonical.insert(canonical.end(), p, p + 3);
+        }
+        ids[v] = table[slot];
+    }
+
+    return canonical.size() / 3;
+}
+
+static bool generate_flat_normals(Model &model, Primitive &primitive) {
+    std::vector<f32> positions;
+    if (!read_positions(model, primitive, positions)) return false;
+
+    std::vector<u32> indices;
+    if (!read_triangles(model, primitive, positions.size() / 3, indices)) return false;
+
+    // Every corner becomes its own vertex
+    if (!gather_vertices(model, primitive, indices)) return false;
+    primitive.indices = UINT32_MAX;
+
+    std::vector<f32> normals(indices.size() * 3);
+    usize triangle_count = indices.size() / 3;
+    blocks(triangle_count, [&](usize begin, usize end) {
+        for (usize t = begin; t < end; t++) {
+            const f32 *p0 = &positions[indices[t * 3 + 0] * 3];
+            const f32 *p1 = &positions[indices[t * 3 + 1] * 3];
+            const f32 *p2 = &positions[indices[t * 3 + 2] * 3];
+            f32 e1[3] = {p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2]};
+            f32 e2[3] = {p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2]};
+
+            f32 n[3];
+            cross(e1, e2, n);
+            if (!normalize(n)) n[0] = 0.0f, n[1] = 0.0f, n[2] = 1.0f;
+
+            for (usize k = 0; k < 3; k++) std::memcpy(&normals[(t * 3 + k) * 3], n, sizeof(n));
+        }
+    });
+
+    primitive.attributes["NORMAL"] = add_float_accessor(model, normals, "VEC3", TARGET_ARRAY_BUFFER);
+    return true;
+}
+
+static bool generate_smooth_normals(Model &model, Primitive &primitive) {
+    std::vector<f32> positions;
+    if (!read_positions(model, primitive, positions)) return false;
+
+    usize vertex_count = positions.size() / 3;
+    std::vector<u32> indices;
+    if (!read_triangles(model, primitive, vertex_count, indices)) return false;
+
+    std::vector<u32> ids;
+    usize id_count = position_ids(positions, ids);
+
+    // Area-weighted face normals are written once per triangle, then gathered per position without atomics
+    usize triangle_count = indices.size() / 3;
+    std::vector<f32> faces(triangle_count * 3);
+    blocks(triangle_count, [&](usize begin, usize end) {
+        for (usize t = begin; t < end; t++) {
+            const f32 *p0 = &positions[indices[t * 3 + 0] * 3];
+            const f32 *p1 = &positions[indices[t * 3 + 1] * 3];
+            const f32 *p2 = &positions[indices[t * 3 + 2] * 3];
+            f32 e1[3] = {p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2]};
+            f32 e2[3] = {p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2]};
+            cross(e1, e2, &faces[t * 3]);
+        }
+    });
+
+    std::vector<u32> offsets, corners;
+    build_adjacency(indices, ids, id_count, offsets, corners);
+
+    std::vector<f32> id_normals(id_count * 3);
+    blocks(id_count, [&](usize begin, usize end) {
+        for (usize id = begin; id < end; id++) {
+            f32 n[3] = {0.0f, 0.0f, 0.0f};
+            for (u32 c = offsets[id]; c < offsets[id + 1]; c++) {
+                const f32 *face = &faces[corners[c] / 3 * 3];
+                n[0] += face[0];
+                n[1] += face[1];
+                n[2] += face[2];
+            }
+            if (!normalize(n)) n[0] = 0.0f, n[1] = 0.0f, n[2] = 1.0f;
+
+            std::memcpy(&id_normals[id * 3], n, sizeof(n));
+        }
+    });
+
+    std::vector<f32> normals(vertex_count * 3);
+    blocks(vertex_count, [&](usize begin, usize end) {
+        for (usize v = begin; v < end; v++) std::memcpy(&normals[v * 3], &id_normals[ids[v] * 3], 3 * sizeof(f32));
+    });
+
+    primitive.attributes["NORMAL"] = add_float_accessor(model, normals, "VEC3", TARGET_ARRAY_BUFFER);
+    return true;
+}
+
+bool generate_normals(Model &model, Primitive &primitive, bool flat, bool overwrite) {
+    if (!overwrite && primitive.attributes.count("NORMAL")) return true;
+
+    return flat ? generate_flat_normals(model, primitive) : generate_smooth_normals(model, primitive);
+}
+
+bool generate_tangents(Model &model, Primitive &primitive, bool overwrite) {
+    if (!overwrite && primitive.attributes.count("TANGENT")) return true;
+    if (!generate_normals(model, primitive)) return false;
+
+    std::vector<f32> positions;
+    if (!read_positions(model, primitive, positions)) return false;
+
+    usize vertex_count = positions.size() / 3;
+    std::vector<u32> indices;
+    if (!read_triangles(model, primitive, vertex_count, indices)) return false;
+
+    std::vector<f32> normals, uvs;
+    auto uv = primitive.attributes.find("TEXCOORD_0");
+    if (uv == primitive.attributes.end() || uv->second >= model.accessors.size() ||
+        model.accessors[uv->second].type != "VEC2" || !read_floats(model, uv->second, uvs) ||
+        uvs.size() != vertex_count * 2) {
+        std::cerr << "Cannot generate tangents: primitive has no readable VEC2 TEXCOORD_0 attribute" << std::endl;
+        return false;
+    }
+    if (!read_floats(model, primitive.attributes["NORMAL"], normals) || normals.size() != vertex_count * 3) {
+        std::cerr << "Cannot generate tangents: primitive has no readable NORMAL attribute" << std::endl;
+        return false;
+    }
+
+    // Per corner: angle-weighted tangent and bitangent, orthogonalized against the corner's vertex normal
+    std::vector<f32> corner_data(indices.size() * 6, 0.0f);
+    usize triangle_count = indices.size() / 3;
+    blocks(triangle_count, [&](usize begin, usize end) {
+        for (usize t = begin; t < end; t++) {
+            const u32 *tri = &indices[t * 3];
+            const f32 *p0 = &positions[tri[0] * 3];
+            const f32 *p1 = &positions[tri[1] * 3];
+            const f32 *p2 = &positions[tri[2] * 3];
+            f32 e1[3] = {p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2]};
+            f32 e2[3] = {p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2]};
+
+            // glTF texture space has v pointing down while tangent space +Y points up, hence the negated v deltas
+            f32 du1 = uvs[tri[1] * 2] - uvs[tri[0] * 2];
+            f32 dv1 = -(uvs[tri[1] * 2 + 1] - uvs[tri[0] * 2 + 1]);
+            f32 du2 = uvs[tri[2] * 2] - uvs[tri[0] * 2];
+            f32 dv2 = -(uvs[tri[2] * 2 + 1] - uvs[tri[0] * 2 + 1]);
+
+            f32 r = du1 * dv2 - du2 * dv1;
+            if (std::fabs(r) <= 1e-20f) continue;
+
+            f32 sdir[3], tdir[3];
+            for (usize k = 0; k < 3; k++) {
+                sdir[k] = (e1[k] * dv2 - e2[k] * dv1) / r;
+                tdir[k] = (e2[k] * du1 - e1[k] * du2) / r;
+            }
+
+            for (usize k = 0; k < 3; k++) {
+                const f32 *p = &positions[tri[k] * 3];
+                const f32 *a = &positions[tri[(k + 1) % 3] * 3];
+                const f32 *b = &positions[tri[(k + 2) % 3] * 3];
+                f32 ea[3] = {a[0] - p[0], a[1] - p[1], a[2] - p[2]};
+                f32 eb[3] = {b[0] - p[0], b[1] - p[1], b[2] - p[2]};
+                if (!normalize(ea) || !normalize(eb)) continue;
+
+                f32 angle = std::acos(std::max(-1.0f, std::min(1.0f, dot(ea, eb))));
+                const f32 *n = &normals[tri[k] * 3];
+
+                f32 tangent[3], bitangent[3];
+                f32 nt = dot(n, sdir);
+                f32 nb = dot(n, tdir);
+                for (usize c = 0; c < 3; c++) {
+                    tangent[c] = sdir[c] - n[c] * nt;
+                    bitangent[c] = tdir[c] - n[c] * nb;
+                }
+                if (!normalize(tangent)) continue;
+                normalize(bitangent);
+
+                f32 *out = &corner_data[(t * 3 + k) * 6];
+                for (usize c = 0; c < 3; c++) {
+                    out[c] = tangent[c] * angle;
+                    out[3 + c] = bitangent[c] * angle;
+                }
+            }
+        }
+    });
+
+    std::vector<u32> identity(vertex_count);
+    for (usize v = 0; v < vertex_count; v++) identity[v] = (u32)v;
+
+    std::vector<u32> offsets, corners;
+    build_adjacency(indices, identity, vertex_count, offsets, corners);
+
+    std::vector<f32> tangents(vertex_count * 4);
+    blocks(vertex_count, [&](usize begin, usize end) {
+        for (usize v = begin; v < end; v++) {
+            f32 t[3] = {0.0f, 0.0f, 0.0f};
+            f32 b[3] = {0.0f, 0.0f, 0.0f};
+            for (u32 c = offsets[v]; c < offsets[v + 1]; c++) {
+                const f32 *data = &corner_data[corners[c] * 6];
+                for (usize k = 0; k < 3; k++) {
+                    t[k] += data[k];
+                    b[k] += data[3 + k];
+                }
+            }
+
+            const f32 *n = &normals[v * 3];
+            f32 nt = dot(n, t);
+            for (usize k = 0; k < 3; k++) t[k] -= n[k] * nt;
+
+            // Any vector orthogonal to the normal will do when the UV mapping is degenerate
+            if (!normalize(t)) {
+                f32 axis[3] = {std::fabs(n[0]) < 0.9f ? 1.0f : 0.0f, std::fabs(n[0]) < 0.9f ? 0.0f : 1.0f, 0.0f};
+                cross(axis, n, t);
+                if (!normalize(t)) t[0] = 1.0f, t[1] = 0.0f, t[2] = 0.0f;
+            }
+
+            f32 nxt[3];
+            cross(n, t, nxt);
+
+            f32 *out = &tangents[v * 4];
+            out[0] = t[0];
+            out[1] = t[1];
+            out[2] = t[2];
+            out[3] = dot(nxt, b) < 0.0f ? -1.0f : 1.0f;
+        }
+    });
+
+    primitive.attributes["TANGENT"] = add_float_accessor(model, tangents, "VEC4", TARGET_ARRAY_BUFFER);
+    return true;
+}
+
+}; // namespace gltf
@@ -0,0 +1,224 @@
+#include "overdraw.hpp"
+#include "accessor.hpp"
+#include "parallel.hpp"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+namespace gltf {
+
+struct OverdrawCache {
+    std::vector<usize> loaded_at;
+    usize time;
+    usize size;
+
+    OverdrawCache(usize vertex_count, usize cache_size) : loaded_at(vertex_count, 0), time(0), size(cache_size) {
+        reset();
+    }
+
+    void reset() {
+        time += size + 1;
+    }
+
+    u32 triangle_misses(const u32 *triangle) {
+        u32 misses = 0;
+        for (usize k = 0; k < 3; k++) {
+            if (time - loaded_at[triangle[k]] > size) {
+                loaded_at[triangle[k]] = time++;
+                misses++;
+            }
+        }
+        return misses;
+    }
+};
+
+// Hard boundaries are the triangles where the cache-optimized order restarted from scratch (three misses)
+static void hard_boundaries(std::vector<u32> &out, const u32 *indices, usize triangle_count, OverdrawCache &cache) {
+    out.clear();
+    for (usize t = 0; t < triangle_count; t++) {
+        if (cache.triangle_misses(indices + t * 3) == 3 || t == 0) out.push_back((u32)t);
+    }
+}
+
+// Soft boundaries split hard clusters further wherever the running ACMR stays within the allowed regression
+static void soft_boundaries(std::vector<u32> &out, const std::vector<u32> &hard, const u32 *indices,
+                            usize triangle_count, OverdrawCache &cache, f32 threshold) {
+    out.clear();
+    for (usize c = 0; c < hard.size(); c++) {
+        usize start = hard[c];
+        usize end = c + 1 < hard.size() ? hard[c + 1] : triangle_count;
+
+        cache.reset();
+        usize cluster_misses = 0;
+        for (usize t = start; t < end; t++) cluster_misses += cache.triangle_misses(indices + t * 3);
+
+        f32 cluster_threshold = threshold * (f32)cluster_misses / (f32)(end - start);
+
+        out.push_back((u32)start);
+        cache.reset();
+
+        usize running_misses = 0;
+        usize running_triangles = 0;
+        for (usize t = start; t < end; t++) {
+            running_misses += cache.triangle_misses(indices + t * 3);
+            running_triangles++;
+
+            if (t + 1 < end && (f32)running_misses / running_triangles <= cluster_threshold) {
+                out.push_back((u32)(t + 1));
+                cache.reset();
+                running_misses = 0;
+                running_triangles = 0;
+            }
+        }
+    }
+}
+
+void optimize_overdraw(u32 *indices, usize index_count, const f32 *positions, usize vertex_count, usize cache_size,
+                       f32 threshold) {
+    usize triangle_count = index_count / 3;
+    if (triangle_count == 0) return;
+
+    for (usize i = 0; i < triangle_count * 3; i++) {
+        if (indices[i] >= vertex_count) return;
+    }
+
+    OverdrawCache cache(vertex_count, cache_size);
+    std::vector<u32> hard;
+    std::vector<u32> clusters;
+    hard_boundaries(hard, indices, triangle_count, cache);
+    if (threshold > 1.0f) {
+        soft_boundaries(clusters, hard, indices, triangle_count, cache, threshold);
+    } else {
+        clusters = hard;
+    }
+
+    // Area-weighted centroid and normal per cluster, plus the mesh centroid
+    usize cluster_count = clusters.size();
+    std::vector<f32> centroids(cluster_count * 3, 0.0f);
+    std::vector<f32> normals(cluster_count * 3, 0.0f);
+    std::vector<f32> areas(cluster_count, 0.0f);
+    f32 mesh_centroid[3] = {0.0f, 0.0f, 0.0f};
+    f32 mesh_area = 0.0f;
+
+    for (usize c = 0; c < cluster_count; c++) {
+        usize start = clusters[c];
+        usize end = c + 1 < cluster_count ? clusters[c + 1] : triangle_count;
+
+        for (usize t = start; t < end; t++) {
+            const f32 *a = positions + indices[t * 3 + 0] * 3;
+            const f32 *b = positions + indices[t * 3 + 1] * 3;
+            const f32 *d = positions + indices[t * 3 + 2] * 3;
+
+            f32 e1[3] = {b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+            f32 e2[3] = {d[0] - a[0], d[1] - a[1], d[2] - a[2]};
+            f32 n[3] = {e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0]};
+            f32 area = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+
+            for (usize k = 0; k < 3; k++) {
+                f32 center = (a[k] + b[k] + d[k]) / 3.0f;
+                centroids[c * 3 + k] += center * area;
+                normals[c * 3 + k] += n[k];
+                mesh_centroid[k] += center * area;
+            }
+            areas[c] += area;
+            mesh_area += area;
+        }
+    }
+
+    if (mesh_area > 0.0f) {
+        for (usize k = 0; k < 3; k++) mesh_centroid[k] /= mesh_area;
+    }
+
+    // Clusters facing away from the mesh center are likely in front, so they are drawn first
+    std::vector<f32> sort_keys(cluster_count, 0.0f);
+    for (usize c = 0; c < cluster_count; c++) {
+        if (areas[c] <= 0.0f) continue;
+
+        f32 length = 0.0f;
+        for (usize k = 0; k < 3; k++) length += normals[c * 3 + k] * normals[c * 3 + k];
+        length = std::sqrt(length);
+        if (length <= 0.0f) continue;
+
+        for (usize k = 0; k < 3; k++) {
+            f32 offset = centroids[c * 3 + k] / areas[c] - mesh_centroid[k];
+            sort_keys[c] += offset * normals[c * 3 + k] / length;
+        }
+    }
+
+    std::vector<u32> order(cluster_count);
+    for (usize c = 0; c < cluster_count; c++) order[c] = (u32)c;
+    std::stable_sort(order.begin(), order.end(), [&](u32 a, u32 b) { return sort_keys[a] > sort_keys[b]; });
+
+    std::vector<u32> output;
+    output.reserve(triangle_count * 3);
+    for (u32 c : order) {
+        usize start = clusters[c];
+        usize end = c + 1 < cluster_count ? clusters[c + 1] : triangle_count;
+        output.insert(output.end(), indices + start * 3, indices + end * 3);
+    }
+
+    std::copy(output.begin(), output.end(), indices);
+}
+
+static bool is_blended(const Model &model, const Primitive &primitive) {
+    return primitive.material < model.materials.size() && model.materials[primitive.material].alpha_mode == "BLEND";
+}
+
+bool optimize_overdraw(Model &model, Primitive &primitive, f32 threshold, usize cache_size) {
+    if (primitive.mode != 4 || primitive.indices == UINT32_MAX || is_blended(model, primitive)) return true;
+
+    auto position = primitive.attributes.find("POSITION");
+    std::vector<f32> positions;
+    if (position == primitive.attributes.end() || position->second >= model.accessors.size() ||
+        model.accessors[position->second].type != "VEC3" || !read_floats(model, position->second, positions)) {
+        std::cerr << "Cannot optimize overdraw: primitive has no readable VEC3 POSITION attribute" << std::endl;
+        return false;
+    }
+
+    std::vector<u32> indices;
+    if (!read_indices(model, primitive.indices, 0, indices)) {
+        std::cerr << "Cannot optimize overdraw: index accessor has no readable data" << std::endl;
+        return false;
+    }
+
+    usize vertex_count = positions.size() / 3;
+    for (u32 index : indices) {
+        if (index >= vertex_count) {
+            std::cerr << "Cannot optimize overdraw: index " << index << " is out of range" << std::endl;
+            return false;
+        }
+    }
+
+    optimize_overdraw(indices.data(), indices.size() - indices.size() % 3, positions.data(), vertex_count,
+                      cache_size, threshold);
+    return write_indices(model, primitive.indices, indices);
+}
+
+bool optimize_overdraw(Model &model, f32 threshold, usize cache_size) {
+    // Each index accessor is reordered once, through its first primitive. Accessors sharing bytes with any other
+    // accessor first get their own copy, since the workers rewrite indices in place.
+    std::vector<Primitive *> primitives;
+    std::vector<u32> accessors;
+    std::vector<u8> seen(model.accessors.size(), 0);
+    for (Mesh &mesh : model.meshes) {
+        for (Primitive &primitive : mesh.primitives) {
+            if (primitive.mode != 4 || primitive.indices == UINT32_MAX || is_blended(model, primitive)) continue;
+            if (primitive.indices < seen.size()) {
+                if (seen[primitive.indices]) continue;
+                seen[primitive.indices] = 1;
+                accessors.push_back(primitive.indices);
+            }
+            primitives.push_back(&primitive);
+        }
+    }
+    unshare_accessors(model, accessors);
+
+    std::vector<char> results(primitives.size(), 0);
+    parallel_for(primitives.size(),
+                 [&](usize i) { results[i] = optimize_overdraw(model, *primitives[i], threshold, cache_size); });
+
+    return std::find(results.begin(), results.end(), 0) == results.end();
+}
+
+}; // namespace gltf
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "types.hpp"
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace gltf {
+
+// Runs `fn(i)` for every i in [0, count) across the available hardware threads. Work is handed out one index at a
+// time, so callers should pass coarse items (whole primitives, meshes or blocks).
+template <typename F> void parallel_for(usize count, F fn) {
+    usize threads = std::min<usize>(std::max<u32>(std::thread::hardware_concurrency(), 1), count);
+    if (threads <= 1) {
+        for (usize i = 0; i < count; i++) fn(i);
+        return;
+    }
+
+    std::atomic<usize> next(0);
+    auto worker = [&]() {
+        for (usize i = next++; i < count; i = next++) fn(i);
+    };
+
+    std::vector<std::thread> pool;
+    for (usize t = 1; t < threads; t++) pool.emplace_back(worker);
+    worker();
+
+    for (std::thread &thread : pool) thread.join();
+}
+
+}; // namespace gltf
@@ -0,0 +1,298 @@
+#include "pose.hpp"
+#include "math.hpp"
+#include "simd.hpp"
+#include "transform.hpp"
+#include <algorithm>
+#include <iostream>
+
+namespace gltf {
+
+bool build_skeleton(const Model &model, u32 skin, Skeleton &skeleton) {
+    skeleton = Skeleton();
+    if (skin >= model.skins.size()) {
+        std::cerr << "Cannot build skeleton: skin " << skin << " does not exist" << std::endl;
+        return false;
+    }
+
+    const Skin &source = model.skins[skin];
+    std::vector<u32> node_joints(model.nodes.size(), UINT32_MAX);
+    for (u32 j = 0; j < source.joints.size(); j++) {
+        u32 node = source.joints[j];
+        if (node >= model.nodes.size()) {
+            std::cerr << "Cannot build skeleton: joint node " << node << " of skin " << skin << " does not exist"
+                      << std::endl;
+            return false;
+        }
+        if (node_joints[node] == UINT32_MAX) node_joints[node] = j;
+    }
+
+    skeleton.skin = skin;
+    skeleton.joints = source.joints;
+    skeleton.node_joints = std::move(node_joints);
+
+    // Joints need not be direct children of each other; intermediate nodes are skipped
+    std::vector<u32> parents, order;
+    build_node_hierarchy(model, parents, order);
+    usize joint_count = skeleton.joints.size();
+    skeleton.parents.assign(joint_count, UINT32_MAX);
+    for (usize j = 0; j < joint_count; j++) {
+        for (u32 p = parents[skeleton.joints[j]]; p != UINT32_MAX; p = parents[p]) {
+            if (skeleton.node_joints[p] != UINT32_MAX) {
+                skeleton.parents[j] = skeleton.node_joints[p];
+                break;
+            }
+        }
+    }
+
+    Pose &rest = skeleton.rest;
+    rest.translations.resize(joint_count);
+    rest.rotations.resize(joint_count);
+    rest.scales.resize(joint_count);
+    for (usize j = 0; j < joint_count; j++) {
+        const Node &node = model.nodes[skeleton.joints[j]];
+        if (node.has_matrix) {
+            decompose_trs(node.matrix, rest.translations[j], rest.rotations[j], rest.scales[j]);
+        } else {
+            rest.translations[j] = node.translation;
+            rest.rotations[j] = node.rotation;
+            rest.scales[j] = node.scale;
+        }
+    }
+
+    return true;
+}
+
+// Sizes `pose` for `count` joints; a no-op for poses that already have that size
+static void size_pose(Pose &pose, usize count) {
+    pose.translations.resize(count);
+    pose.rotations.resize(count);
+    pose.scales.resize(count);
+}
+
+void init_pose(const Skeleton &skeleton, Pose &pose) {
+    pose = skeleton.rest;
+}
+
+void build_joint_mask(const Skeleton &skeleton, u32 joint, f32 weight, std::vector<f32> &mask) {
+    mask.assign(skeleton.joints.size(), 0.0f);
+    for (usize j = 0; j < skeleton.joints.size(); j++) {
+        for (u32 k = (u32)j; k != UINT32_MAX; k = skeleton.parents[k]) {
+            if (k == joint) {
+                mask[j] = weight;
+                break;
+            }
+        }
+    }
+}
+
+void sample_pose(const Skeleton &skeleton, const AnimationClip &clip, f32 time, AnimationCursor &cursor, Pose &pose) {
+    const Pose &rest = skeleton.rest;
+    size_pose(pose, skeleton.joints.size());
+    std::copy(rest.translations.begin(), rest.translations.end(), pose.translations.begin());
+    std::copy(rest.rotations.begin(), rest.rotations.end(), pose.rotations.begin());
+    std::copy(rest.scales.begin(), rest.scales.end(), pose.scales.begin());
+
+    if (cursor.keys.size() != clip.tracks.size()) reset_animation_cursor(clip, cursor);
+
+    f32 values[4];
+    for (usize t = 0; t < clip.tracks.size(); t++) {
+        const AnimationTrack &track = clip.tracks[t];
+        if (track.path == ANIMATION_PATH_WEIGHTS || track.node >= skeleton.node_joints.size()) continue;
+
+        u32 joint = skeleton.node_joints[track.node];
+        if (joint == UINT32_MAX) continue;
+
+        sample_track(track, time, values, cursor.keys[t]);
+        if (track.path == ANIMATION_PATH_TRANSLATION) {
+            pose.translations[joint] = {values[0], values[1], values[2]};
+        } else if (track.path == ANIMATION_PATH_ROTATION) {
+            pose.rotations[joint] = {values[0], values[1], values[2], values[3]};
+        } else {
+            pose.scales[joint] = {values[0], values[1], values[2]};
+        }
+    }
+}
+
+static f32 joint_weight(f32 weight, const f32 *mask, usize joint) {
+    return mask ? weight * mask[joint] : weight;
+}
+
+// out[j] = op(a[j], b[j], weight of j) over three-component joints. Four joints fill exactly three vectors, with the
+// weights spread to match; the remaining joints go through padded copies so loads and stores stay in bounds.
+template <typename Op>
+static void blend_vec3(const Vec3 *a, const Vec3 *b, f32 weight, const f32 *mask, usize count, Vec3 *out, Op op) {
+    usize j = 0;
+    for (; j + 4 <= count; j += 4) {
+        f32 w0 = joint_weight(weight, mask, j), w1 = joint_weight(weight, mask, j + 1);
+        f32 w2 = joint_weight(weight, mask, j + 2), w3 = joint_weight(weight, mask, j + 3);
+        F4 weights[3] = {f4_set(w0, w0, w0, w1), f4_set(w1, w1, w2, w2), f4_set(w2, w3, w3, w3)};
+
+        const f32 *pa = &a[j].x, *pb = &b[j].x;
+        f32 *po = &out[j].x;
+        for (usize k = 0; k < 3; k++) f4_store(po + k * 4, op(f4_load(pa + k * 4), f4_load(pb + k * 4), weights[k]));
+    }
+
+    for (; j < count; j++) {
+        f32 r[4];
+        F4 va = f4_set(a[j].x, a[j].y, a[j].z, 0.0f), vb = f4_set(b[j].x, b[j].y, b[j].z, 0.0f);
+        f4_store(r, op(va, vb, f4_splat(joint_weight(weight, mask, j))));
+        out[j] = {r[0], r[1], r[2]};
+    }
+}
+
+// out[j] = op(a[j], b[j], weight of j) over quaternions, four joints at a time transposed so that q[c] holds
+// component c of each joint. The last group is padded with identity rotations.
+template <typename Op>
+static void blend_quat(const Vec4 *a, const Vec4 *b, f32 weight, const f32 *mask, usize count, Vec4 *out, Op op) {
+    const F4 identity = f4_set(0.0f, 0.0f, 0.0f, 1.0f);
+    for (usize j = 0; j < count; j += 4) {
+        usize n = std::min<usize>(4, count - j);
+        F4 qa[4], qb[4], r[4];
+        f32 w[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+        for (usize k = 0; k < 4; k++) {
+            qa[k] = k < n ? f4_load(&a[j + k].x) : identity;
+            qb[k] = k < n ? f4_load(&b[j + k].x) : identity;
+            if (k < n) w[k] = joint_weight(weight, mask, j + k);
+        }
+        f4_transpose(qa[0], qa[1], qa[2], qa[3]);
+        f4_transpose(qb[0], qb[1], qb[2], qb[3]);
+
+        op(qa, qb, f4_load(w), r);
+
+        f4_transpose(r[0], r[1], r[2], r[3]);
+        for (usize k = 0; k < n; k++) f4_store(&out[j + k].x, r[k]);
+    }
+}
+
+static F4 dot_lanes(const F4 *a, const F4 *b) {
+    return a[0] * b[0] + a[1] * b[1] + a[2] * b[2] + a[3] * b[3];
+}
+
+static void normalize_lanes(F4 *q) {
+    F4 length = f4_sqrt(dot_lanes(q, q));
+    F4 scale = f4_select(length > f4_splat(0.0f), f4_splat(1.0f) / length, f4_splat(0.0f));
+    for (usize c = 0; c < 4; c++) q[c] = q[c] * scale;
+}
+
+// r = nlerp(a, b, w) along the shorter arc
+static void nlerp_lanes(const F4 *a, const F4 *b, F4 w, F4 *r) {
+    F4 wb = f4_select(dot_lanes(a, b) < f4_splat(0.0f), f4_splat(0.0f) - w, w);
+    F4 wa = f4_splat(1.0f) - w;
+    for (usize c = 0; c < 4; c++) r[c] = a[c] * wa + b[c] * wb;
+    normalize_lanes(r);
+}
+
+// Hamilton product, as quat_multiply()
+static void multiply_lanes(const F4 *a, const F4 *b, F4 *r) {
+    r[0] = a[3] * b[0] + a[0] * b[3] + a[1] * b[2] - a[2] * b[1];
+    r[1] = a[3] * b[1] - a[0] * b[2] + a[1] * b[3] + a[2] * b[0];
+    r[2] = a[3] * b[2] + a[0] * b[1] - a[1] * b[0] + a[2] * b[3];
+    r[3] = a[3] * b[3] - a[0] * b[0] - a[1] * b[1] - a[2] * b[2];
+}
+
+static bool pose_sizes_match(const Pose &a, const Pose &b) {
+    usize count = a.translations.size();
+    return a.rotations.size() == count && a.scales.size() == count && b.translations.size() == count &&
+           b.rotations.size() == count && b.scales.size() == count;
+}
+
+void blend_poses(const Pose &a, const Pose &b, f32 weight, const f32 *mask, Pose &out) {
+    if (!pose_sizes_match(a, b)) {
+        std::cerr << "Cannot blend poses: joint counts differ" << std::endl;
+        return;
+    }
+
+    usize count = a.translations.size();
+    size_pose(out, count);
+
+    auto lerp = [](F4 x, F4 y, F4 w) {
+        return x + (y - x) * w;
+    };
+    blend_vec3(a.translations.data(), b.translations.data(), weight, mask, count, out.translations.data(), lerp);
+    blend_vec3(a.scales.data(), b.scales.data(), weight, mask, count, out.scales.data(), lerp);
+    blend_quat(a.rotations.data(), b.rotations.data(), weight, mask, count, out.rotations.data(), nlerp_lanes);
+}
+
+void make_additive_pose(const Pose &pose, const Pose &reference, Pose &additive) {
+    if (!pose_sizes_match(pose, reference)) {
+        std::cerr << "Cannot make additive pose: joint counts differ" << std::endl;
+        return;
+    }
+
+    usize count = pose.translations.size();
+    size_pose(additive, count);
+
+    auto offset = [](F4 p, F4 r, F4) {
+        return p - r;
+    };
+    auto ratio = [](F4 p, F4 r, F4) {
+        return f4_select(f4_abs(r) > f4_splat(0.0f), p / r, f4_splat(1.0f));
+    };
+    auto relative = [](const F4 *p, const F4 *r, F4, F4 *out) {
+        // conj(r) * p
+        F4 conjugate[4] = {f4_splat(0.0f) - r[0], f4_splat(0.0f) - r[1], f4_splat(0.0f) - r[2], r[3]};
+        multiply_lanes(conjugate, p, out);
+    };
+
+    const Vec3 *translations = pose.translations.data(), *scales = pose.scales.data();
+    blend_vec3(translations, reference.translations.data(), 1.0f, nullptr, count, additive.translations.data(), offset);
+    blend_vec3(scales, reference.scales.data(), 1.0f, nullptr, count, additive.scales.data(), ratio);
+    blend_quat(pose.rotations.data(), reference.rotations.data(), 1.0f, nullptr, count, additive.rotations.data(),
+               relative);
+}
+
+void add_pose(const Pose &base, const Pose &additive, f32 weight, const f32 *mask, Pose &out) {
+    if (!pose_sizes_match(base, additive)) {
+        std::cerr << "Cannot add pose: joint counts differ" << std::endl;
+        return;
+    }
+
+    usize count = base.translations.size();
+    size_pose(out, count);
+
+    auto offset = [](F4 x, F4 d, F4 w) {
+        return x + d * w;
+    };
+    auto ratio = [](F4 x, F4 d, F4 w) {
+        return x * (f4_splat(1.0f) + (d - f4_splat(1.0f)) * w);
+    };
+    auto relative = [](const F4 *x, const F4 *d, F4 w, F4 *r) {
+        // x * nlerp(identity, d, w)
+        const F4 identity[4] = {f4_splat(0.0f), f4_splat(0.0f), f4_splat(0.0f), f4_splat(1.0f)};
+        F4 partial[4];
+        nlerp_lanes(identity, d, w, partial);
+        multiply_lanes(x, partial, r);
+        normalize_lanes(r);
+    };
+
+    blend_vec3(base.translations.data(), additive.translations.data(), weight, mask, count, out.translations.data(),
+               offset);
+    blend_vec3(base.scales.data(), additive.scales.data(), weight, mask, count, out.scales.data(), ratio);
+    blend_quat(base.rotations.data(), additive.rotations.data(), weight, mask, count, out.rotations.data(), relative);
+}
+
+void apply_pose(const Skeleton &skeleton, const Pose &pose, NodeTransforms &transforms) {
+    usize count = std::min(skeleton.joints.size(), pose.translations.size());
+    for (usize j = 0; j < count; j++) {
+        u32 node = skeleton.joints[j];
+        if (node >= transforms.locals.size()) continue;
+
+        set_node_translation(transforms, node, pose.translations[j]);
+        set_node_rotation(transforms, node, pose.rotations[j]);
+        set_node_scale(transforms, node, pose.scales[j]);
+    }
+}
+
+void apply_pose(const Skeleton &skeleton, const Pose &pose, Model &model) {
+    usize count = std::min(skeleton.joints.size(), pose.translations.size());
+    for (usize j = 0; j < count; j++) {
+        u32 node = skeleton.joints[j];
+        if (node >= model.nodes.size()) continue;
+
+        set_translation(model, node, pose.translations[j]);
+        set_rotation(model, node, pose.rotations[j]);
+        set_scale(model, node, pose.scales[j]);
+    }
+}
+
+}; // namespace gltf
@@ -0,0 +1,242 @@
+#include "scene_bvh.hpp"
+#include "bounds.hpp"
+#include "bvh_build.hpp"
+#include "parallel.hpp"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+namespace gltf {
+
+static void collect_items(const Model &model, u32 scene, std::vector<SceneBvhItem> &items) {
+    const BoundsCache &cache = model.bounds;
+    const std::vector<Mat4> &worlds = model.transforms.world;
+    std::vector<bool> visited(model.nodes.size(), false);
+    std::vector<u32> stack(model.scenes[scene].nodes.rbegin(), model.scenes[scene].nodes.rend());
+
+    while (!stack.empty()) {
+        u32 n = stack.back();
+        stack.pop_back();
+        if (n >= model.nodes.size() || visited[n]) continue;
+        visited[n] = true;
+
+        const Node &node = model.nodes[n];
+        if (node.mesh < model.meshes.size()) {
+            for (u32 p = 0; p < model.meshes[node.mesh].primitives.size(); p++) {
+                SceneBvhItem item;
+                item.node = n;
+                item.mesh = node.mesh;
+                item.primitive = p;
+                items.push_back(item);
+            }
+        }
+
+        for (usize c = node.children.size(); c-- > 0;) stack.push_back(node.children[c]);
+    }
+
+    parallel_for((items.size() + 4095) / 4096, [&](usize block) {
+        usize end = std::min(items.size(), (block + 1) * 4096);
+        for (usize i = block * 4096; i < end; i++) {
+            SceneBvhItem &item = items[i];
+            Bounds world = transform_bounds(cache.primitives[item.mesh][item.primitive], worlds[item.node]);
+            item.min = world.min;
+            item.max = world.max;
+        }
+    });
+
+    // Primitives without positions cannot be hit and would poison the SAH with infinite boxes
+    auto empty = [](const SceneBvhItem &item) { return item.min.x > item.max.x; };
+    items.erase(std::remove_if(items.begin(), items.end(), empty), items.end());
+}
+
+bool build_scene_bvh(Model &model, u32 scene, SceneBvh &bvh, u32 max_leaf_items) {
+    bvh.nodes.clear();
+    bvh.items.clear();
+    bvh.scene = scene;
+
+    if (scene >= model.scenes.size()) {
+        std::cerr << "Cannot build scene BVH: scene " << scene << " does not exist" << std::endl;
+        return false;
+    }
+
+    update_bounds(model);
+    collect_items(model, scene, bvh.items);
+    build_bvh(bvh.items, bvh.nodes, max_leaf_items);
+    return true;
+}
+
+void refit_scene_bvh(Model &model, SceneBvh &bvh) {
+    if (bvh.nodes.empty()) return;
+
+    update_bounds(model);
+    const BoundsCache &cache = model.bounds;
+    const std::vector<Mat4> &worlds = model.transforms.world;
+    for (SceneBvhItem &item : bvh.items) {
+        Bounds world = transform_bounds(cache.primitives[item.mesh][item.primitive], worlds[item.node]);
+        item.min = world.min;
+        item.max = world.max;
+    }
+
+    for (usize i = bvh.nodes.size(); i-- > 0;) {
+        SceneBvhNode &node = bvh.nodes[i];
+        BvhBox box;
+        if (node.count > 0) {
+            for (u32 j = node.first; j < node.first + node.count; j++) box.grow(bvh.items[j].min, bvh.items[j].max);
+        } else {
+            box.grow(bvh.nodes[node.first].min, bvh.nodes[node.first].max);
+            box.grow(bvh.nodes[node.first + 1].min, bvh.nodes[node.first + 1].max);
+        }
+
+        node.min = {box.min[0], box.min[1], box.min[2]};
+        node.max = {box.max[0], box.max[1], box.max[2]};
+    }
+}
+
+Frustum frustum_from_matrix(const Mat4 &view_projection) {
+    const f32(*c)[4] = view_projection.cols;
+    const f32 signs[6] = {1.0f, -1.0f, 1.0f, -1.0f, 1.0f, -1.0f};
+
+    // Gribb-Hartmann: row 3 plus or minus rows 0 (left, right), 1 (bottom, top) and 2 (near, far)
+    Frustum frustum;
+    for (usize p = 0; p < 6; p++) {
+        usize row = p / 2;
+        f32 plane[4];
+        for (usize j = 0; j < 4; j++) plane[j] = c[j][3] + signs[p] * c[j][row];
+
+        f32 length = std::sqrt(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2]);
+        if (length > 0.0f) {
+            for (usize j = 0; j < 4; j++) plane[j] /= length;
+        }
+        frustum.planes[p] = {plane[0], plane[1], plane[2], plane[3]};
+    }
+
+    return frustum;
+}
+
+// Classifies a box against the planes set in `mask`: returns false when it is outside one of them and clears the
+// bits of planes it lies fully inside of
+static bool test_frustum(const Frustum &frustum, const Vec3 &min, const Vec3 &max, u32 &mask) {
+    for (usize p = 0; p < 6; p++) {
+        if (!(mask & (1u << p))) continue;
+
+        const Vec4 &plane = frustum.planes[p];
+        f32 far_side = plane.x * (plane.x >= 0.0f ? max.x : min.x) + plane.y * (plane.y >= 0.0f ? max.y : min.y) +
+                       plane.z * (plane.z >= 0.0f ? max.z : min.z) + plane.w;
+        if (far_side < 0.0f) return false;
+
+        f32 near_side = plane.x * (plane.x >= 0.0f ? min.x : max.x) + plane.y * (plane.y >= 0.0f ? min.y : max.y) +
+                        plane.z * (plane.z >= 0.0f ? min.z : max.z) + plane.w;
+        if (near_side >= 0.0f) mask &= ~(1u << p);
+    }
+
+    return true;
+}
+
+void query_frustum(const SceneBvh &bvh, const Frustum &frustum, std::vector<u32> &items) {
+    if (bvh.nodes.empty()) return;
+
+    // Planes a subtree is fully inside of are dropped from the mask, so interior subtrees are collected untested
+    u32 stack[BVH_STACK_SIZE], masks[BVH_STACK_SIZE];
+    usize size = 0;
+    stack[size] = 0;
+    masks[size++] = 0x3f;
+
+    while (size > 0) {
+        size--;
+        const SceneBvhNode &node = bvh.nodes[stack[size]];
+        u32 mask = masks[size];
+        if (mask && !test_frustum(frustum, node.min, node.max, mask)) continue;
+
+        if (node.count > 0) {
+            for (u32 i = node.first; i < node.first + node.count; i++) {
+                u32 item_mask = mask;
+                if (!item_mask || test_frustum(frustum, bvh.items[i].min, bvh.items[i].max, item_mask)) {
+                    items.push_back(i);
+                }
+            }
+            continue;
+        }
+
+        stack[size] = node.first;
+        masks[size++] = mask;
+        stack[size] = node.first + 1;
+        masks[size++] = mask;
+    }
+}
+
+static bool overlaps(const Vec3 &a_min, const Vec3 &a_max, const Vec3 &b_min, const Vec3 &b_max) {
+    return a_min.x <= b_max.x && a_max.x >= b_min.x && a_min.y <= b_max.y && a_max.y >= b_min.y &&
+           a_min.z <= b_max.z && a_max.z >= b_min.z;
+}
+
+void query_aabb(const SceneBvh &bvh, const Vec3 &min, const Vec3 &max, std::vector<u32> &items) {
+    if (bvh.nodes.empty()) return;
+
+    u32 stack[BVH_STACK_SIZE];
+    usize size = 0;
+    stack[size++] = 0;
+
+    while (size > 0) {
+        const SceneBvhNode &node = bvh.nodes[stack[--size]];
+        if (!overlaps(node.min, node.max, min, max)) continue;
+
+        if (node.count > 0) {
+            for (u32 i = node.first; i < node.first + node.count; i++) {
+                if (overlaps(bvh.items[i].min, bvh.items[i].max, min, max)) items.push_back(i);
+            }
+            continue;
+        }
+
+        stack[size++] = node.first;
+        stack[size++] = node.first + 1;
+    }
+}
+
+void query_ray(const SceneBvh &bvh, const Vec3 &origin, const Vec3 &direction, f32 max_distance,
+               std::vector<SceneBvhHit> &hits) {
+    if (bvh.nodes.empty()) return;
+
+    const f32 o[3] = {origin.x, origin.y, origin.z};
+    const f32 inverse[3] = {1.0f / direction.x, 1.0f / direction.y, 1.0f / direction.z};
+    usize first_hit = hits.size();
+
+    if (bvh_ray_box(o, inverse, max_distance, bvh.nodes[0].min, bvh.nodes[0].max) == FLT_MAX) return;
+
+    // Nodes on the stack were already hit; the nearer child is pushed last so it is visited first
+    u32 stack[BVH_STACK_SIZE];
+    usize size = 0;
+    stack[size++] = 0;
+
+    while (size > 0) {
+        const SceneBvhNode &node = bvh.nodes[stack[--size]];
+
+        if (node.count > 0) {
+            for (u32 i = node.first; i < node.first + node.count; i++) {
+                f32 t = bvh_ray_box(o, inverse, max_distance, bvh.items[i].min, bvh.items[i].max);
+                if (t == FLT_MAX) continue;
+
+                SceneBvhHit hit;
+                hit.item = i;
+                hit.distance = t;
+                hits.push_back(hit);
+            }
+            continue;
+        }
+
+        const SceneBvhNode &a = bvh.nodes[node.first];
+        const SceneBvhNode &b = bvh.nodes[node.first + 1];
+        f32 left = bvh_ray_box(o, inverse, max_distance, a.min, a.max);
+        f32 right = bvh_ray_box(o, inverse, max_distance, b.min, b.max);
+        u32 near_child = left <= right ? node.first : node.first + 1;
+        u32 far_child = left <= right ? node.first + 1 : node.first;
+
+        if (std::max(left, right) != FLT_MAX) stack[size++] = far_child;
+        if (std::min(left, right) != FLT_MAX) stack[size++] = near_child;
+    }
+
+    std::sort(hits.begin() + first_hit, hits.end(),
+              [](const SceneBvhHit &a, const SceneBvhHit &b) { return a.distance < b.distance; });
+}
+
+}; // namespace gltf
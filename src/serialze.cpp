@@ -1,3 +1,4 @@
+#include "accessor.hpp"
 #include "fs.hpp"
 #include "gltf.hpp"
 #include <cstring>
@@ -39,13 +40,109 @@ std::string create_json_string(const std::string &str) {
     return oss.str();
 }
 
+// GLB stores every buffer in a single BIN chunk, so each buffer is placed at a 4-byte aligned offset within it
+std::vector<usize> glb_buffer_offsets(const std::vector<Buffer> &buffers, usize &total_length) {
+    std::vector<usize> offsets(buffers.size());
+
+    total_length = 0;
+    for (usize i = 0; i < buffers.size(); i++) {
+        total_length = (total_length + 3) & ~(usize)3;
+        offsets[i] = total_length;
+        total_length += buffers[i].data.size();
+    }
+
+    return offsets;
+}
+
+// Whether an attribute uses a component type only KHR_mesh_quantization allows: integer positions, normals and
+// tangents, or signed / unnormalized texture coordinates
+static bool quantized_attribute(const Model &model, const std::string &name, u32 accessor) {
+    if (accessor >= model.accessors.size() || model.accessors[accessor].component_type == COMPONENT_FLOAT) return false;
+    if (name == "POSITION" || name == "NORMAL" || name == "TANGENT") return true;
+
+    const Accessor &data = model.accessors[accessor];
+    bool unsigned_normalized = data.normalized && (data.component_type == COMPONENT_UNSIGNED_BYTE ||
+                                                   data.component_type == COMPONENT_UNSIGNED_SHORT);
+    return name.compare(0, 9, "TEXCOORD_") == 0 && !unsigned_normalized;
+}
+
+static bool uses_mesh_quantization(const Model &model) {
+    for (const Mesh &mesh : model.meshes) {
+        for (const Primitive &primitive : mesh.primitives) {
+            for (const auto &attr : primitive.attributes) {
+                if (quantized_attribute(model, attr.first, attr.second)) return true;
+            }
+            for (const auto &target : primitive.targets) {
+                for (const auto &attr : target) {
+                    if (quantized_attribute(model, attr.first, attr.second)) return true;
+                }
+            }
+        }
+    }
+    return false;
+}
+
+static bool uses_animation_dequantize(const Model &model) {
+    for (const Animation &animation : model.animations) {
+        for (const AnimationSampler &sampler : animation.samplers) {
+            if (!sampler.dequantize_offset.empty()) return true;
+        }
+    }
+    return false;
+}
+
 std::string Model::generate_json(bool for_glb) {
+    usize glb_length = 0;
+    std::vector<usize> glb_offsets = glb_buffer_offsets(buffers, glb_length);
+
     std::ostringstream json;
+    // Enough significant digits for every f32 to read back unchanged
+    json.precision(9);
     json << "{";
 
     // Asset section (required)
     json << "\"asset\":{\"version\":\"2.0\"}";
 
+    // Extensions used
+    std::vector<std::string> extensions_used;
+    for (const Node &node : nodes) {
+        if (!node.lods.empty()) {
+            extensions_used.push_back("MSFT_lod");
+            break;
+        }
+    }
+
+    // Readers without KHR_mesh_quantization would reject the quantized attributes, so it is also required
+    std::vector<std::string> extensions_required;
+    if (uses_mesh_quantization(*this)) {
+        extensions_used.push_back("KHR_mesh_quantization");
+        extensions_required.push_back("KHR_mesh_quantization");
+    }
+
+    // Range-quantized translation and scale keys are not valid core glTF; other readers must not load them as is
+    if (uses_animation_dequantize(*this)) {
+        extensions_used.push_back("XIUXIU_animation_dequantize");
+        extensions_required.push_back("XIUXIU_animation_dequantize");
+    }
+
+    if (!extensions_used.empty()) {
+        json << ",\"extensionsUsed\":[";
+        for (usize i = 0; i < extensions_used.size(); i++) {
+            if (i > 0) json << ",";
+            json << create_json_string(extensions_used[i]);
+        }
+        json << "]";
+    }
+
+    if (!extensions_required.empty()) {
+        json << ",\"extensionsRequired\":[";
+        for (usize i = 0; i < extensions_required.size(); i++) {
+            if (i > 0) json << ",";
+            json << create_json_string(extensions_required[i]);
+        }
+        json << "]";
+    }
+
     // Scene section
     if (!scenes.empty()) {
         json << ",\"scene\":" << default_scene;
@@ -84,6 +181,7 @@ std::string Model::generate_json(bool for_glb) {
             if (i > 0) json << ",";
 
             json << "{";
+            std::streampos node_start = json.tellp();
 
             // Children
             if (!nodes[i].children.empty()) {
@@ -152,20 +250,37 @@ std::string Model::generate_json(bool for_glb) {
                 }
             }
 
+            // Morph target weights
+            if (!nodes[i].weights.empty()) {
+                if (json.tellp() != node_start) json << ",";
+
+                json << "\"weights\":[";
+                for (usize j = 0; j < nodes[i].weights.size(); j++) {
+                    if (j > 0) json << ",";
+                    json << nodes[i].weights[j];
+                }
+                json << "]";
+            }
+
             // Name
             if (!nodes[i].name.empty()) {
-                if (has_transform_prop || nodes[i].has_matrix ||
-                    (nodes[i].translation.x != 0.0f || nodes[i].translation.y != 0.0f ||
-                     nodes[i].translation.z != 0.0f) ||
-                    (nodes[i].rotation.x != 0.0f || nodes[i].rotation.y != 0.0f || nodes[i].rotation.z != 0.0f ||
-                     nodes[i].rotation.w != 1.0f) ||
-                    (nodes[i].scale.x != 1.0f || nodes[i].scale.y != 1.0f || nodes[i].scale.z != 1.0f)) {
-                    json << ",";
-                }
+                if (json.tellp() != node_start) json << ",";
 
                 json << "\"name\":" << create_json_string(nodes[i].name);
             }
 
+            // Extensions
+            if (!nodes[i].lods.empty()) {
+                if (json.tellp() != node_start) json << ",";
+
+                json << "\"extensions\":{\"MSFT_lod\":{\"ids\":[";
+                for (usize j = 0; j < nodes[i].lods.size(); j++) {
+                    if (j > 0) json << ",";
+                    json << nodes[i].lods[j];
+                }
+                json << "]}}";
+            }
+
             json << "}";
         }
         json << "]";
@@ -197,6 +312,25 @@ std::string Model::generate_json(bool for_glb) {
                 }
                 json << "}";
 
+                // Morph targets
+                if (!meshes[i].primitives[j].targets.empty()) {
+                    json << ",\"targets\":[";
+                    for (usize k = 0; k < meshes[i].primitives[j].targets.size(); k++) {
+                        if (k > 0) json << ",";
+
+                        json << "{";
+                        bool first_target_attr = true;
+                        for (const auto &attr : meshes[i].primitives[j].targets[k]) {
+                            if (!first_target_attr) json << ",";
+                            first_target_attr = false;
+
+                            json << "\"" << attr.first << "\":" << attr.second;
+                        }
+                        json << "}";
+                    }
+                    json << "]";
+                }
+
                 // Indices
                 if (meshes[i].primitives[j].indices != UINT32_MAX) {
                     json << ",\"indices\":" << meshes[i].primitives[j].indices;
@@ -394,6 +528,65 @@ std::string Model::generate_json(bool for_glb) {
         json << "]";
     }
 
+    // Animations array
+    if (!animations.empty()) {
+        json << ",\"animations\":[";
+        for (usize i = 0; i < animations.size(); i++) {
+            if (i > 0) json << ",";
+
+            json << "{";
+
+            // Channels (required)
+            json << "\"channels\":[";
+            for (usize j = 0; j < animations[i].channels.size(); j++) {
+                const AnimationChannel &channel = animations[i].channels[j];
+                if (j > 0) json << ",";
+
+                json << "{\"sampler\":" << channel.sampler << ",\"target\":{";
+                if (channel.target.node != UINT32_MAX) json << "\"node\":" << channel.target.node << ",";
+                json << "\"path\":" << create_json_string(channel.target.path) << "}}";
+            }
+            json << "]";
+
+            // Samplers (required)
+            json << ",\"samplers\":[";
+            for (usize j = 0; j < animations[i].samplers.size(); j++) {
+                const AnimationSampler &sampler = animations[i].samplers[j];
+                if (j > 0) json << ",";
+
+                json << "{\"input\":" << sampler.input << ",\"output\":" << sampler.output;
+                if (sampler.interpolation != "LINEAR") {
+                    json << ",\"interpolation\":" << create_json_string(sampler.interpolation);
+                }
+
+                // Range quantization, listed as required above
+                if (!sampler.dequantize_offset.empty()) {
+                    json << ",\"extensions\":{\"XIUXIU_animation_dequantize\":{\"offset\":[";
+                    for (usize k = 0; k < sampler.dequantize_offset.size(); k++) {
+                        if (k > 0) json << ",";
+                        json << sampler.dequantize_offset[k];
+                    }
+                    json << "],\"scale\":[";
+                    for (usize k = 0; k < sampler.dequantize_scale.size(); k++) {
+                        if (k > 0) json << ",";
+                        json << sampler.dequantize_scale[k];
+                    }
+                    json << "]}}";
+                }
+                json << "}";
+            }
+            json << "]";
+
+            // Name
+            if (!animations[i].name.empty()) {
+                json << ",\"name\":" << create_json_string(animations[i].name);
+            }
+
+            json << "}";
+        }
+        json << "]";
+    }
+
     // Accessors array
     if (!accessors.empty()) {
         json << ",\"accessors\":[";
@@ -462,12 +655,18 @@ std::string Model::generate_json(bool for_glb) {
 
             json << "{";
 
-            // Buffer (required)
-            json << "\"buffer\":" << buffer_views[i].buffer;
+            // Buffer (required), rebased onto the single BIN chunk buffer for GLB
+            usize byte_offset = buffer_views[i].byte_offset;
+            if (for_glb) {
+                if (buffer_views[i].buffer < glb_offsets.size()) byte_offset += glb_offsets[buffer_views[i].buffer];
+                json << "\"buffer\":0";
+            } else {
+                json << "\"buffer\":" << buffer_views[i].buffer;
+            }
 
             // ByteOffset
-            if (buffer_views[i].byte_offset != 0) {
-                json << ",\"byteOffset\":" << buffer_views[i].byte_offset;
+            if (byte_offset != 0) {
+                json << ",\"byteOffset\":" << byte_offset;
             }
 
             // ByteLength (required)
@@ -499,7 +698,7 @@ std::string Model::generate_json(bool for_glb) {
 
         if (for_glb) {
             // For GLB, just include the byte length
-            json << "{\"byteLength\":" << buffers[0].byte_length << "}";
+            json << "{\"byteLength\":" << glb_length << "}";
         } else {
             for (usize i = 0; i < buffers.size(); i++) {
                 if (i > 0) json << ",";
@@ -578,9 +777,14 @@ bool Model::save_as_glb(const std::string &path) {
     usize padded_json_length = json_content.size() + json_padding;
 
     // Combine all buffer data into a single binary chunk
-    std::vector<u8> bin_data;
-    for (const auto &buffer : buffers) {
-        bin_data.insert(bin_data.end(), buffer.data.begin(), buffer.data.end());
+    usize bin_length = 0;
+    std::vector<usize> bin_offsets = glb_buffer_offsets(buffers, bin_length);
+
+    std::vector<u8> bin_data(bin_length, 0);
+    for (usize i = 0; i < buffers.size(); i++) {
+        if (!buffers[i].data.empty()) {
+            std::memcpy(bin_data.data() + bin_offsets[i], buffers[i].data.data(), buffers[i].data.size());
+        }
     }
 
     // Calculate padding needed to align BIN chunk to 4-byte boundary
@@ -0,0 +1,311 @@
+#pragma once
+
+#include "types.hpp"
+#include <cmath>
+#include <cstring>
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define GLTF_SIMD_SSE2 1
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define GLTF_SIMD_NEON 1
+#endif
+
+namespace gltf {
+
+// Four-wide float vector over SSE2, NEON or plain scalars, selected at compile time. Comparisons return lane masks
+// (all bits set or clear) that combine with the bitwise helpers and select().
+struct F4 {
+#if defined(GLTF_SIMD_SSE2)
+    __m128 v;
+#elif defined(GLTF_SIMD_NEON)
+    float32x4_t v;
+#else
+    f32 v[4];
+#endif
+};
+
+#if defined(GLTF_SIMD_SSE2)
+
+inline F4 f4_splat(f32 x) {
+    return {_mm_set1_ps(x)};
+}
+inline F4 f4_set(f32 a, f32 b, f32 c, f32 d) {
+    return {_mm_setr_ps(a, b, c, d)};
+}
+inline F4 f4_load(const f32 *p) {
+    return {_mm_loadu_ps(p)};
+}
+inline void f4_store(f32 *p, F4 a) {
+    _mm_storeu_ps(p, a.v);
+}
+// Four signed 16-bit integers converted to floats; `p` needs no more than 2-byte alignment
+inline F4 f4_from_i16(const i16 *p) {
+    __m128i x = _mm_loadl_epi64((const __m128i *)p);
+    return {_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16))};
+}
+
+inline F4 operator+(F4 a, F4 b) {
+    return {_mm_add_ps(a.v, b.v)};
+}
+inline F4 operator-(F4 a, F4 b) {
+    return {_mm_sub_ps(a.v, b.v)};
+}
+inline F4 operator*(F4 a, F4 b) {
+    return {_mm_mul_ps(a.v, b.v)};
+}
+inline F4 operator/(F4 a, F4 b) {
+    return {_mm_div_ps(a.v, b.v)};
+}
+inline F4 f4_min(F4 a, F4 b) {
+    return {_mm_min_ps(a.v, b.v)};
+}
+inline F4 f4_max(F4 a, F4 b) {
+    return {_mm_max_ps(a.v, b.v)};
+}
+inline F4 f4_sqrt(F4 a) {
+    return {_mm_sqrt_ps(a.v)};
+}
+
+inline F4 operator<(F4 a, F4 b) {
+    return {_mm_cmplt_ps(a.v, b.v)};
+}
+inline F4 operator<=(F4 a, F4 b) {
+    return {_mm_cmple_ps(a.v, b.v)};
+}
+inline F4 operator>(F4 a, F4 b) {
+    return {_mm_cmpgt_ps(a.v, b.v)};
+}
+inline F4 operator>=(F4 a, F4 b) {
+    return {_mm_cmpge_ps(a.v, b.v)};
+}
+inline F4 operator&(F4 a, F4 b) {
+    return {_mm_and_ps(a.v, b.v)};
+}
+inline F4 operator|(F4 a, F4 b) {
+    return {_mm_or_ps(a.v, b.v)};
+}
+
+// Lane i of the result is `a` where `mask` is set, `b` elsewhere
+inline F4 f4_select(F4 mask, F4 a, F4 b) {
+    return {_mm_or_ps(_mm_and_ps(mask.v, a.v), _mm_andnot_ps(mask.v, b.v))};
+}
+// Bit i is set when lane i of `mask` is set
+inline u32 f4_mask(F4 mask) {
+    return (u32)_mm_movemask_ps(mask.v);
+}
+// Rows to columns: lane j of `a` ends up in lane 0 of the j-th argument, and so on
+inline void f4_transpose(F4 &a, F4 &b, F4 &c, F4 &d) {
+    _MM_TRANSPOSE4_PS(a.v, b.v, c.v, d.v);
+}
+
+#elif defined(GLTF_SIMD_NEON)
+
+inline F4 f4_splat(f32 x) {
+    return {vdupq_n_f32(x)};
+}
+inline F4 f4_set(f32 a, f32 b, f32 c, f32 d) {
+    const f32 values[4] = {a, b, c, d};
+    return {vld1q_f32(values)};
+}
+inline F4 f4_load(const f32 *p) {
+    return {vld1q_f32(p)};
+}
+inline void f4_store(f32 *p, F4 a) {
+    vst1q_f32(p, a.v);
+}
+inline F4 f4_from_i16(const i16 *p) {
+    return {vcvtq_f32_s32(vmovl_s16(vld1_s16(p)))};
+}
+
+inline F4 operator+(F4 a, F4 b) {
+    return {vaddq_f32(a.v, b.v)};
+}
+inline F4 operator-(F4 a, F4 b) {
+    return {vsubq_f32(a.v, b.v)};
+}
+inline F4 operator*(F4 a, F4 b) {
+    return {vmulq_f32(a.v, b.v)};
+}
+#if defined(__aarch64__)
+inline F4 operator/(F4 a, F4 b) {
+    return {vdivq_f32(a.v, b.v)};
+}
+#else
+inline F4 operator/(F4 a, F4 b) {
+    // Reciprocal estimate refined with two Newton-Raphson steps
+    float32x4_t r = vrecpeq_f32(b.v);
+    r = vmulq_f32(vrecpsq_f32(b.v, r), r);
+    r = vmulq_f32(vrecpsq_f32(b.v, r), r);
+    return {vmulq_f32(a.v, r)};
+}
+#endif
+inline F4 f4_min(F4 a, F4 b) {
+    return {vminq_f32(a.v, b.v)};
+}
+inline F4 f4_max(F4 a, F4 b) {
+    return {vmaxq_f32(a.v, b.v)};
+}
+#if defined(__aarch64__)
+inline F4 f4_sqrt(F4 a) {
+    return {vsqrtq_f32(a.v)};
+}
+#else
+inline F4 f4_sqrt(F4 a) {
+    // a * rsqrt(a), the estimate refined with two Newton-Raphson steps; zero lanes stay zero
+    float32x4_t r = vrsqrteq_f32(a.v);
+    r = vmulq_f32(vrsqrtsq_f32(vmulq_f32(a.v, r), r), r);
+    r = vmulq_f32(vrsqrtsq_f32(vmulq_f32(a.v, r), r), r);
+    uint32x4_t zero = vceqq_f32(a.v, vdupq_n_f32(0.0f));
+    return {vbslq_f32(zero, a.v, vmulq_f32(a.v, r))};
+}
+#endif
+
+inline F4 operator<(F4 a, F4 b) {
+    return {vreinterpretq_f32_u32(vcltq_f32(a.v, b.v))};
+}
+inline F4 operator<=(F4 a, F4 b) {
+    return {vreinterpretq_f32_u32(vcleq_f32(a.v, b.v))};
+}
+inline F4 operator>(F4 a, F4 b) {
+    return {vreinterpretq_f32_u32(vcgtq_f32(a.v, b.v))};
+}
+inline F4 operator>=(F4 a, F4 b) {
+    return {vreinterpretq_f32_u32(vcgeq_f32(a.v, b.v))};
+}
+inline F4 operator&(F4 a, F4 b) {
+    return {vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(a.v), vreinterpretq_u32_f32(b.v)))};
+}
+inline F4 operator|(F4 a, F4 b) {
+    return {vreinterpretq_f32_u32(vorrq_u32(vreinterpretq_u32_f32(a.v), vreinterpretq_u32_f32(b.v)))};
+}
+
+inline F4 f4_select(F4 mask, F4 a, F4 b) {
+    return {vbslq_f32(vreinterpretq_u32_f32(mask.v), a.v, b.v)};
+}
+inline u32 f4_mask(F4 mask) {
+    uint32x4_t bits = vshrq_n_u32(vreinterpretq_u32_f32(mask.v), 31);
+    return vgetq_lane_u32(bits, 0) | (vgetq_lane_u32(bits, 1) << 1) | (vgetq_lane_u32(bits, 2) << 2) |
+           (vgetq_lane_u32(bits, 3) << 3);
+}
+inline void f4_transpose(F4 &a, F4 &b, F4 &c, F4 &d) {
+    float32x4x2_t ab = vtrnq_f32(a.v, b.v), cd = vtrnq_f32(c.v, d.v);
+    a.v = vcombine_f32(vget_low_f32(ab.val[0]), vget_low_f32(cd.val[0]));
+    b.v = vcombine_f32(vget_low_f32(ab.val[1]), vget_low_f32(cd.val[1]));
+    c.v = vcombine_f32(vget_high_f32(ab.val[0]), vget_high_f32(cd.val[0]));
+    d.v = vcombine_f32(vget_high_f32(ab.val[1]), vget_high_f32(cd.val[1]));
+}
+
+#else
+
+inline F4 f4_splat(f32 x) {
+    return {{x, x, x, x}};
+}
+inline F4 f4_set(f32 a, f32 b, f32 c, f32 d) {
+    return {{a, b, c, d}};
+}
+inline F4 f4_load(const f32 *p) {
+    return {{p[0], p[1], p[2], p[3]}};
+}
+inline void f4_store(f32 *p, F4 a) {
+    std::memcpy(p, a.v, sizeof(a.v));
+}
+inline F4 f4_from_i16(const i16 *p) {
+    i16 v[4];
+    std::memcpy(v, p, sizeof(v));
+    return {{(f32)v[0], (f32)v[1], (f32)v[2], (f32)v[3]}};
+}
+
+inline F4 operator+(F4 a, F4 b) {
+    return {{a.v[0] + b.v[0], a.v[1] + b.v[1], a.v[2] + b.v[2], a.v[3] + b.v[3]}};
+}
+inline F4 operator-(F4 a, F4 b) {
+    return {{a.v[0] - b.v[0], a.v[1] - b.v[1], a.v[2] - b.v[2], a.v[3] - b.v[3]}};
+}
+inline F4 operator*(F4 a, F4 b) {
+    return {{a.v[0] * b.v[0], a.v[1] * b.v[1], a.v[2] * b.v[2], a.v[3] * b.v[3]}};
+}
+inline F4 operator/(F4 a, F4 b) {
+    return {{a.v[0] / b.v[0], a.v[1] / b.v[1], a.v[2] / b.v[2], a.v[3] / b.v[3]}};
+}
+inline F4 f4_min(F4 a, F4 b) {
+    F4 r;
+    for (usize i = 0; i < 4; i++) r.v[i] = a.v[i] < b.v[i] ? a.v[i] : b.v[i];
+    return r;
+}
+inline F4 f4_max(F4 a, F4 b) {
+    F4 r;
+    for (usize i = 0; i < 4; i++) r.v[i] = a.v[i] > b.v[i] ? a.v[i] : b.v[i];
+    return r;
+}
+
+inline F4 f4_sqrt(F4 a) {
+    return {{std::sqrt(a.v[0]), std::sqrt(a.v[1]), std::sqrt(a.v[2]), std::sqrt(a.v[3])}};
+}
+
+inline F4 f4_from_bits(const u32 *bits) {
+    F4 r;
+    std::memcpy(r.v, bits, sizeof(r.v));
+    return r;
+}
+inline void f4_to_bits(F4 a, u32 *bits) {
+    std::memcpy(bits, a.v, sizeof(a.v));
+}
+
+inline F4 operator<(F4 a, F4 b) {
+    u32 bits[4];
+    for (usize i = 0; i < 4; i++) bits[i] = a.v[i] < b.v[i] ? ~0u : 0u;
+    return f4_from_bits(bits);
+}
+inline F4 operator<=(F4 a, F4 b) {
+    u32 bits[4];
+    for (usize i = 0; i < 4; i++) bits[i] = a.v[i] <= b.v[i] ? ~0u : 0u;
+    return f4_from_bits(bits);
+}
+inline F4 operator>(F4 a, F4 b) {
+    return b < a;
+}
+inline F4 operator>=(F4 a, F4 b) {
+    return b <= a;
+}
+inline F4 operator&(F4 a, F4 b) {
+    u32 x[4], y[4];
+    f4_to_bits(a, x), f4_to_bits(b, y);
+    for (usize i = 0; i < 4; i++) x[i] &= y[i];
+    return f4_from_bits(x);
+}
+inline F4 operator|(F4 a, F4 b) {
+    u32 x[4], y[4];
+    f4_to_bits(a, x), f4_to_bits(b, y);
+    for (usize i = 0; i < 4; i++) x[i] |= y[i];
+    return f4_from_bits(x);
+}
+
+inline F4 f4_select(F4 mask, F4 a, F4 b) {
+    u32 m[4];
+    f4_to_bits(mask, m);
+    F4 r;
+    for (usize i = 0; i < 4; i++) r.v[i] = m[i] ? a.v[i] : b.v[i];
+    return r;
+}
+inline u32 f4_mask(F4 mask) {
+    u32 m[4];
+    f4_to_bits(mask, m);
+    return (m[0] >> 31) | ((m[1] >> 31) << 1) | ((m[2] >> 31) << 2) | ((m[3] >> 31) << 3);
+}
+inline void f4_transpose(F4 &a, F4 &b, F4 &c, F4 &d) {
+    F4 *rows[4] = {&a, &b, &c, &d};
+    for (usize i = 0; i < 4; i++) {
+        for (usize j = i + 1; j < 4; j++) std::swap(rows[i]->v[j], rows[j]->v[i]);
+    }
+}
+
+#endif
+
+inline F4 f4_abs(F4 a) {
+    return f4_max(a, f4_splat(0.0f) - a);
+}
+
+}; // namespace gltf
@@ -0,0 +1,576 @@
+#include "simplify.hpp"
+#include "accessor.hpp"
+#include "parallel.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+namespace gltf {
+
+enum VertexKind : u8 {
+    KIND_MANIFOLD, // Interior vertex, free to collapse onto any neighbour
+    KIND_BORDER,   // On a single open border, collapses only along the border
+    KIND_SEAM,     // Split into two attribute wedges along a seam, collapses only along the seam
+    KIND_LOCKED,   // Anything more complex, never moves
+};
+
+struct Quadric {
+    f64 a00, a11, a22, a01, a02, a12;
+    f64 b0, b1, b2;
+    f64 c;
+    f64 w;
+
+    void add_plane(f64 nx, f64 ny, f64 nz, f64 d, f64 weight) {
+        a00 += weight * nx * nx;
+        a11 += weight * ny * ny;
+        a22 += weight * nz * nz;
+        a01 += weight * nx * ny;
+        a02 += weight * nx * nz;
+        a12 += weight * ny * nz;
+        b0 += weight * nx * d;
+        b1 += weight * ny * d;
+        b2 += weight * nz * d;
+        c += weight * d * d;
+        w += weight;
+    }
+
+    void add(const Quadric &q) {
+        a00 += q.a00;
+        a11 += q.a11;
+        a22 += q.a22;
+        a01 += q.a01;
+        a02 += q.a02;
+        a12 += q.a12;
+        b0 += q.b0;
+        b1 += q.b1;
+        b2 += q.b2;
+        c += q.c;
+        w += q.w;
+    }
+
+    // Weighted squared distance of `p` to the accumulated planes
+    f64 error(const f32 *p) const {
+        f64 x = p[0], y = p[1], z = p[2];
+        f64 r = a00 * x * x + a11 * y * y + a22 * z * z + 2 * (a01 * x * y + a02 * x * z + a12 * y * z) +
+                2 * (b0 * x + b1 * y + b2 * z) + c;
+        return w > 0 ? std::fabs(r) / w : 0.0;
+    }
+};
+
+struct Collapse {
+    u32 v0;
+    u32 v1;
+    f64 error;
+};
+
+struct SimplifyMesh {
+    const f32 *positions;
+    usize vertex_count;
+
+    std::vector<u32> remap; // Canonical vertex sharing the same position
+    std::vector<u32> wedge; // Circular list of vertices sharing the same position
+    std::vector<u8> kind;
+    std::vector<u32> loop_out; // Open half-edge leaving the vertex (UINT32_MAX if none)
+    std::vector<u32> loop_in;  // Open half-edge entering the vertex (UINT32_MAX if none)
+
+    // Vertex -> triangle adjacency of the current index buffer
+    std::vector<u32> tri_offsets;
+    std::vector<u32> tri_list;
+
+    const f32 *pos(u32 v) const {
+        return positions + v * 3;
+    }
+};
+
+static u32 hash_position(const f32 *p) {
+    u32 bits[3];
+    std::memcpy(bits, p, sizeof(bits));
+    return (bits[0] * 73856093u) ^ (bits[1] * 19349663u) ^ (bits[2] * 83492791u);
+}
+
+static void build_position_remap(SimplifyMesh &mesh) {
+    usize capacity = 1;
+    while (capacity < mesh.vertex_count * 2) capacity <<= 1;
+    std::vector<u32> table(capacity, UINT32_MAX);
+
+    mesh.remap.resize(mesh.vertex_count);
+    mesh.wedge.resize(mesh.vertex_count);
+
+    for (usize v = 0; v < mesh.vertex_count; v++) {
+        usize slot = hash_position(mesh.pos((u32)v)) & (capacity - 1);
+        while (table[slot] != UINT32_MAX && std::memcmp(mesh.pos(table[slot]), mesh.pos((u32)v), 12) != 0) {
+            slot = (slot + 1) & (capacity - 1);
+        }
+        if (table[slot] == UINT32_MAX) table[slot] = (u32)v;
+
+        u32 r = table[slot];
+        mesh.remap[v] = r;
+        mesh.wedge[v] = (u32)v;
+        if (r != v) {
+            mesh.wedge[v] = mesh.wedge[r];
+            mesh.wedge[r] = (u32)v;
+        }
+    }
+}
+
+static void build_triangle_adjacency(SimplifyMesh &mesh, const u32 *indices, usize index_count) {
+    mesh.tri_offsets.assign(mesh.vertex_count + 1, 0);
+    for (usize i = 0; i < index_count; i++) mesh.tri_offsets[indices[i] + 1]++;
+    for (usize v = 0; v < mesh.vertex_count; v++) mesh.tri_offsets[v + 1] += mesh.tri_offsets[v];
+
+    mesh.tri_list.resize(index_count);
+    std::vector<u32> fill(mesh.tri_offsets.begin(), mesh.tri_offsets.end() - 1);
+    for (usize i = 0; i < index_count; i++) mesh.tri_list[fill[indices[i]]++] = (u32)(i / 3);
+}
+
+static bool has_edge(const SimplifyMesh &mesh, const u32 *indices, u32 a, u32 b) {
+    for (u32 i = mesh.tri_offsets[a]; i < mesh.tri_offsets[a + 1]; i++) {
+        const u32 *tri = indices + mesh.tri_list[i] * 3;
+        for (usize k = 0; k < 3; k++) {
+            if (tri[k] == a && tri[(k + 1) % 3] == b) return true;
+        }
+    }
+    return false;
+}
+
+static void classify_vertices(SimplifyMesh &mesh, const u32 *indices, usize index_count, bool lock_border) {
+    // An open half-edge has no opposite half-edge in vertex space; a vertex with several is marked by pointing at itself
+    mesh.loop_out.assign(mesh.vertex_count, UINT32_MAX);
+    mesh.loop_in.assign(mesh.vertex_count, UINT32_MAX);
+
+    for (usize t = 0; t < index_count / 3; t++) {
+        for (usize k = 0; k < 3; k++) {
+            u32 a = indices[t * 3 + k];
+            u32 b = indices[t * 3 + (k + 1) % 3];
+            if (has_edge(mesh, indices, b, a)) continue;
+
+            mesh.loop_out[a] = mesh.loop_out[a] == UINT32_MAX ? b : a;
+            mesh.loop_in[b] = mesh.loop_in[b] == UINT32_MAX ? a : b;
+        }
+    }
+
+    mesh.kind.assign(mesh.vertex_count, KIND_LOCKED);
+    for (usize i = 0; i < mesh.vertex_count; i++) {
+        u32 v = (u32)i;
+        u32 out = mesh.loop_out[v];
+        u32 in = mesh.loop_in[v];
+        bool single_loop = out != UINT32_MAX && in != UINT32_MAX && out != v && in != v;
+
+        if (mesh.wedge[v] == v) {
+            if (out == UINT32_MAX && in == UINT32_MAX) {
+                mesh.kind[v] = KIND_MANIFOLD;
+            } else if (single_loop) {
+                mesh.kind[v] = lock_border ? KIND_LOCKED : KIND_BORDER;
+            }
+        } else if (mesh.wedge[mesh.wedge[v]] == v) {
+            // Two wedges form a seam when their open edges are opposite to each other in position space
+            u32 w = mesh.wedge[v];
+            u32 w_out = mesh.loop_out[w];
+            u32 w_in = mesh.loop_in[w];
+            bool w_single = w_out != UINT32_MAX && w_in != UINT32_MAX && w_out != w && w_in != w;
+
+            if (single_loop && w_single && mesh.remap[out] == mesh.remap[w_in] && mesh.remap[in] == mesh.remap[w_out]) {
+                mesh.kind[v] = KIND_SEAM;
+            }
+        }
+    }
+
+    for (usize v = 0; v < mesh.vertex_count; v++) {
+        if (mesh.loop_out[v] == v) mesh.loop_out[v] = UINT32_MAX;
+        if (mesh.loop_in[v] == v) mesh.loop_in[v] = UINT32_MAX;
+    }
+}
+
+static void build_quadrics(const SimplifyMesh &mesh, const u32 *indices, usize index_count,
+                           std::vector<Quadric> &quadrics) {
+    Quadric zero;
+    std::memset(&zero, 0, sizeof(zero));
+    quadrics.assign(mesh.vertex_count, zero);
+
+    for (usize t = 0; t < index_count / 3; t++) {
+        const u32 *tri = indices + t * 3;
+        const f32 *p0 = mesh.pos(tri[0]);
+        const f32 *p1 = mesh.pos(tri[1]);
+        const f32 *p2 = mesh.pos(tri[2]);
+
+        f64 e1[3] = {(f64)p1[0] - p0[0], (f64)p1[1] - p0[1], (f64)p1[2] - p0[2]};
+        f64 e2[3] = {(f64)p2[0] - p0[0], (f64)p2[1] - p0[1], (f64)p2[2] - p0[2]};
+        f64 n[3] = {e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0]};
+        f64 length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+        if (length <= 0.0) continue;
+
+        n[0] /= length;
+        n[1] /= length;
+        n[2] /= length;
+        f64 d = -(n[0] * p0[0] + n[1] * p0[1] + n[2] * p0[2]);
+
+        for (usize k = 0; k < 3; k++) {
+            quadrics[mesh.remap[tri[k]]].add_plane(n[0], n[1], n[2], d, length * 0.5);
+        }
+
+        // Open edges (borders and seams) get a strong perpendicular plane so they keep their shape
+        for (usize k = 0; k < 3; k++) {
+            u32 a = tri[k];
+            u32 b = tri[(k + 1) % 3];
+            if (mesh.loop_out[a] != b) continue;
+
+            const f32 *pa = mesh.pos(a);
+            const f32 *pb = mesh.pos(b);
+            f64 e[3] = {(f64)pb[0] - pa[0], (f64)pb[1] - pa[1], (f64)pb[2] - pa[2]};
+            f64 p[3] = {e[1] * n[2] - e[2] * n[1], e[2] * n[0] - e[0] * n[2], e[0] * n[1] - e[1] * n[0]};
+            f64 p_length = std::sqrt(p[0] * p[0] + p[1] * p[1] + p[2] * p[2]);
+            if (p_length <= 0.0) continue;
+
+            p[0] /= p_length;
+            p[1] /= p_length;
+            p[2] /= p_length;
+            f64 pd = -(p[0] * pa[0] + p[1] * pa[1] + p[2] * pa[2]);
+            f64 weight = (e[0] * e[0] + e[1] * e[1] + e[2] * e[2]) * 10.0;
+
+            quadrics[mesh.remap[a]].add_plane(p[0], p[1], p[2], pd, weight);
+            quadrics[mesh.remap[b]].add_plane(p[0], p[1], p[2], pd, weight);
+        }
+    }
+}
+
+// For a seam collapse v0 -> v1, the wedge on the other side of the seam must follow to the matching wedge of v1
+static u32 seam_sibling(const SimplifyMesh &mesh, u32 v0, u32 v1) {
+    u32 s0 = mesh.wedge[v0];
+    u32 s1 = UINT32_MAX;
+    if (mesh.loop_out[v0] == v1) s1 = mesh.loop_in[s0];
+    if (mesh.loop_in[v0] == v1) s1 = mesh.loop_out[s0];
+
+    if (s1 == UINT32_MAX || mesh.remap[s1] != mesh.remap[v1] || mesh.kind[s1] != KIND_SEAM) return UINT32_MAX;
+    return s1;
+}
+
+static bool can_collapse(const SimplifyMesh &mesh, u32 v0, u32 v1) {
+    switch (mesh.kind[v0]) {
+    case KIND_MANIFOLD:
+        return true;
+    case KIND_BORDER:
+        return mesh.kind[v1] == KIND_BORDER && (mesh.loop_out[v0] == v1 || mesh.loop_in[v0] == v1);
+    case KIND_SEAM:
+        return mesh.kind[v1] == KIND_SEAM && (mesh.loop_out[v0] == v1 || mesh.loop_in[v0] == v1) &&
+               seam_sibling(mesh, v0, v1) != UINT32_MAX;
+    default:
+        return false;
+    }
+}
+
+// Moving every wedge of v0 onto v1 must not flip any triangle that survives the collapse
+static bool collapse_flips(const SimplifyMesh &mesh, const u32 *indices, u32 v0, u32 v1) {
+    const f32 *target = mesh.pos(v1);
+    u32 r1 = mesh.remap[v1];
+
+    u32 w = v0;
+    do {
+        for (u32 i = mesh.tri_offsets[w]; i < mesh.tri_offsets[w + 1]; i++) {
+            const u32 *tri = indices + mesh.tri_list[i] * 3;
+            usize k = tri[0] == w ? 0 : tri[1] == w ? 1 : 2;
+            u32 a = tri[(k + 1) % 3];
+            u32 b = tri[(k + 2) % 3];
+            if (mesh.remap[a] == r1 || mesh.remap[b] == r1) continue;
+
+            const f32 *p = mesh.pos(w);
+            const f32 *pa = mesh.pos(a);
+            const f32 *pb = mesh.pos(b);
+
+            f32 e1[3] = {pa[0] - p[0], pa[1] - p[1], pa[2] - p[2]};
+            f32 e2[3] = {pb[0] - p[0], pb[1] - p[1], pb[2] - p[2]};
+            f32 n0[3] = {e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0]};
+
+            f32 f1[3] = {pa[0] - target[0], pa[1] - target[1], pa[2] - target[2]};
+            f32 f2[3] = {pb[0] - target[0], pb[1] - target[1], pb[2] - target[2]};
+            f32 n1[3] = {f1[1] * f2[2] - f1[2] * f2[1], f1[2] * f2[0] - f1[0] * f2[2], f1[0] * f2[1] - f1[1] * f2[0]};
+
+            if (n0[0] * n1[0] + n0[1] * n1[1] + n0[2] * n1[2] <= 0.0f) return true;
+        }
+        w = mesh.wedge[w];
+    } while (w != v0);
+
+    return false;
+}
+
+static void pick_collapses(const SimplifyMesh &mesh, const u32 *indices, usize index_count,
+                           const std::vector<Quadric> &quadrics, std::vector<Collapse> &collapses) {
+    collapses.clear();
+
+    for (usize t = 0; t < index_count / 3; t++) {
+        for (usize k = 0; k < 3; k++) {
+            u32 i0 = indices[t * 3 + k];
+            u32 i1 = indices[t * 3 + (k + 1) % 3];
+
+            // Interior edges are seen from both triangles, only one of them needs to produce a candidate
+            if (i0 > i1 && has_edge(mesh, indices, i1, i0)) continue;
+
+            bool can01 = can_collapse(mesh, i0, i1);
+            bool can10 = can_collapse(mesh, i1, i0);
+            if (!can01 && !can10) continue;
+
+            f64 e01 = can01 ? quadrics[mesh.remap[i0]].error(mesh.pos(i1)) : HUGE_VAL;
+            f64 e10 = can10 ? quadrics[mesh.remap[i1]].error(mesh.pos(i0)) : HUGE_VAL;
+
+            Collapse collapse;
+            collapse.v0 = e01 <= e10 ? i0 : i1;
+            collapse.v1 = e01 <= e10 ? i1 : i0;
+            collapse.error = std::min(e01, e10);
+            collapses.push_back(collapse);
+        }
+    }
+
+    std::sort(collapses.begin(), collapses.end(),
+              [](const Collapse &a, const Collapse &b) { return a.error < b.error; });
+}
+
+static void remap_loop(std::vector<u32> &loop, const std::vector<u32> &collapse_remap) {
+    for (usize i = 0; i < loop.size(); i++) {
+        u32 l = loop[i];
+        if (l == UINT32_MAX) continue;
+
+        // The loop target collapsed onto this vertex, so the loop now continues past it
+        u32 r = collapse_remap[l];
+        loop[i] = r == i ? (loop[l] != UINT32_MAX ? collapse_remap[loop[l]] : UINT32_MAX) : r;
+    }
+}
+
+usize simplify(u32 *destination, const u32 *indices, usize index_count, const f32 *positions, usize vertex_count,
+               usize target_index_count, f32 target_error, bool lock_border, f32 *result_error) {
+    index_count -= index_count % 3;
+    std::copy(indices, indices + index_count, destination);
+    if (result_error) *result_error = 0.0f;
+
+    for (usize i = 0; i < index_count; i++) {
+        if (indices[i] >= vertex_count) return index_count;
+    }
+
+    SimplifyMesh mesh;
+    mesh.positions = positions;
+    mesh.vertex_count = vertex_count;
+
+    build_position_remap(mesh);
+    build_triangle_adjacency(mesh, destination, index_count);
+    classify_vertices(mesh, destination, index_count, lock_border);
+
+    std::vector<Quadric> quadrics;
+    build_quadrics(mesh, destination, index_count, quadrics);
+
+    // Errors are squared distances, the limit is relative to the mesh extent
+    f32 extent = 0.0f;
+    if (vertex_count > 0) {
+        f32 lo[3] = {positions[0], positions[1], positions[2]};
+        f32 hi[3] = {positions[0], positions[1], positions[2]};
+        for (usize v = 0; v < vertex_count; v++) {
+            for (usize k = 0; k < 3; k++) {
+                lo[k] = std::min(lo[k], positions[v * 3 + k]);
+                hi[k] = std::max(hi[k], positions[v * 3 + k]);
+            }
+        }
+        extent = std::max(hi[0] - lo[0], std::max(hi[1] - lo[1], hi[2] - lo[2]));
+    }
+    f64 limit = (f64)target_error * extent * target_error * extent;
+    f64 max_error = 0.0;
+
+    std::vector<Collapse> collapses;
+    std::vector<u32> collapse_remap(vertex_count);
+    std::vector<u8> locked(vertex_count);
+
+    while (index_count > target_index_count) {
+        build_triangle_adjacency(mesh, destination, index_count);
+        pick_collapses(mesh, destination, index_count, quadrics, collapses);
+
+        for (usize v = 0; v < vertex_count; v++) collapse_remap[v] = (u32)v;
+        std::fill(locked.begin(), locked.end(), 0);
+
+        usize triangles_to_remove = (index_count - target_index_count + 2) / 3;
+        usize removed = 0;
+
+        for (const Collapse &collapse : collapses) {
+            if (collapse.error > limit || removed >= triangles_to_remove) break;
+
+            u32 v0 = collapse.v0;
+            u32 v1 = collapse.v1;
+            u32 r0 = mesh.remap[v0];
+            u32 r1 = mesh.remap[v1];
+            if (locked[r0] || locked[r1]) continue;
+            if (collapse_flips(mesh, destination, v0, v1)) continue;
+
+            if (mesh.kind[v0] == KIND_SEAM) {
+                u32 s0 = mesh.wedge[v0];
+                collapse_remap[s0] = seam_sibling(mesh, v0, v1);
+            }
+            collapse_remap[v0] = v1;
+            quadrics[r1].add(quadrics[r0]);
+
+            // Lock the whole one-ring so neighbouring collapses in this pass see up to date geometry
+            u32 w = v0;
+            do {
+                for (u32 i = mesh.tri_offsets[w]; i < mesh.tri_offsets[w + 1]; i++) {
+                    const u32 *tri = destination + mesh.tri_list[i] * 3;
+                    bool collapsing = false;
+                    for (usize k = 0; k < 3; k++) {
+                        locked[mesh.remap[tri[k]]] = 1;
+                        collapsing |= mesh.remap[tri[k]] == r1;
+                    }
+                    if (collapsing) removed++;
+                }
+                w = mesh.wedge[w];
+            } while (w != v0);
+
+            max_error = std::max(max_error, collapse.error);
+        }
+
+        if (removed == 0) break;
+
+        remap_loop(mesh.loop_out, collapse_remap);
+        remap_loop(mesh.loop_in, collapse_remap);
+
+        usize write = 0;
+        for (usize t = 0; t < index_count / 3; t++) {
+            u32 a = collapse_remap[destination[t * 3 + 0]];
+            u32 b = collapse_remap[destination[t * 3 + 1]];
+            u32 c = collapse_remap[destination[t * 3 + 2]];
+            u32 ra = mesh.remap[a], rb = mesh.remap[b], rc = mesh.remap[c];
+            if (ra == rb || rb == rc || rc == ra) continue;
+
+            destination[write++] = a;
+            destination[write++] = b;
+            destination[write++] = c;
+        }
+        index_count = write;
+    }
+
+    if (result_error && extent > 0.0f) *result_error = (f32)(std::sqrt(max_error) / extent);
+    return index_count;
+}
+
+static bool simplify_indices(const Model &model, const Primitive &primitive, const SimplifyOptions &options,
+                             std::vector<u32> &out, f32 *result_error) {
+    auto position = primitive.attributes.find("POSITION");
+    std::vector<f32> positions;
+    if (position == primitive.attributes.end() || position->second >= model.accessors.size() ||
+        model.accessors[position->second].type != "VEC3" || !read_floats(model, position->second, positions)) {
+        std::cerr << "Cannot simplify: primitive has no readable VEC3 POSITION attribute" << std::endl;
+        return false;
+    }
+
+    std::vector<u32> indices;
+    if (!read_indices(model, primitive.indices, positions.size() / 3, indices)) {
+        std::cerr << "Cannot simplify: index accessor has no readable data" << std::endl;
+        return false;
+    }
+
+    usize target = (usize)(indices.size() / 3 * std::max(std::min(options.target_ratio, 1.0f), 0.0f)) * 3;
+    out.resize(indices.size());
+    out.resize(simplify(out.data(), indices.data(), indices.size(), positions.data(), positions.size() / 3, target,
+                        options.target_error, options.lock_border, result_error));
+    return true;
+}
+
+bool simplify_primitive(Model &model, const Primitive &source, Primitive &out, const SimplifyOptions &options,
+                        f32 *result_error) {
+    if (source.mode != 4) {
+        std::cerr << "Cannot simplify: only TRIANGLES primitives are supported" << std::endl;
+        return false;
+    }
+
+    std::vector<u32> indices;
+    if (!simplify_indices(model, source, options, indices, result_error)) return false;
+
+    out = source;
+    out.indices = add_index_accessor(model, indices, (u32)primitive_vertex_count(model, source));
+    return true;
+}
+
+bool generate_lods(Model &model, const LodOptions &options, std::vector<std::vector<u32>> *lod_meshes) {
+    struct LodJob {
+        u32 mesh;
+        u32 primitive;
+        usize level;
+        std::vector<u32> indices;
+        bool ok;
+    };
+
+    std::vector<LodJob> jobs;
+    for (usize m = 0; m < model.meshes.size(); m++) {
+        for (usize level = 0; level < options.ratios.size(); level++) {
+            for (usize p = 0; p < model.meshes[m].primitives.size(); p++) {
+                if (model.meshes[m].primitives[p].mode != 4) continue;
+
+                LodJob job;
+                job.mesh = (u32)m;
+                job.primitive = (u32)p;
+                job.level = level;
+                job.ok = false;
+                jobs.push_back(job);
+            }
+        }
+    }
+
+    parallel_for(jobs.size(), [&](usize i) {
+        LodJob &job = jobs[i];
+        SimplifyOptions simplify_options;
+        simplify_options.target_ratio = options.ratios[job.level];
+        simplify_options.target_error = options.target_error;
+        simplify_options.lock_border = options.lock_border;
+
+        job.ok = simplify_indices(model, model.meshes[job.mesh].primitives[job.primitive], simplify_options,
+                                  job.indices, nullptr);
+    });
+
+    // Model storage is only appended to once all simplification work is done
+    usize mesh_count = model.meshes.size();
+    std::vector<std::vector<u32>> levels(mesh_count);
+    bool success = true;
+
+    usize next_job = 0;
+    for (usize m = 0; m < mesh_count; m++) {
+        for (usize level = 0; level < options.ratios.size(); level++) {
+            Mesh lod = model.meshes[m];
+            lod.name = model.meshes[m].name.empty() ? "" : model.meshes[m].name + "_LOD" + std::to_string(level + 1);
+
+            for (usize p = 0; p < lod.primitives.size(); p++) {
+                if (lod.primitives[p].mode != 4) continue;
+
+                const LodJob &job = jobs[next_job++];
+                if (!job.ok) {
+                    success = false;
+                    continue;
+                }
+
+                u32 vertex_count = (u32)primitive_vertex_count(model, lod.primitives[p]);
+                lod.primitives[p].indices = add_index_accessor(model, job.indices, vertex_count);
+            }
+
+            model.meshes.push_back(lod);
+            levels[m].push_back((u32)(model.meshes.size() - 1));
+        }
+    }
+
+    if (options.msft_lod) {
+        usize node_count = model.nodes.size();
+        for (usize n = 0; n < node_count; n++) {
+            if (model.nodes[n].mesh >= mesh_count) continue;
+
+            std::vector<u32> ids;
+            for (usize level = 0; level < levels[model.nodes[n].mesh].size(); level++) {
+                Node lod = model.nodes[n];
+                lod.mesh = levels[model.nodes[n].mesh][level];
+                lod.children.clear();
+                lod.lods.clear();
+                lod.name = lod.name.empty() ? "" : lod.name + "_LOD" + std::to_string(level + 1);
+
+                model.nodes.push_back(lod);
+                ids.push_back((u32)(model.nodes.size() - 1));
+            }
+
+            model.nodes[n].lods = ids;
+        }
+    }
+
+    if (lod_meshes) *lod_meshes = levels;
+    return success;
+}
+
+}; // namespace gltf
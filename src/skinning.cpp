@@ -0,0 +1,459 @@
+#include "skinning.hpp"
+#include "accessor.hpp"
+#include "math.hpp"
+#include "parallel.hpp"
+#include "simd.hpp"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <string>
+
+namespace gltf {
+
+// Vertices are skinned in blocks of this many per worker task
+static const usize BLOCK_SIZE = 2048;
+
+template <typename F> static void blocks(usize count, F fn) {
+    parallel_for((count + BLOCK_SIZE - 1) / BLOCK_SIZE,
+                 [&](usize b) { fn(b * BLOCK_SIZE, std::min(count, (b + 1) * BLOCK_SIZE)); });
+}
+
+// Floats per joint in JointPalette::dual_quaternions
+static const usize DUAL_QUATERNION_FLOATS = 12;
+
+// Splits every palette matrix into T * R * S and stores R with the dual part 0.5 * (t, 0) * R, then S
+static void update_dual_quaternions(JointPalette &palette) {
+    palette.dual_quaternions.resize(palette.matrices.size() * DUAL_QUATERNION_FLOATS);
+    for (usize j = 0; j < palette.matrices.size(); j++) {
+        Vec3 translation, scale;
+        Vec4 rotation;
+        decompose_trs(palette.matrices[j], translation, rotation, scale);
+        Vec4 dual = quat_multiply({translation.x, translation.y, translation.z, 0.0f}, rotation);
+
+        f32 *out = &palette.dual_quaternions[j * DUAL_QUATERNION_FLOATS];
+        std::copy_n(&rotation.x, 4, out);
+        f4_store(out + 4, f4_load(&dual.x) * f4_splat(0.5f));
+        std::copy_n(&scale.x, 3, out + 8);
+        out[11] = 0.0f;
+    }
+}
+
+bool build_joint_palette(const Model &model, u32 skin, JointPalette &palette, bool dual_quaternions) {
+    palette = JointPalette();
+    if (skin >= model.skins.size()) {
+        std::cerr << "Cannot build joint palette: skin " << skin << " does not exist" << std::endl;
+        return false;
+    }
+
+    const Skin &source = model.skins[skin];
+    for (u32 node : source.joints) {
+        if (node >= model.nodes.size()) {
+            std::cerr << "Cannot build joint palette: joint node " << node << " of skin " << skin
+                      << " does not exist" << std::endl;
+            return false;
+        }
+    }
+
+    usize joint_count = source.joints.size();
+    palette.inverse_binds.assign(joint_count, Mat4::identify());
+    if (source.inverse_bind_matrices != UINT32_MAX) {
+        std::vector<f32> values;
+        if (source.inverse_bind_matrices >= model.accessors.size() ||
+            model.accessors[source.inverse_bind_matrices].type != "MAT4" ||
+            !read_floats(model, source.inverse_bind_matrices, values) || values.size() < joint_count * 16) {
+            std::cerr << "Cannot build joint palette: skin " << skin
+                      << " has no readable MAT4 inverse bind matrix per joint" << std::endl;
+            return false;
+        }
+        for (usize j = 0; j < joint_count; j++) std::copy_n(&values[j * 16], 16, palette.inverse_binds[j].m);
+    }
+
+    palette.skin = skin;
+    palette.joints = source.joints;
+    palette.matrices.assign(joint_count, Mat4::identify());
+    if (dual_quaternions) {
+        palette.dual_quaternions.assign(joint_count * DUAL_QUATERNION_FLOATS, 0.0f);
+        update_dual_quaternions(palette);
+    }
+    return true;
+}
+
+bool update_joint_palette(JointPalette &palette, const std::vector<Mat4> &worlds, u32 mesh_node) {
+    usize joint_count = palette.joints.size();
+    for (u32 node : palette.joints) {
+        if (node >= worlds.size()) {
+            std::cerr << "Cannot update joint palette: no world matrix for joint node " << node << std::endl;
+            return false;
+        }
+    }
+
+    palette.matrices.resize(joint_count);
+    for (usize j = 0; j < joint_count; j++) palette.matrices[j] = worlds[palette.joints[j]];
+    mat4_multiply_batch(palette.matrices.data(), palette.inverse_binds.data(), palette.matrices.data(), joint_count);
+
+    if (mesh_node != UINT32_MAX) {
+        Mat4 to_mesh;
+        if (mesh_node >= worlds.size() || !mat4_affine_inverse(worlds[mesh_node], to_mesh)) {
+            std::cerr << "Cannot update joint palette: mesh node " << mesh_node << " has no invertible world matrix"
+                      << std::endl;
+            return false;
+        }
+        for (Mat4 &matrix : palette.matrices) matrix = mat4_multiply(to_mesh, matrix);
+    }
+    if (!palette.dual_quaternions.empty()) update_dual_quaternions(palette);
+    return true;
+}
+
+// Reads a float attribute of `components` per vertex, leaving `out` empty when the primitive does not have it
+static bool read_vertex_attribute(const Model &model, const Primitive &primitive, const std::string &name,
+                                  usize components, usize vertex_count, std::vector<f32> &out) {
+    out.clear();
+    auto attribute = primitive.attributes.find(name);
+    if (attribute == primitive.attributes.end()) return true;
+
+    if (attribute->second >= model.accessors.size() ||
+        component_count(model.accessors[attribute->second].type) != components ||
+        !read_floats(model, attribute->second, out) || out.size() != vertex_count * components) {
+        std::cerr << "Cannot bind skinned primitive: " << name << " attribute is not readable" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// Copies four influences per vertex of one JOINTS_n / WEIGHTS_n pair into the binding, starting at influence `first`
+static bool read_influences(const Model &model, u32 joints, u32 weights, u32 first, SkinBinding &binding) {
+    AccessorView joint_view, weight_view;
+    if (!view_accessor(model, joints, joint_view) || !view_accessor(model, weights, weight_view) ||
+        joint_view.components != 4 || weight_view.components != 4 || joint_view.count != binding.vertex_count ||
+        weight_view.count != binding.vertex_count) {
+        std::cerr << "Cannot bind skinned primitive: JOINTS / WEIGHTS attributes are not readable VEC4 per vertex"
+                  << std::endl;
+        return false;
+    }
+
+    for (usize v = 0; v < binding.vertex_count; v++) {
+        f32 j[4], w[4];
+        read_components(joint_view.element(v), joint_view.component_type, false, 4, j);
+        read_components(weight_view.element(v), weight_view.component_type, weight_view.normalized, 4, w);
+        for (usize k = 0; k < 4; k++) {
+            usize slot = v * binding.influences + first + k;
+            binding.joints[slot] = j[k] > 0.0f ? (u32)(j[k] + 0.5f) : 0;
+            binding.weights[slot] = std::max(w[k], 0.0f);
+        }
+    }
+    return true;
+}
+
+bool bind_skinned_primitive(const Model &model, const Primitive &primitive, SkinBinding &binding) {
+    binding = SkinBinding();
+
+    auto position = primitive.attributes.find("POSITION");
+    if (position == primitive.attributes.end() || position->second >= model.accessors.size()) {
+        std::cerr << "Cannot bind skinned primitive: primitive has no POSITION attribute" << std::endl;
+        return false;
+    }
+    usize vertex_count = model.accessors[position->second].count;
+
+    std::vector<f32> positions, normals, tangents;
+    if (!read_vertex_attribute(model, primitive, "POSITION", 3, vertex_count, positions) ||
+        !read_vertex_attribute(model, primitive, "NORMAL", 3, vertex_count, normals) ||
+        !read_vertex_attribute(model, primitive, "TANGENT", 4, vertex_count, tangents)) {
+        return false;
+    }
+
+    u32 sets = 0;
+    while (primitive.attributes.count("JOINTS_" + std::to_string(sets)) &&
+           primitive.attributes.count("WEIGHTS_" + std::to_string(sets))) {
+        sets++;
+    }
+    if (sets == 0) {
+        std::cerr << "Cannot bind skinned primitive: primitive has no JOINTS_0 / WEIGHTS_0 attributes" << std::endl;
+        return false;
+    }
+
+    binding.vertex_count = vertex_count;
+    binding.influences = sets * 4;
+    binding.joints.resize(vertex_count * binding.influences);
+    binding.weights.resize(vertex_count * binding.influences);
+    for (u32 s = 0; s < sets; s++) {
+        if (!read_influences(model, primitive.attributes.at("JOINTS_" + std::to_string(s)),
+                             primitive.attributes.at("WEIGHTS_" + std::to_string(s)), s * 4, binding)) {
+            binding = SkinBinding();
+            return false;
+        }
+    }
+
+    // Quantized weights rarely sum to exactly 1. Unused influences point at joint 0 so the kernels can load them
+    // without bounds checks. The heaviest influence comes first, as the hemisphere reference of dual quaternion
+    // blending, and trailing zero weights let the kernels skip influences.
+    for (usize v = 0; v < vertex_count; v++) {
+        u32 *joints = &binding.joints[v * binding.influences];
+        f32 *weights = &binding.weights[v * binding.influences];
+        for (u32 k = 1; k < binding.influences; k++) {
+            for (u32 i = k; i > 0 && weights[i] > weights[i - 1]; i--) {
+                std::swap(weights[i], weights[i - 1]);
+                std::swap(joints[i], joints[i - 1]);
+            }
+        }
+
+        f32 total = 0.0f;
+        for (u32 k = 0; k < binding.influences; k++) total += weights[k];
+        if (total <= 0.0f) {
+            weights[0] = 1.0f;
+            total = 1.0f;
+        }
+        for (u32 k = 0; k < binding.influences; k++) {
+            weights[k] /= total;
+            if (weights[k] == 0.0f) joints[k] = 0;
+            binding.joint_count = std::max(binding.joint_count, joints[k] + 1);
+        }
+    }
+
+    binding.positions.resize(vertex_count);
+    std::copy(positions.begin(), positions.end(), &binding.positions[0].x);
+    if (!normals.empty()) {
+        binding.normals.resize(vertex_count);
+        std::copy(normals.begin(), normals.end(), &binding.normals[0].x);
+    }
+    if (!tangents.empty()) {
+        binding.tangents.resize(vertex_count);
+        std::copy(tangents.begin(), tangents.end(), &binding.tangents[0].x);
+    }
+    return true;
+}
+
+// Weighted sum of the palette matrices of vertex `v`, as four columns
+static inline void blend_matrix(const SkinBinding &binding, const Mat4 *palette, usize v, F4 &c0, F4 &c1, F4 &c2,
+                                F4 &c3) {
+    const u32 *joints = &binding.joints[v * binding.influences];
+    const f32 *weights = &binding.weights[v * binding.influences];
+
+    const Mat4 &first = palette[joints[0]];
+    F4 w = f4_splat(weights[0]);
+    c0 = f4_load(first.cols[0]) * w;
+    c1 = f4_load(first.cols[1]) * w;
+    c2 = f4_load(first.cols[2]) * w;
+    c3 = f4_load(first.cols[3]) * w;
+    for (u32 k = 1; k < binding.influences; k++) {
+        if (weights[k] == 0.0f) continue;
+        const Mat4 &matrix = palette[joints[k]];
+        w = f4_splat(weights[k]);
+        c0 = c0 + f4_load(matrix.cols[0]) * w;
+        c1 = c1 + f4_load(matrix.cols[1]) * w;
+        c2 = c2 + f4_load(matrix.cols[2]) * w;
+        c3 = c3 + f4_load(matrix.cols[3]) * w;
+    }
+}
+
+static inline void store_direction(F4 r, f32 *out) {
+    f32 values[4];
+    f4_store(values, r);
+    f32 length = std::sqrt(values[0] * values[0] + values[1] * values[1] + values[2] * values[2]);
+    f32 scale = length > 1e-20f ? 1.0f / length : 0.0f;
+    out[0] = values[0] * scale;
+    out[1] = values[1] * scale;
+    out[2] = values[2] * scale;
+}
+
+static bool check_skinning(const SkinBinding &binding, const JointPalette &palette, SkinnedVertices &out) {
+    if (binding.joint_count > palette.matrices.size()) {
+        std::cerr << "Cannot skin vertices: binding references joint " << binding.joint_count - 1
+                  << " but the palette has " << palette.matrices.size() << " joints" << std::endl;
+        return false;
+    }
+
+    out.positions.resize(binding.vertex_count);
+    out.normals.resize(binding.normals.size());
+    out.tangents.resize(binding.tangents.size());
+    return true;
+}
+
+bool skin_vertices(const SkinBinding &binding, const JointPalette &palette, SkinnedVertices &out) {
+    if (!check_skinning(binding, palette, out)) return false;
+
+    const Mat4 *matrices = palette.matrices.data();
+    bool has_normals = !binding.normals.empty(), has_tangents = !binding.tangents.empty();
+
+    // Writes all four lanes of the skinned position to `position`; normals and tangents are stored directly
+    auto skin_vertex = [&](usize v, f32 *position) {
+        F4 c0, c1, c2, c3;
+        blend_matrix(binding, matrices, v, c0, c1, c2, c3);
+
+        const Vec3 &p = binding.positions[v];
+        f4_store(position, c0 * f4_splat(p.x) + c1 * f4_splat(p.y) + c2 * f4_splat(p.z) + c3);
+        if (has_normals) {
+            const Vec3 &n = binding.normals[v];
+            store_direction(c0 * f4_splat(n.x) + c1 * f4_splat(n.y) + c2 * f4_splat(n.z), &out.normals[v].x);
+        }
+        if (has_tangents) {
+            const Vec4 &t = binding.tangents[v];
+            store_direction(c0 * f4_splat(t.x) + c1 * f4_splat(t.y) + c2 * f4_splat(t.z), &out.tangents[v].x);
+            out.tangents[v].w = t.w;
+        }
+    };
+
+    blocks(binding.vertex_count, [&](usize begin, usize end) {
+        // Four positions are staged 3 floats apart, each spare lane being overwritten by the next vertex, and go out
+        // as three 16-byte stores covering exactly those four Vec3s
+        usize v = begin;
+        for (; v + 4 <= end; v += 4) {
+            f32 packed[16];
+            for (usize k = 0; k < 4; k++) skin_vertex(v + k, packed + k * 3);
+
+            f32 *po = &out.positions[v].x;
+            for (usize k = 0; k < 3; k++) f4_store(po + k * 4, f4_load(packed + k * 4));
+        }
+        for (; v < end; v++) {
+            f32 position[4];
+            skin_vertex(v, position);
+            out.positions[v] = {position[0], position[1], position[2]};
+        }
+    });
+    return true;
+}
+
+// r = a x b over the xyz lanes
+static void cross_lanes(const F4 *a, const F4 *b, F4 *r) {
+    r[0] = a[1] * b[2] - a[2] * b[1];
+    r[1] = a[2] * b[0] - a[0] * b[2];
+    r[2] = a[0] * b[1] - a[1] * b[0];
+}
+
+// Rotates v by the unit quaternion q: v + 2w (q x v) + 2 q x (q x v)
+static void rotate_lanes(const F4 *q, const F4 *v, F4 *r) {
+    F4 c[3], t[3], u[3];
+    cross_lanes(q, v, c);
+    for (usize i = 0; i < 3; i++) t[i] = c[i] + c[i];
+    cross_lanes(q, t, u);
+    for (usize i = 0; i < 3; i++) r[i] = v[i] + q[3] * t[i] + u[i];
+}
+
+static void normalize_lanes(F4 *v) {
+    F4 length = f4_sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+    F4 scale = f4_select(length > f4_splat(1e-20f), f4_splat(1.0f) / length, f4_splat(0.0f));
+    for (usize i = 0; i < 3; i++) v[i] = v[i] * scale;
+}
+
+// 1 / s, or 0 where s is 0
+static F4 reciprocal_lanes(F4 s) {
+    return f4_select(f4_abs(s) > f4_splat(0.0f), f4_splat(1.0f) / s, f4_splat(0.0f));
+}
+
+// Lane l of the result holds component c of vertex vertices[l]
+template <typename T> static void gather_lanes(const T *values, const usize *vertices, F4 *lanes, usize components) {
+    f32 v[4][4];
+    for (usize l = 0; l < 4; l++) std::copy_n(&values[vertices[l]].x, components, v[l]);
+    for (usize c = 0; c < components; c++) lanes[c] = f4_set(v[0][c], v[1][c], v[2][c], v[3][c]);
+}
+
+static void scatter_lanes(const F4 *lanes, usize components, usize first, usize n, f32 *out, usize stride) {
+    f32 v[4][4];
+    for (usize c = 0; c < components; c++) f4_store(v[c], lanes[c]);
+    for (usize l = 0; l < n; l++) {
+        for (usize c = 0; c < components; c++) out[(first + l) * stride + c] = v[c][l];
+    }
+}
+
+bool skin_vertices_dual_quaternion(const SkinBinding &binding, const JointPalette &palette, SkinnedVertices &out) {
+    if (palette.dual_quaternions.size() != palette.matrices.size() * DUAL_QUATERNION_FLOATS) {
+        std::cerr << "Cannot skin vertices: joint palette was not built for dual quaternion skinning" << std::endl;
+        return false;
+    }
+    if (!check_skinning(binding, palette, out)) return false;
+
+    const f32 *joint_data = palette.dual_quaternions.data();
+    const u32 *joints = binding.joints.data();
+    const f32 *weights = binding.weights.data();
+    u32 influences = binding.influences;
+    bool has_normals = !binding.normals.empty(), has_tangents = !binding.tangents.empty();
+    blocks(binding.vertex_count, [&](usize begin, usize end) {
+        // Four vertices per group, one per lane, with joint data transposed so that real[c] holds component c of each
+        // lane's blend. The last group repeats its final vertex in the unused lanes.
+        for (usize v = begin; v < end; v += 4) {
+            usize n = std::min<usize>(4, end - v);
+            usize vertices[4];
+            for (usize l = 0; l < 4; l++) vertices[l] = v + std::min(l, n - 1);
+
+            F4 real[4], dual[4], scale[4], pivot[4];
+            for (u32 k = 0; k < influences; k++) {
+                f32 w[4];
+                for (usize l = 0; l < 4; l++) w[l] = weights[vertices[l] * influences + k];
+                F4 weight = f4_load(w);
+                if (k > 0 && f4_mask(weight > f4_splat(0.0f)) == 0) break;
+
+                F4 r[4], d[4], s[4];
+                for (usize l = 0; l < 4; l++) {
+                    const f32 *joint = &joint_data[joints[vertices[l] * influences + k] * DUAL_QUATERNION_FLOATS];
+                    r[l] = f4_load(joint);
+                    d[l] = f4_load(joint + 4);
+                    s[l] = f4_load(joint + 8);
+                }
+                f4_transpose(r[0], r[1], r[2], r[3]);
+                f4_transpose(d[0], d[1], d[2], d[3]);
+                f4_transpose(s[0], s[1], s[2], s[3]);
+
+                if (k == 0) {
+                    for (usize c = 0; c < 4; c++) {
+                        pivot[c] = r[c];
+                        real[c] = r[c] * weight;
+                        dual[c] = d[c] * weight;
+                        scale[c] = s[c] * weight;
+                    }
+                    continue;
+                }
+
+                // q and -q are the same rotation; blend each joint from the hemisphere of the heaviest one
+                F4 dot = r[0] * pivot[0] + r[1] * pivot[1] + r[2] * pivot[2] + r[3] * pivot[3];
+                F4 signed_weight = f4_select(dot < f4_splat(0.0f), f4_splat(0.0f) - weight, weight);
+                for (usize c = 0; c < 4; c++) {
+                    real[c] = real[c] + r[c] * signed_weight;
+                    dual[c] = dual[c] + d[c] * signed_weight;
+                    scale[c] = scale[c] + s[c] * weight;
+                }
+            }
+
+            F4 length = f4_sqrt(real[0] * real[0] + real[1] * real[1] + real[2] * real[2] + real[3] * real[3]);
+            F4 inverse = reciprocal_lanes(length);
+            for (usize c = 0; c < 4; c++) {
+                real[c] = real[c] * inverse;
+                dual[c] = dual[c] * inverse;
+            }
+
+            // Translation of the blended dual quaternion: 2 (w_r d - w_d r + r x d) over xyz
+            F4 translation[3], rd[3];
+            cross_lanes(real, dual, rd);
+            for (usize c = 0; c < 3; c++) {
+                F4 t = real[3] * dual[c] - dual[3] * real[c] + rd[c];
+                translation[c] = t + t;
+            }
+
+            F4 p[3], r[4];
+            gather_lanes(binding.positions.data(), vertices, p, 3);
+            for (usize c = 0; c < 3; c++) p[c] = p[c] * scale[c];
+            rotate_lanes(real, p, r);
+            for (usize c = 0; c < 3; c++) r[c] = r[c] + translation[c];
+            scatter_lanes(r, 3, v, n, &out.positions[0].x, 3);
+
+            if (has_normals) {
+                // Normals take the inverse transpose of the scale
+                gather_lanes(binding.normals.data(), vertices, p, 3);
+                for (usize c = 0; c < 3; c++) p[c] = p[c] * reciprocal_lanes(scale[c]);
+                rotate_lanes(real, p, r);
+                normalize_lanes(r);
+                scatter_lanes(r, 3, v, n, &out.normals[0].x, 3);
+            }
+            if (has_tangents) {
+                F4 t[4];
+                gather_lanes(binding.tangents.data(), vertices, t, 4);
+                for (usize c = 0; c < 3; c++) t[c] = t[c] * scale[c];
+                rotate_lanes(real, t, r);
+                normalize_lanes(r);
+                r[3] = t[3];
+                scatter_lanes(r, 4, v, n, &out.tangents[0].x, 4);
+            }
+        }
+    });
+    return true;
+}
+
+}; // namespace gltf
@@ -0,0 +1,194 @@
+#include "topology.hpp"
+#include "accessor.hpp"
+#include <iostream>
+#include <unordered_map>
+#include <vector>
+
+namespace gltf {
+
+static usize emit_triangle(u32 *destination, usize write, u32 a, u32 b, u32 c) {
+    if (a == b || b == c || c == a) return write;
+
+    destination[write++] = a;
+    destination[write++] = b;
+    destination[write++] = c;
+    return write;
+}
+
+usize strip_to_list(u32 *destination, const u32 *indices, usize count) {
+    usize write = 0;
+    usize start = 0;
+
+    for (usize i = 0; i < count; i++) {
+        if (indices[i] == RESTART_INDEX) {
+            start = i + 1;
+            continue;
+        }
+        if (i < start + 2) continue;
+
+        // Triangle k of a strip is {v[k], v[k + 1 + k % 2], v[k + 2 - k % 2]}
+        usize k = i - 2;
+        if ((k - start) % 2 == 0) {
+            write = emit_triangle(destination, write, indices[k], indices[k + 1], indices[k + 2]);
+        } else {
+            write = emit_triangle(destination, write, indices[k], indices[k + 2], indices[k + 1]);
+        }
+    }
+
+    return write;
+}
+
+usize fan_to_list(u32 *destination, const u32 *indices, usize count) {
+    usize write = 0;
+    usize start = 0;
+
+    for (usize i = 0; i < count; i++) {
+        if (indices[i] == RESTART_INDEX) {
+            start = i + 1;
+            continue;
+        }
+        if (i < start + 2) continue;
+
+        // Triangle k of a fan is {v[k + 1], v[k + 2], v[0]}
+        write = emit_triangle(destination, write, indices[i - 1], indices[i], indices[start]);
+    }
+
+    return write;
+}
+
+static u64 edge_key(u32 a, u32 b) {
+    return ((u64)a << 32) | b;
+}
+
+usize list_to_strip(u32 *destination, const u32 *indices, usize count, bool use_restart) {
+    usize triangle_count = count / 3;
+
+    // Directed edge -> triangle, each triangle registered under all three of its edges
+    std::unordered_map<u64, u32> edges;
+    edges.reserve(triangle_count * 3);
+    std::vector<bool> used(triangle_count, false);
+
+    for (usize t = 0; t < triangle_count; t++) {
+        const u32 *tri = indices + t * 3;
+        if (tri[0] == tri[1] || tri[1] == tri[2] || tri[2] == tri[0]) {
+            used[t] = true;
+            continue;
+        }
+        for (usize k = 0; k < 3; k++) edges.emplace(edge_key(tri[k], tri[(k + 1) % 3]), (u32)t);
+    }
+
+    // Finds an unused triangle holding the directed edge a -> b, returning its third vertex
+    auto take = [&](u32 a, u32 b, u32 &third) {
+        auto it = edges.find(edge_key(a, b));
+        if (it == edges.end() || used[it->second]) return false;
+
+        const u32 *tri = indices + it->second * 3;
+        third = tri[0] != a && tri[0] != b ? tri[0] : tri[1] != a && tri[1] != b ? tri[1] : tri[2];
+        used[it->second] = true;
+        return true;
+    };
+
+    usize write = 0;
+    std::vector<u32> strip;
+
+    for (usize t = 0; t < triangle_count; t++) {
+        if (used[t]) continue;
+        used[t] = true;
+
+        // Start with the rotation whose trailing edge has an unused neighbour, so the strip can continue
+        const u32 *tri = indices + t * 3;
+        usize rotation = 0;
+        for (usize r = 0; r < 3; r++) {
+            auto it = edges.find(edge_key(tri[(r + 2) % 3], tri[(r + 1) % 3]));
+            if (it != edges.end() && !used[it->second]) {
+                rotation = r;
+                break;
+            }
+        }
+
+        strip.clear();
+        strip.push_back(tri[rotation]);
+        strip.push_back(tri[(rotation + 1) % 3]);
+        strip.push_back(tri[(rotation + 2) % 3]);
+
+        // The next triangle (strip.size() - 2) shares the last two vertices, reversed on odd triangles
+        u32 next;
+        while (true) {
+            u32 x = strip[strip.size() - 2];
+            u32 y = strip[strip.size() - 1];
+            bool odd = (strip.size() - 2) % 2 == 1;
+            if (!(odd ? take(y, x, next) : take(x, y, next))) break;
+            strip.push_back(next);
+        }
+
+        if (write > 0) {
+            if (use_restart) {
+                destination[write++] = RESTART_INDEX;
+            } else {
+                // Degenerate stitch; an extra repeat keeps the next strip starting on an even triangle
+                u32 last = destination[write - 1];
+                if (write % 2 == 1) destination[write++] = last;
+                destination[write++] = last;
+                destination[write++] = strip[0];
+            }
+        }
+
+        for (u32 v : strip) destination[write++] = v;
+    }
+
+    return write;
+}
+
+static bool read_topology(const Model &model, const Primitive &primitive, std::vector<u32> &indices) {
+    usize vertex_count = primitive_vertex_count(model, primitive);
+    if (!read_indices(model, primitive.indices, vertex_count, indices)) {
+        std::cerr << "Cannot convert topology: index accessor has no readable data" << std::endl;
+        return false;
+    }
+
+    // Map the restart value of the stored component type onto RESTART_INDEX
+    if (primitive.indices != UINT32_MAX) {
+        i32 component_type = model.accessors[primitive.indices].component_type;
+        u32 restart = component_type == COMPONENT_UNSIGNED_BYTE    ? 0xff
+                      : component_type == COMPONENT_UNSIGNED_SHORT ? 0xffff
+                                                                   : UINT32_MAX;
+        for (u32 &index : indices) {
+            if (index == restart) index = RESTART_INDEX;
+        }
+    }
+
+    return true;
+}
+
+bool convert_to_triangles(Model &model, Primitive &primitive) {
+    if (primitive.mode != MODE_TRIANGLE_STRIP && primitive.mode != MODE_TRIANGLE_FAN) return true;
+
+    std::vector<u32> indices;
+    if (!read_topology(model, primitive, indices)) return false;
+
+    std::vector<u32> list(indices.size() > 2 ? (indices.size() - 2) * 3 : 0);
+    usize written = primitive.mode == MODE_TRIANGLE_STRIP ? strip_to_list(list.data(), indices.data(), indices.size())
+                                                           : fan_to_list(list.data(), indices.data(), indices.size());
+    list.resize(written);
+
+    primitive.indices = add_index_accessor(model, list, (u32)primitive_vertex_count(model, primitive));
+    primitive.mode = MODE_TRIANGLES;
+    return true;
+}
+
+bool convert_to_strip(Model &model, Primitive &primitive, bool use_restart, bool only_if_smaller) {
+    if (primitive.mode != MODE_TRIANGLES) return true;
+
+    std::vector<u32> indices;
+    if (!read_topology(model, primitive, indices)) return false;
+
+    std::vector<u32> strip(indices.size() / 3 * 6);
+    strip.resize(list_to_strip(strip.data(), indices.data(), indices.size(), use_restart));
+    if (only_if_smaller && strip.size() >= indices.size()) return true;
+
+    primitive.indices = add_index_accessor(model, strip, (u32)primitive_vertex_count(model, primitive));
+    primitive.mode = MODE_TRIANGLE_STRIP;
+    return true;
+}
+
+}; // namespace gltf
@@ -0,0 +1,305 @@
+#include "transform.hpp"
+#include "math.hpp"
+#include "parallel.hpp"
+#include <algorithm>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+namespace gltf {
+
+// Lower bound on the entries per parallel range, so small scenes are not split into tiny jobs
+static const u32 MIN_RANGE_SIZE = 1024;
+
+Mat4 local_transform(const Node &node) {
+    if (node.has_matrix) return node.matrix;
+
+    return compose_trs(node.translation, node.rotation, node.scale);
+}
+
+bool build_transform_order(const Model &model, u32 scene, WorldTransforms &transforms) {
+    transforms.scene = scene;
+    transforms.nodes.clear();
+    transforms.parents.clear();
+    transforms.ranges.clear();
+    transforms.trunk_end = 0;
+
+    u32 node_count = (u32)model.nodes.size();
+    transforms.entries.assign(node_count, UINT32_MAX);
+
+    if (scene >= model.scenes.size()) {
+        std::cerr << "Cannot order transforms: scene " << scene << " does not exist" << std::endl;
+        return false;
+    }
+
+    // Pre-order walk recording which node first reached each child; later references (cycles, shared children) are
+    // ignored so every node has exactly one parent
+    std::vector<u32> owner(node_count, UINT32_MAX);
+    std::vector<bool> seen(node_count, false);
+    std::vector<u32> roots, preorder, stack;
+    for (u32 root : model.scenes[scene].nodes) {
+        if (root < node_count && !seen[root]) {
+            seen[root] = true;
+            roots.push_back(root);
+        }
+    }
+
+    stack.assign(roots.rbegin(), roots.rend());
+    while (!stack.empty()) {
+        u32 n = stack.back();
+        stack.pop_back();
+        preorder.push_back(n);
+
+        for (u32 child : model.nodes[n].children) {
+            if (child < node_count && !seen[child]) {
+                seen[child] = true;
+                owner[child] = n;
+                stack.push_back(child);
+            }
+        }
+    }
+
+    std::vector<u32> sizes(node_count, 1);
+    for (usize i = preorder.size(); i-- > 0;) {
+        if (owner[preorder[i]] != UINT32_MAX) sizes[owner[preorder[i]]] += sizes[preorder[i]];
+    }
+
+    u32 threads = std::max<u32>(std::thread::hardware_concurrency(), 1);
+    u32 range_size = std::max<u32>(MIN_RANGE_SIZE, (u32)preorder.size() / (threads * 8));
+
+    auto append = [&](u32 n) {
+        transforms.entries[n] = (u32)transforms.nodes.size();
+        transforms.nodes.push_back(n);
+        transforms.parents.push_back(owner[n] == UINT32_MAX ? UINT32_MAX : transforms.entries[owner[n]]);
+    };
+
+    // Breadth-first over the trunk: subtrees too large for one range are opened up, the others become range roots
+    std::vector<u32> queue = roots, range_roots;
+    for (usize i = 0; i < queue.size(); i++) {
+        u32 n = queue[i];
+        if (sizes[n] <= range_size) {
+            range_roots.push_back(n);
+            continue;
+        }
+
+        append(n);
+        for (u32 child : model.nodes[n].children) {
+            if (child < node_count && owner[child] == n) queue.push_back(child);
+        }
+    }
+    transforms.trunk_end = (u32)transforms.nodes.size();
+
+    // Each range root's subtree is laid out breadth-first; consecutive subtrees share a range up to range_size
+    transforms.ranges.push_back(transforms.trunk_end);
+    for (u32 root : range_roots) {
+        usize begin = transforms.nodes.size();
+        append(root);
+        for (usize i = begin; i < transforms.nodes.size(); i++) {
+            u32 n = transforms.nodes[i];
+            for (u32 child : model.nodes[n].children) {
+                if (child < node_count && owner[child] == n) append(child);
+            }
+        }
+
+        if (transforms.nodes.size() - transforms.ranges.back() >= range_size) {
+            transforms.ranges.push_back((u32)transforms.nodes.size());
+        }
+    }
+    if (transforms.ranges.back() != transforms.nodes.size()) transforms.ranges.push_back((u32)transforms.nodes.size());
+
+    return true;
+}
+
+void update_world_transforms(const Model &model, WorldTransforms &transforms) {
+    transforms.matrices.resize(transforms.nodes.size());
+
+    auto evaluate = [&](u32 begin, u32 end) {
+        for (u32 i = begin; i < end; i++) {
+            Mat4 local = local_transform(model.nodes[transforms.nodes[i]]);
+            u32 parent = transforms.parents[i];
+            transforms.matrices[i] = parent == UINT32_MAX ? local : mat4_multiply(transforms.matrices[parent], local);
+        }
+    };
+
+    evaluate(0, transforms.trunk_end);
+    if (transforms.ranges.empty()) return;
+
+    parallel_for(transforms.ranges.size() - 1,
+                 [&](usize r) { evaluate(transforms.ranges[r], transforms.ranges[r + 1]); });
+}
+
+bool compute_world_transforms(const Model &model, u32 scene, WorldTransforms &transforms) {
+    if (!build_transform_order(model, scene, transforms)) return false;
+
+    update_world_transforms(model, transforms);
+    return true;
+}
+
+static Node *editable_node(Model &model, u32 node) {
+    if (node >= model.nodes.size()) {
+        std::cerr << "Cannot edit transform: node " << node << " does not exist" << std::endl;
+        return nullptr;
+    }
+
+    Node &target = model.nodes[node];
+    if (target.has_matrix) {
+        decompose_trs(target.matrix, target.translation, target.rotation, target.scale);
+        target.has_matrix = false;
+    }
+    return &target;
+}
+
+void set_translation(Model &model, u32 node, const Vec3 &translation) {
+    Node *target = editable_node(model, node);
+    if (!target) return;
+
+    target->translation = translation;
+    mark_transform_dirty(model, node);
+}
+
+void set_rotation(Model &model, u32 node, const Vec4 &rotation) {
+    Node *target = editable_node(model, node);
+    if (!target) return;
+
+    target->rotation = rotation;
+    mark_transform_dirty(model, node);
+}
+
+void set_scale(Model &model, u32 node, const Vec3 &scale) {
+    Node *target = editable_node(model, node);
+    if (!target) return;
+
+    target->scale = scale;
+    mark_transform_dirty(model, node);
+}
+
+void set_matrix(Model &model, u32 node, const Mat4 &matrix) {
+    if (node >= model.nodes.size()) {
+        std::cerr << "Cannot edit transform: node " << node << " does not exist" << std::endl;
+        return;
+    }
+
+    model.nodes[node].matrix = matrix;
+    model.nodes[node].has_matrix = true;
+    mark_transform_dirty(model, node);
+}
+
+void mark_transform_dirty(Model &model, u32 node) {
+    TransformCache &cache = model.transforms;
+    if (!cache.valid || node >= cache.queued.size() || cache.queued[node]) return;
+
+    cache.queued[node] = 1;
+    cache.dirty.push_back(node);
+}
+
+void build_node_hierarchy(const Model &model, std::vector<u32> &parents, std::vector<u32> &order) {
+    usize node_count = model.nodes.size();
+
+    parents.assign(node_count, UINT32_MAX);
+    for (u32 n = 0; n < node_count; n++) {
+        for (u32 child : model.nodes[n].children) {
+            if (child < node_count && parents[child] == UINT32_MAX && child != n) parents[child] = n;
+        }
+    }
+
+    // Breadth-first from the roots. Nodes only reachable through a cycle are detached and become roots, so walks up
+    // `parents` always terminate.
+    std::vector<u8> reached(node_count, 0);
+    order.clear();
+    for (u32 n = 0; n < node_count; n++) {
+        if (parents[n] == UINT32_MAX) {
+            reached[n] = 1;
+            order.push_back(n);
+        }
+    }
+
+    u32 next_unreached = 0;
+    for (usize i = 0; order.size() < node_count || i < order.size(); i++) {
+        if (i == order.size()) {
+            while (reached[next_unreached]) next_unreached++;
+            parents[next_unreached] = UINT32_MAX;
+            reached[next_unreached] = 1;
+            order.push_back(next_unreached);
+        }
+
+        u32 n = order[i];
+        for (u32 child : model.nodes[n].children) {
+            if (child < node_count && parents[child] == n && !reached[child]) {
+                reached[child] = 1;
+                order.push_back(child);
+            }
+        }
+    }
+}
+
+static void rebuild_transforms(Model &model) {
+    TransformCache &cache = model.transforms;
+    usize node_count = model.nodes.size();
+
+    build_node_hierarchy(model, cache.parents, cache.changed);
+    cache.world.resize(node_count);
+    for (u32 n : cache.changed) {
+        Mat4 local = local_transform(model.nodes[n]);
+        cache.world[n] = cache.parents[n] == UINT32_MAX ? local : mat4_multiply(cache.world[cache.parents[n]], local);
+    }
+
+    cache.dirty.clear();
+    cache.queued.assign(node_count, 0);
+    cache.valid = true;
+
+    model.bounds.moved_roots.clear();
+    model.bounds.refit_all = true;
+}
+
+void update_transforms(Model &model) {
+    TransformCache &cache = model.transforms;
+    usize node_count = model.nodes.size();
+    if (!cache.valid || cache.world.size() != node_count) {
+        rebuild_transforms(model);
+        return;
+    }
+
+    cache.changed.clear();
+    std::vector<u32> stack;
+    for (u32 root : cache.dirty) {
+        // A queued ancestor recomputes this subtree anyway
+        bool covered = false;
+        for (u32 p = cache.parents[root]; p != UINT32_MAX && !covered; p = cache.parents[p]) covered = cache.queued[p];
+        if (covered) continue;
+
+        model.bounds.moved_roots.push_back(root);
+        stack.assign(1, root);
+        while (!stack.empty()) {
+            u32 n = stack.back();
+            stack.pop_back();
+
+            Mat4 local = local_transform(model.nodes[n]);
+            u32 parent = cache.parents[n];
+            cache.world[n] = parent == UINT32_MAX ? local : mat4_multiply(cache.world[parent], local);
+            cache.changed.push_back(n);
+
+            for (u32 child : model.nodes[n].children) {
+                if (child < node_count && cache.parents[child] == n) stack.push_back(child);
+            }
+        }
+    }
+
+    for (u32 n : cache.dirty) cache.queued[n] = 0;
+    cache.dirty.clear();
+
+    // Without update_bounds() calls the list would grow every frame; past one entry per node a full refit is cheaper
+    if (model.bounds.moved_roots.size() > node_count) {
+        model.bounds.moved_roots.clear();
+        model.bounds.refit_all = true;
+    }
+}
+
+const Mat4 &world_transform(const Model &model, u32 node) {
+    return model.transforms.world[node];
+}
+
+void invalidate_transforms(Model &model) {
+    model.transforms.valid = false;
+}
+
+}; // namespace gltf
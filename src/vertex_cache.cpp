@@ -0,0 +1,207 @@
+#include "vertex_cache.hpp"
+#include "accessor.hpp"
+#include "parallel.hpp"
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+namespace gltf {
+
+static void finish_stats(VertexCacheStats &stats) {
+    stats.acmr = stats.triangles ? (f32)stats.transforms / stats.triangles : 0.0f;
+    stats.atvr = stats.vertices ? (f32)stats.transforms / stats.vertices : 0.0f;
+}
+
+VertexCacheStats analyze_vertex_cache(const u32 *indices, usize index_count, usize vertex_count, usize cache_size) {
+    VertexCacheStats stats;
+    stats.triangles = index_count / 3;
+
+    // A vertex is resident while fewer than `cache_size` misses happened since it was loaded
+    std::vector<usize> loaded_at(vertex_count, 0);
+    std::vector<bool> seen(vertex_count, false);
+    usize time = cache_size + 1;
+
+    for (usize i = 0; i < stats.triangles * 3; i++) {
+        u32 v = indices[i];
+        if (v >= vertex_count) continue;
+
+        if (!seen[v]) {
+            seen[v] = true;
+            stats.vertices++;
+        }
+
+        if (time - loaded_at[v] > cache_size) {
+            loaded_at[v] = time++;
+            stats.transforms++;
+        }
+    }
+
+    finish_stats(stats);
+    return stats;
+}
+
+// Tipsify: Sander, Nehab, Barczak - "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw" (2007)
+void optimize_vertex_cache(u32 *indices, usize index_count, usize vertex_count, usize cache_size) {
+    usize triangle_count = index_count / 3;
+    if (triangle_count == 0 || vertex_count == 0) return;
+
+    // Vertex -> triangle adjacency in CSR form
+    std::vector<u32> live(vertex_count, 0);
+    for (usize i = 0; i < triangle_count * 3; i++) {
+        if (indices[i] >= vertex_count) return;
+        live[indices[i]]++;
+    }
+
+    std::vector<u32> offsets(vertex_count + 1, 0);
+    for (usize v = 0; v < vertex_count; v++) offsets[v + 1] = offsets[v] + live[v];
+
+    std::vector<u32> adjacency(triangle_count * 3);
+    std::vector<u32> fill(offsets.begin(), offsets.end() - 1);
+    for (usize t = 0; t < triangle_count; t++) {
+        for (usize k = 0; k < 3; k++) adjacency[fill[indices[t * 3 + k]]++] = (u32)t;
+    }
+
+    std::vector<usize> loaded_at(vertex_count, 0);
+    std::vector<bool> emitted(triangle_count, false);
+    std::vector<u32> dead_end;
+    std::vector<u32> candidates;
+    std::vector<u32> output;
+    output.reserve(triangle_count * 3);
+
+    usize time = cache_size + 1;
+    usize cursor = 0;
+    i64 fan = 0;
+    while (fan >= 0 && live[fan] == 0) fan = ++cursor < vertex_count ? (i64)cursor : -1;
+
+    while (fan >= 0) {
+        candidates.clear();
+
+        for (u32 a = offsets[fan]; a < offsets[fan + 1]; a++) {
+            u32 t = adjacency[a];
+            if (emitted[t]) continue;
+
+            for (usize k = 0; k < 3; k++) {
+                u32 v = indices[t * 3 + k];
+                output.push_back(v);
+                dead_end.push_back(v);
+                candidates.push_back(v);
+                live[v]--;
+
+                if (time - loaded_at[v] > cache_size) loaded_at[v] = time++;
+            }
+
+            emitted[t] = true;
+        }
+
+        // Prefer the candidate that stays in cache the longest after its remaining triangles are emitted
+        i64 best = -1;
+        i64 best_priority = -1;
+        for (u32 v : candidates) {
+            if (live[v] == 0) continue;
+
+            i64 priority = 0;
+            if (time - loaded_at[v] + 2 * live[v] <= cache_size) priority = (i64)(time - loaded_at[v]);
+            if (priority > best_priority) {
+                best = v;
+                best_priority = priority;
+            }
+        }
+
+        if (best == -1) {
+            while (!dead_end.empty()) {
+                u32 v = dead_end.back();
+                dead_end.pop_back();
+                if (live[v] > 0) {
+                    best = v;
+                    break;
+                }
+            }
+        }
+
+        if (best == -1) {
+            while (cursor < vertex_count && live[cursor] == 0) cursor++;
+            if (cursor < vertex_count) best = (i64)cursor;
+        }
+
+        fan = best;
+    }
+
+    std::copy(output.begin(), output.end(), indices);
+}
+
+static usize max_index_count(const std::vector<u32> &indices) {
+    u32 max_index = 0;
+    for (u32 index : indices) max_index = std::max(max_index, index);
+    return indices.empty() ? 0 : (usize)max_index + 1;
+}
+
+static bool optimize_index_accessor(Model &model, u32 accessor, usize cache_size, VertexCacheReport *report) {
+    std::vector<u32> indices;
+    if (!read_indices(model, accessor, 0, indices)) {
+        std::cerr << "Cannot optimize vertex cache: index accessor has no readable data" << std::endl;
+        return false;
+    }
+
+    usize vertex_count = max_index_count(indices);
+    usize index_count = indices.size() - indices.size() % 3;
+
+    if (report) report->before = analyze_vertex_cache(indices.data(), index_count, vertex_count, cache_size);
+    optimize_vertex_cache(indices.data(), index_count, vertex_count, cache_size);
+    if (report) report->after = analyze_vertex_cache(indices.data(), index_count, vertex_count, cache_size);
+
+    return write_indices(model, accessor, indices);
+}
+
+bool optimize_vertex_cache(Model &model, Primitive &primitive, usize cache_size, VertexCacheReport *report) {
+    if (primitive.mode != 4 || primitive.indices == UINT32_MAX) return true;
+
+    return optimize_index_accessor(model, primitive.indices, cache_size, report);
+}
+
+bool optimize_vertex_cache(Model &model, usize cache_size, VertexCacheReport *report) {
+    // Each accessor is optimized once. The workers rewrite indices in place, so accessors sharing bytes with any
+    // other accessor (a prefix of the same indices, a second view over the same buffer range) first get their own copy.
+    std::vector<u8> seen(model.accessors.size(), 0);
+    std::vector<u32> accessors;
+    bool valid = true;
+    for (const Mesh &mesh : model.meshes) {
+        for (const Primitive &primitive : mesh.primitives) {
+            u32 index = primitive.indices;
+            if (primitive.mode != 4 || index == UINT32_MAX) continue;
+            if (index >= model.accessors.size()) {
+                std::cerr << "Cannot optimize vertex cache: index accessor " << index << " does not exist" << std::endl;
+                valid = false;
+                continue;
+            }
+            if (seen[index]) continue;
+
+            seen[index] = 1;
+            accessors.push_back(index);
+        }
+    }
+    unshare_accessors(model, accessors);
+
+    std::vector<VertexCacheReport> reports(accessors.size());
+    std::vector<char> results(accessors.size(), 0);
+    parallel_for(accessors.size(), [&](usize i) {
+        results[i] = optimize_index_accessor(model, accessors[i], cache_size, &reports[i]);
+    });
+
+    if (report) {
+        *report = VertexCacheReport();
+        for (const VertexCacheReport &r : reports) {
+            report->before.triangles += r.before.triangles;
+            report->before.vertices += r.before.vertices;
+            report->before.transforms += r.before.transforms;
+            report->after.triangles += r.after.triangles;
+            report->after.vertices += r.after.vertices;
+            report->after.transforms += r.after.transforms;
+        }
+        finish_stats(report->before);
+        finish_stats(report->after);
+    }
+
+    return valid && std::find(results.begin(), results.end(), 0) == results.end();
+}
+
+}; // namespace gltf
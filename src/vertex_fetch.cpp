@@ -0,0 +1,55 @@
+#include "vertex_fetch.hpp"
+#include "accessor.hpp"
+#include <iostream>
+#include <vector>
+
+namespace gltf {
+
+usize build_vertex_fetch_remap(u32 *remap, const u32 *indices, usize index_count, usize vertex_count) {
+    for (usize v = 0; v < vertex_count; v++) remap[v] = UINT32_MAX;
+
+    u32 next = 0;
+    for (usize i = 0; i < index_count; i++) {
+        u32 v = indices[i];
+        if (v < vertex_count && remap[v] == UINT32_MAX) remap[v] = next++;
+    }
+
+    return next;
+}
+
+bool optimize_vertex_fetch(Model &model, Primitive &primitive) {
+    if (primitive.indices == UINT32_MAX) return true;
+
+    usize vertex_count = primitive_vertex_count(model, primitive);
+    if (primitive.attributes.empty() || vertex_count == 0) {
+        std::cerr << "Cannot optimize vertex fetch: primitive attributes are missing or disagree on vertex count"
+                  << std::endl;
+        return false;
+    }
+
+    std::vector<u32> indices;
+    if (!read_indices(model, primitive.indices, vertex_count, indices)) {
+        std::cerr << "Cannot optimize vertex fetch: index accessor has no readable data" << std::endl;
+        return false;
+    }
+
+    for (u32 index : indices) {
+        if (index >= vertex_count) {
+            std::cerr << "Cannot optimize vertex fetch: index " << index << " is out of range" << std::endl;
+            return false;
+        }
+    }
+
+    std::vector<u32> remap(vertex_count);
+    usize unique_count = build_vertex_fetch_remap(remap.data(), indices.data(), indices.size(), vertex_count);
+
+    for (u32 &index : indices) index = remap[index];
+
+    // The index accessor may be shared with primitives using other vertex data, so a new one is written
+    if (!remap_vertices(model, primitive, remap, unique_count)) return false;
+    primitive.indices = add_index_accessor(model, indices, (u32)unique_count);
+
+    return true;
+}
+
+}; // namespace gltf
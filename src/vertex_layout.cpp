@@ -0,0 +1,142 @@
+#include "vertex_layout.hpp"
+#include "accessor.hpp"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+namespace gltf {
+
+struct LayoutStream {
+    std::string name;
+    u32 accessor;
+    AccessorView view;
+    usize size;
+    usize offset;
+};
+
+static usize align_up(usize value, usize alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+// Single streaming pass copying one attribute from its source layout into the destination layout
+static void copy_stream(const AccessorView &src, usize size, u8 *dst, usize dst_stride) {
+    if (src.stride == size && dst_stride == size) {
+        std::memcpy(dst, src.data, size * src.count);
+        return;
+    }
+
+    for (usize i = 0; i < src.count; i++) {
+        std::memcpy(dst + i * dst_stride, src.data + i * src.stride, size);
+    }
+}
+
+static bool collect_streams(const Model &model, const Primitive &primitive, const std::vector<std::string> &order,
+                            std::vector<LayoutStream> &streams, usize &vertex_count) {
+    vertex_count = primitive_vertex_count(model, primitive);
+    if (primitive.attributes.empty() || vertex_count == 0) {
+        std::cerr << "Cannot change layout: primitive attributes are missing or disagree on vertex count" << std::endl;
+        return false;
+    }
+
+    std::vector<std::string> names;
+    for (const std::string &name : order) {
+        if (primitive.attributes.count(name) && std::find(names.begin(), names.end(), name) == names.end()) {
+            names.push_back(name);
+        }
+    }
+    for (const auto &attr : primitive.attributes) {
+        if (std::find(names.begin(), names.end(), attr.first) == names.end()) names.push_back(attr.first);
+    }
+
+    streams.clear();
+    for (const std::string &name : names) {
+        LayoutStream stream;
+        stream.name = name;
+        stream.accessor = primitive.attributes.at(name);
+        stream.offset = 0;
+
+        if (!view_accessor(model, stream.accessor, stream.view)) {
+            std::cerr << "Cannot change layout: attribute " << name << " has no readable data" << std::endl;
+            return false;
+        }
+
+        stream.size = element_size(model.accessors[stream.accessor]);
+        streams.push_back(stream);
+    }
+
+    return true;
+}
+
+bool interleave_primitive(Model &model, Primitive &primitive, const std::vector<std::string> &order,
+                          usize alignment) {
+    alignment = align_up(std::max<usize>(alignment, 4), 4);
+
+    std::vector<LayoutStream> streams;
+    usize vertex_count;
+    if (!collect_streams(model, primitive, order, streams, vertex_count)) return false;
+
+    usize stride = 0;
+    for (LayoutStream &stream : streams) {
+        stream.offset = align_up(stride, alignment);
+        stride = stream.offset + stream.size;
+    }
+    stride = align_up(stride, alignment);
+
+    if (stride > 252) {
+        std::cerr << "Cannot interleave: vertex stride " << stride << " exceeds the glTF limit of 252" << std::endl;
+        return false;
+    }
+
+    std::vector<u8> data(stride * vertex_count, 0);
+    for (const LayoutStream &stream : streams) {
+        copy_stream(stream.view, stream.size, data.data() + stream.offset, stride);
+    }
+
+    u32 view = append_buffer_view(model, data.data(), data.size(), stride, TARGET_ARRAY_BUFFER, alignment);
+
+    for (const LayoutStream &stream : streams) {
+        Accessor accessor = model.accessors[stream.accessor];
+        accessor.buffer_view = view;
+        accessor.byte_offset = stream.offset;
+
+        primitive.attributes[stream.name] = add_accessor(model, accessor);
+    }
+
+    return true;
+}
+
+bool deinterleave_primitive(Model &model, Primitive &primitive, usize alignment) {
+    alignment = align_up(std::max<usize>(alignment, 4), 4);
+
+    std::vector<LayoutStream> streams;
+    usize vertex_count;
+    if (!collect_streams(model, primitive, {}, streams, vertex_count)) return false;
+
+    // Vertex attribute elements must start on 4-byte boundaries, so elements like u8 VEC3 keep a padded stride
+    usize length = 0;
+    for (LayoutStream &stream : streams) {
+        stream.offset = align_up(length, alignment);
+        length = stream.offset + align_up(stream.size, 4) * vertex_count;
+    }
+
+    std::vector<u8> data(length, 0);
+    for (const LayoutStream &stream : streams) {
+        copy_stream(stream.view, stream.size, data.data() + stream.offset, align_up(stream.size, 4));
+    }
+
+    for (const LayoutStream &stream : streams) {
+        usize stride = align_up(stream.size, 4);
+        u32 view = append_buffer_view(model, data.data() + stream.offset, stride * vertex_count,
+                                      stride == stream.size ? 0 : stride, TARGET_ARRAY_BUFFER, alignment);
+
+        Accessor accessor = model.accessors[stream.accessor];
+        accessor.buffer_view = view;
+        accessor.byte_offset = 0;
+
+        primitive.attributes[stream.name] = add_accessor(model, accessor);
+    }
+
+    return true;
+}
+
+}; // namespace gltf
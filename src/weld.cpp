@@ -0,0 +1,175 @@
+#include "weld.hpp"
+#include "accessor.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+namespace gltf {
+
+struct WeldStream {
+    AccessorView view;
+    usize size;     // Bytes per element
+    usize key_size; // Bytes the element takes in the vertex key
+    f32 epsilon;
+};
+
+// Index of the grid cell `v` rounds to. Cells are 64-bit and clamped, so tiny epsilons over large coordinates cannot
+// overflow; non-finite values share the outermost cells.
+static i64 grid_cell(f32 v, f32 epsilon) {
+    const f64 limit = 9.0e18;
+    f64 cell = std::floor((f64)v / epsilon + 0.5);
+    if (cell != cell) return 0;
+    return (i64)std::max(-limit, std::min(limit, cell));
+}
+
+static u32 hash_key(const u32 *key, usize words) {
+    // murmur2-style mixing over the packed key
+    u32 h = 0x9747b28c;
+    for (usize i = 0; i < words; i++) {
+        u32 k = key[i] * 0x5bd1e995;
+        k ^= k >> 24;
+        h = (h * 0x5bd1e995) ^ (k * 0x5bd1e995);
+    }
+
+    h ^= h >> 13;
+    h *= 0x5bd1e995;
+    h ^= h >> 15;
+    return h;
+}
+
+// Packs all attribute values of one vertex into a fixed-size key. Float components are replaced by their grid cell
+// when the stream has an epsilon, and -0.0 is folded into 0.0 so exact comparisons do not split on sign.
+static void pack_key(const std::vector<WeldStream> &streams, usize vertex, u8 *key) {
+    for (const WeldStream &stream : streams) {
+        const u8 *src = stream.view.element(vertex);
+
+        if (stream.view.component_type == COMPONENT_FLOAT) {
+            for (usize c = 0; c < stream.view.components; c++) {
+                f32 v;
+                std::memcpy(&v, src + c * 4, 4);
+
+                if (stream.epsilon > 0.0f) {
+                    i64 cell = grid_cell(v, stream.epsilon);
+                    std::memcpy(key + c * 8, &cell, 8);
+                } else {
+                    if (v == 0.0f) v = 0.0f;
+                    std::memcpy(key + c * 4, &v, 4);
+                }
+            }
+        } else {
+            std::memcpy(key, src, stream.size);
+        }
+
+        key += stream.key_size;
+    }
+}
+
+bool weld_primitive(Model &model, Primitive &primitive, const WeldOptions &options, WeldStats *stats) {
+    usize vertex_count = primitive_vertex_count(model, primitive);
+    if (primitive.attributes.empty() || vertex_count == 0) {
+        std::cerr << "Cannot weld: primitive attributes are missing or disagree on vertex count" << std::endl;
+        return false;
+    }
+
+    std::vector<WeldStream> streams;
+    usize key_size = 0;
+    for (const auto &attr : primitive.attributes) {
+        WeldStream stream;
+        if (!view_accessor(model, attr.second, stream.view)) {
+            std::cerr << "Cannot weld: attribute " << attr.first << " has no readable data" << std::endl;
+            return false;
+        }
+
+        stream.size = element_size(model.accessors[attr.second]);
+        stream.epsilon = attr.first == "POSITION" ? options.position_epsilon
+                         : attr.first == "NORMAL" ? options.normal_epsilon
+                                                  : 0.0f;
+        if (stream.view.component_type != COMPONENT_FLOAT) stream.epsilon = 0.0f;
+        stream.key_size = stream.epsilon > 0.0f ? stream.view.components * sizeof(i64) : stream.size;
+        key_size += stream.key_size;
+        streams.push_back(stream);
+    }
+
+    // Vertices only merge when every morph target displaces them identically as well
+    for (const auto &target : primitive.targets) {
+        for (const auto &attr : target) {
+            WeldStream stream;
+            if (!view_accessor(model, attr.second, stream.view)) {
+                std::cerr << "Cannot weld: morph target " << attr.first << " has no readable data" << std::endl;
+                return false;
+            }
+
+            stream.size = element_size(model.accessors[attr.second]);
+            stream.key_size = stream.size;
+            stream.epsilon = 0.0f;
+            key_size += stream.key_size;
+            streams.push_back(stream);
+        }
+    }
+
+    std::vector<u32> indices;
+    if (!read_indices(model, primitive.indices, vertex_count, indices)) {
+        std::cerr << "Cannot weld: index accessor has no readable data" << std::endl;
+        return false;
+    }
+
+    // Keys are packed contiguously so probing compares against sequential memory
+    usize key_words = (key_size + 3) / 4;
+    std::vector<u32> keys(vertex_count * key_words, 0);
+    for (usize i = 0; i < vertex_count; i++) {
+        pack_key(streams, i, reinterpret_cast<u8 *>(keys.data() + i * key_words));
+    }
+
+    // Open addressing with linear probing, load factor kept at or below 0.5
+    usize capacity = 1;
+    while (capacity < vertex_count * 2) capacity <<= 1;
+    std::vector<u32> table(capacity, UINT32_MAX);
+
+    std::vector<u32> remap(vertex_count, UINT32_MAX);
+    std::vector<u32> unique(vertex_count);
+    u32 unique_count = 0;
+
+    for (usize i = 0; i < vertex_count; i++) {
+        const u32 *key = keys.data() + i * key_words;
+        usize slot = hash_key(key, key_words) & (capacity - 1);
+
+        while (true) {
+            u32 entry = table[slot];
+            if (entry == UINT32_MAX) {
+                table[slot] = (u32)i;
+                unique[i] = unique_count;
+                remap[i] = unique_count++;
+                break;
+            }
+
+            if (std::memcmp(keys.data() + entry * key_words, key, key_words * 4) == 0) {
+                unique[i] = unique[entry];
+                break;
+            }
+
+            slot = (slot + 1) & (capacity - 1);
+        }
+    }
+
+    for (u32 &index : indices) {
+        if (index >= vertex_count) {
+            std::cerr << "Cannot weld: index " << index << " is out of range" << std::endl;
+            return false;
+        }
+        index = unique[index];
+    }
+
+    if (!remap_vertices(model, primitive, remap, unique_count)) return false;
+    primitive.indices = add_index_accessor(model, indices, unique_count);
+
+    if (stats) {
+        stats->vertices_before = vertex_count;
+        stats->vertices_after = unique_count;
+    }
+
+    return true;
+}
+
+}; // namespace gltf
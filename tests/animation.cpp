@@ -0,0 +1,103 @@
+// Sampled values of every interpolation mode at known times, including times outside the keyframes, and agreement
+// between binary search, cursor and batch sampling
+#include "animation.hpp"
+#include "common.hpp"
+#include "node_transforms.hpp"
+
+using namespace test;
+
+// Forward playback, seeks backwards and times outside the keyframes
+static const f32 TIMES[] = {-0.5f, 0.0f, 0.1f, 0.25f, 0.27f, 0.9f, 1.0f, 1.2f, 0.2f, 1.9f, 2.0f, 2.5f, 0.6f, 1.74f};
+static const u32 TIME_COUNT = sizeof(TIMES) / sizeof(TIMES[0]);
+
+static void check_cursor_matches_binary_search(const AnimationClip &clip) {
+    for (const AnimationTrack &track : clip.tracks) {
+        u32 cursor = 0;
+        for (u32 i = 0; i < TIME_COUNT; i++) {
+            f32 expected[4], sampled[4];
+            sample_track(track, TIMES[i], expected);
+            sample_track(track, TIMES[i], sampled, cursor);
+            for (u32 c = 0; c < track.width; c++) CHECK(expected[c] == sampled[c]);
+        }
+    }
+}
+
+// Instances spread over the clip, then clustered so neighbouring lanes share keyframe intervals and equal times
+static void check_batch_matches_cursor(const Model &model, const AnimationClip &clip) {
+    // Not a multiple of the lane count, so the last group is partial
+    const u32 INSTANCES = 7;
+    std::vector<NodeTransforms> expected(INSTANCES), poses(INSTANCES);
+    std::vector<AnimationCursor> cursors(INSTANCES);
+    for (u32 i = 0; i < INSTANCES; i++) {
+        build_node_transforms(model, expected[i]);
+        build_node_transforms(model, poses[i]);
+        reset_animation_cursor(clip, cursors[i]);
+    }
+
+    AnimationBatch batch;
+    init_animation_batch(clip, INSTANCES, batch);
+    for (u32 frame = 0; frame < 2 * TIME_COUNT; frame++) {
+        f32 times[INSTANCES];
+        for (u32 i = 0; i < INSTANCES; i++) {
+            bool clustered = frame >= TIME_COUNT;
+            times[i] = clustered ? TIMES[frame - TIME_COUNT] + (i / 2) * 0.02f : TIMES[(frame + i * 3) % TIME_COUNT];
+            apply_animation(clip, times[i], expected[i], cursors[i]);
+        }
+        sample_animation_batch(clip, batch, times);
+
+        // LINEAR rotations in a batch use an nlerp within 0.002 radians of slerp
+        for (u32 i = 0; i < INSTANCES; i++) {
+            apply_animation_batch(clip, batch, i, poses[i]);
+            for (u32 n = 0; n < model.nodes.size(); n++) {
+                CHECK(near(poses[i].translations[n], expected[i].translations[n], 1e-4f));
+                CHECK(near(poses[i].rotations[n], expected[i].rotations[n], 2e-3f));
+                CHECK(near(poses[i].scales[n], expected[i].scales[n], 1e-5f));
+            }
+            for (usize w = 0; w < expected[i].weights.size(); w++) {
+                CHECK(near(poses[i].weights[w], expected[i].weights[w], 1e-6f));
+            }
+        }
+    }
+
+    // Rows hold value c of track t for instance i at (rows[t] + c) * instances + i
+    const AnimationTrack &translation = clip.tracks[0];
+    CHECK(translation.path == ANIMATION_PATH_TRANSLATION && translation.node == 0);
+    for (u32 i = 0; i < INSTANCES; i++) {
+        CHECK(batch.values[(batch.rows[0] + 1) * INSTANCES + i] == poses[i].translations[0].y);
+    }
+}
+
+int main() {
+    Model model = make_animated_model();
+    AnimationClip clip;
+    CHECK(build_animation_clip(model, 0, clip));
+    CHECK(clip.tracks.size() == 5);
+    CHECK(clip.start == 0.0f && clip.end == 2.0f);
+
+    // Halfway along the first interval: LINEAR halfway, STEP holding its earlier key, CUBICSPLINE with zero tangents
+    // between the keys' values and the morph weights halfway
+    NodeTransforms pose;
+    build_node_transforms(model, pose);
+    apply_animation(clip, 0.125f, pose);
+    CHECK(near(pose.translations[0], {100.375f, 0.5f * std::sin(1.0f), -0.0625f}, 1e-5f));
+    CHECK(near(pose.scales[1], {1.0f, 2.0f, 0.5f}, 0.0f));
+    f32 half = 0.5f * (std::cos(0.0f) + std::cos(0.75f));
+    CHECK(near(pose.weights[pose.weight_offsets[2]], 0.5f + 0.5f * half, 1e-5f));
+
+    // LINEAR rotations slerp: halfway between the angles of the first two keys around the same axis
+    f32 s = std::sin(0.1375f);
+    CHECK(near(pose.rotations[0], {0.6f * s, 0.0f, 0.8f * s, std::cos(0.1375f)}, 1e-5f));
+
+    // Times past either end clamp to the first or last key
+    apply_animation(clip, 3.0f, pose);
+    CHECK(near(pose.translations[0], {106.0f, std::sin(8.0f), -8.0f}, 1e-5f));
+    CHECK(near(pose.scales[1], {3.0f, 1.0f, 1.0f}, 0.0f));
+    apply_animation(clip, -1.0f, pose);
+    CHECK(near(pose.translations[1], {0.0f, 1.0f, 0.0f}, 1e-6f));
+
+    check_cursor_matches_binary_search(clip);
+    check_batch_matches_cursor(model, clip);
+
+    std::printf("animation: ok\n");
+    return 0;
+}
@@ -0,0 +1,92 @@
+// Incremental update_bounds() must match a full rebuild, including after update_transforms() calls made in between
+#include "bounds.hpp"
+#include "common.hpp"
+#include "transform.hpp"
+
+using namespace test;
+
+static u32 seed = 12345;
+
+static u32 next_random(u32 range) {
+    seed = seed * 1664525u + 1013904223u;
+    return (seed >> 8) % range;
+}
+
+static bool same_bounds(const Bounds &a, const Bounds &b) {
+    if (a.empty() || b.empty()) return a.empty() == b.empty();
+    return near(a.min, b.min, 1e-3f) && near(a.max, b.max, 1e-3f) && near(a.center, b.center, 1e-3f) &&
+           near(a.radius, b.radius, 1e-3f);
+}
+
+// A unit quad mesh on a random tree of nodes, a third of them instancing it
+static Model make_tree(u32 node_count) {
+    Model model;
+    std::vector<f32> positions = {0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f};
+    Primitive primitive;
+    primitive.attributes["POSITION"] = add_float_accessor(model, positions, "VEC3", TARGET_ARRAY_BUFFER);
+    model.meshes.resize(1);
+    model.meshes[0].primitives.push_back(primitive);
+
+    model.nodes.resize(node_count);
+    for (u32 n = 0; n < node_count; n++) {
+        model.nodes[n].mesh = next_random(3) == 0 ? 0 : UINT32_MAX;
+        model.nodes[n].translation = {(f32)next_random(10), (f32)next_random(10), 0.0f};
+        if (n > 0) model.nodes[next_random(n)].children.push_back(n);
+    }
+    model.scenes.resize(1);
+    model.scenes[0].nodes = {0};
+    return model;
+}
+
+static void check_matches_full_rebuild(Model &model) {
+    update_bounds(model);
+    std::vector<Bounds> incremental = model.bounds.nodes;
+
+    invalidate_bounds(model);
+    update_bounds(model);
+    for (u32 n = 0; n < model.nodes.size(); n++) CHECK(same_bounds(incremental[n], model.bounds.nodes[n]));
+}
+
+int main() {
+    // An edit whose world matrix was already recomputed by an unrelated update_transforms()
+    Model model = make_tree(1);
+    model.nodes[0].translation = {0.0f, 0.0f, 0.0f};
+    update_bounds(model);
+    set_translation(model, 0, {100.0f, 0.0f, 0.0f});
+    update_transforms(model);
+    update_bounds(model);
+    CHECK(near(scene_bounds(model, 0).min.x, 100.0f, 1e-5f));
+
+    // Random edits, with any number of update_transforms() calls and full transform rebuilds between refits
+    const u32 NODES = 300;
+    model = make_tree(NODES);
+    update_bounds(model);
+    for (u32 iteration = 0; iteration < 60; iteration++) {
+        for (u32 edit = 0; edit < 3; edit++) {
+            set_translation(model, next_random(NODES),
+                            {(f32)next_random(20), (f32)next_random(20), (f32)next_random(5)});
+            for (u32 call = next_random(3); call > 0; call--) update_transforms(model);
+        }
+        if (iteration % 7 == 0) {
+            u32 n = next_random(NODES);
+            model.nodes[n].mesh = model.nodes[n].mesh == 0 ? UINT32_MAX : 0;
+            mark_transform_dirty(model, n);
+        }
+        if (iteration % 11 == 0) {
+            invalidate_transforms(model);
+            update_transforms(model);
+        }
+        check_matches_full_rebuild(model);
+    }
+
+    // Many transform updates without a refit collapse into a full one
+    for (u32 call = 0; call < 2 * NODES; call++) {
+        set_translation(model, next_random(NODES), {(f32)next_random(20), 0.0f, 0.0f});
+        update_transforms(model);
+    }
+    CHECK(model.bounds.moved_roots.size() <= NODES);
+    check_matches_full_rebuild(model);
+
+    std::printf("bounds: ok\n");
+    return 0;
+}
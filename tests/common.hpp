@@ -0,0 +1,119 @@
+#pragma once
+
+#include "accessor.hpp"
+#include "gltf.hpp"
+#include "types.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+// Reports the failed condition and ends the test with a non-zero exit code
+#define CHECK(condition)                                                                                               \
+    do {                                                                                                               \
+        if (!(condition)) {                                                                                            \
+            std::fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition);                         \
+            std::exit(1);                                                                                              \
+        }                                                                                                              \
+    } while (0)
+
+namespace test {
+
+using namespace gltf;
+
+inline bool near(f32 a, f32 b, f32 tolerance) {
+    return std::fabs(a - b) <= tolerance;
+}
+
+inline bool near(const Vec3 &a, const Vec3 &b, f32 tolerance) {
+    return near(a.x, b.x, tolerance) && near(a.y, b.y, tolerance) && near(a.z, b.z, tolerance);
+}
+
+// Quaternions q and -q are the same rotation
+inline bool near(const Vec4 &a, const Vec4 &b, f32 tolerance) {
+    f32 sign = a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w < 0.0f ? -1.0f : 1.0f;
+    return near(a.x, sign * b.x, tolerance) && near(a.y, sign * b.y, tolerance) && near(a.z, sign * b.z, tolerance) &&
+           near(a.w, sign * b.w, tolerance);
+}
+
+// Triangles with their corners rotated so the smallest index comes first, sorted. Rotation keeps the winding.
+inline std::vector<u32> triangle_set(const std::vector<u32> &indices) {
+    std::vector<std::vector<u32>> triangles;
+    for (usize i = 0; i + 2 < indices.size(); i += 3) {
+        std::vector<u32> triangle(indices.begin() + i, indices.begin() + i + 3);
+        std::rotate(triangle.begin(), std::min_element(triangle.begin(), triangle.end()), triangle.end());
+        triangles.push_back(triangle);
+    }
+    std::sort(triangles.begin(), triangles.end());
+
+    std::vector<u32> flat;
+    for (const auto &triangle : triangles) flat.insert(flat.end(), triangle.begin(), triangle.end());
+    return flat;
+}
+
+inline std::vector<u32> triangle_set(const Model &model, u32 accessor) {
+    std::vector<u32> indices;
+    CHECK(read_indices(model, accessor, 0, indices));
+    return triangle_set(indices);
+}
+
+inline void add_channel(Model &model, u32 input, u32 output, const char *interpolation, u32 node, const char *path) {
+    Animation &animation = model.animations.back();
+
+    AnimationSampler sampler;
+    sampler.input = input;
+    sampler.output = output;
+    sampler.interpolation = interpolation;
+    animation.samplers.push_back(sampler);
+
+    AnimationChannel channel;
+    channel.sampler = (u32)animation.samplers.size() - 1;
+    channel.target.node = node;
+    channel.target.path = path;
+    animation.channels.push_back(channel);
+}
+
+// Three nodes animated over uneven key times: node 0 with LINEAR translation and rotation (turning past 180 degrees,
+// so w changes sign), node 1 with STEP scale and CUBICSPLINE translation, node 2 with LINEAR morph weights
+inline Model make_animated_model() {
+    Model model;
+    model.nodes.resize(3);
+    model.nodes[0].children.push_back(1);
+    model.nodes[2].mesh = 0;
+    model.meshes.resize(1);
+    model.meshes[0].weights = {0.0f, 0.0f};
+    model.scenes.resize(1);
+    model.scenes[0].nodes = {0, 2};
+    model.animations.resize(1);
+
+    const u32 KEYS = 6;
+    std::vector<f32> times = {0.0f, 0.25f, 0.3f, 1.0f, 1.75f, 2.0f};
+    std::vector<f32> translations, rotations, scales, tangent_translations, weights;
+    for (u32 k = 0; k < KEYS; k++) {
+        f32 t = times[k];
+        translations.insert(translations.end(), {100.0f + 3.0f * t, std::sin(4.0f * t), -2.0f * t * t});
+
+        f32 angle = 2.2f * t, s = std::sin(angle * 0.5f);
+        rotations.insert(rotations.end(), {0.6f * s, 0.0f, 0.8f * s, std::cos(angle * 0.5f)});
+
+        scales.insert(scales.end(), {1.0f + t, 2.0f - 0.5f * t, 0.5f + 0.25f * t});
+
+        // In tangent, value, out tangent
+        tangent_translations.insert(tangent_translations.end(), {0.5f, -1.0f, 0.0f, t, 1.0f - t, 2.0f * t,
+                                                                 -0.5f, 1.0f, 0.25f});
+
+        weights.insert(weights.end(), {0.5f + 0.5f * std::cos(3.0f * t), 0.5f - 0.5f * std::cos(3.0f * t)});
+    }
+
+    u32 input = add_float_accessor(model, times, "SCALAR", 0);
+    add_channel(model, input, add_float_accessor(model, translations, "VEC3", 0), "LINEAR", 0, "translation");
+    add_channel(model, input, add_float_accessor(model, rotations, "VEC4", 0), "LINEAR", 0, "rotation");
+    add_channel(model, input, add_float_accessor(model, scales, "VEC3", 0), "STEP", 1, "scale");
+    add_channel(model, input, add_float_accessor(model, tangent_translations, "VEC3", 0), "CUBICSPLINE", 1,
+                "translation");
+    add_channel(model, input, add_float_accessor(model, weights, "SCALAR", 0), "LINEAR", 2, "weights");
+    return model;
+}
+
+}; // namespace test
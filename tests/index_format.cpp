@@ -0,0 +1,78 @@
+// Narrowing and widening keep index values, and compact_buffers() keeps every accessor aligned to its component size
+#include "common.hpp"
+#include "index_format.hpp"
+#include <cstring>
+
+using namespace test;
+
+static void check_narrow_and_widen() {
+    Model model;
+    std::vector<u32> indices = {0, 1, 2, 2, 1, 200};
+    Accessor accessor;
+    accessor.buffer_view = append_buffer_view(model, indices.data(), indices.size() * sizeof(u32), 0,
+                                              TARGET_ELEMENT_ARRAY_BUFFER);
+    accessor.component_type = COMPONENT_UNSIGNED_INT;
+    accessor.count = indices.size();
+    accessor.type = "SCALAR";
+
+    Primitive primitive;
+    primitive.indices = add_accessor(model, accessor);
+
+    std::vector<u32> read;
+    CHECK(narrow_indices(model, primitive, true));
+    CHECK(model.accessors[primitive.indices].component_type == COMPONENT_UNSIGNED_BYTE);
+    CHECK(read_indices(model, primitive.indices, 0, read) && read == indices);
+
+    CHECK(widen_indices(model, primitive));
+    CHECK(model.accessors[primitive.indices].component_type == COMPONENT_UNSIGNED_INT);
+    CHECK(read_indices(model, primitive.indices, 0, read) && read == indices);
+
+    // 255 is the u8 primitive restart value, so it needs u16
+    CHECK(minimal_index_type(254, true) == COMPONENT_UNSIGNED_BYTE);
+    CHECK(minimal_index_type(255, true) == COMPONENT_UNSIGNED_SHORT);
+    CHECK(minimal_index_type(65535) == COMPONENT_UNSIGNED_INT);
+}
+
+// A view starting at byte 6 holds a u16 at its start and a float 2 bytes in, aligned only through the view's offset
+static void check_compact_alignment() {
+    std::vector<u8> data(16, 0);
+    const u16 index = 7;
+    const f32 value = 1.5f;
+    std::memcpy(data.data() + 6, &index, sizeof(index));
+    std::memcpy(data.data() + 8, &value, sizeof(value));
+
+    Model model;
+    u32 buffer = add_buffer(model, data);
+    add_buffer_view(model, buffer, 0, 6, 0, 0); // Unreferenced, dropped by compaction
+    u32 view = add_buffer_view(model, buffer, 6, 6, 0, 0);
+
+    Accessor accessor;
+    accessor.buffer_view = view;
+    accessor.component_type = COMPONENT_UNSIGNED_SHORT;
+    accessor.count = 1;
+    accessor.type = "SCALAR";
+    u32 short_accessor = add_accessor(model, accessor);
+    accessor.byte_offset = 2;
+    accessor.component_type = COMPONENT_FLOAT;
+    u32 float_accessor = add_accessor(model, accessor);
+
+    CHECK(compact_buffers(model));
+    CHECK(model.buffer_views.size() == 1);
+    for (const Accessor &compacted : model.accessors) {
+        usize offset = model.buffer_views[compacted.buffer_view].byte_offset + compacted.byte_offset;
+        CHECK(offset % component_size(compacted.component_type) == 0);
+    }
+
+    std::vector<u32> indices;
+    std::vector<f32> floats;
+    CHECK(read_indices(model, short_accessor, 0, indices) && indices == std::vector<u32>({7}));
+    CHECK(read_floats(model, float_accessor, floats) && floats == std::vector<f32>({1.5f}));
+}
+
+int main() {
+    check_narrow_and_widen();
+    check_compact_alignment();
+
+    std::printf("index_format: ok\n");
+    return 0;
+}
@@ -0,0 +1,69 @@
+// Keyframes quantized to normalized i16 must survive a GLB round trip: the stored component types, the range
+// quantization of translations and scales and the sampled values
+#include "animation.hpp"
+#include "common.hpp"
+#include "keyframes.hpp"
+#include <fstream>
+#include <iterator>
+#include <string>
+
+using namespace test;
+
+static const char *PATH = "keyframes_quantized.glb";
+
+static void sample_clip(const Model &model, std::vector<f32> &values) {
+    AnimationClip clip;
+    CHECK(build_animation_clip(model, 0, clip));
+
+    values.clear();
+    for (const AnimationTrack &track : clip.tracks) {
+        for (u32 step = 0; step <= 40; step++) {
+            f32 out[4];
+            sample_track(track, step * 0.05f, out);
+            values.insert(values.end(), out, out + track.width);
+        }
+    }
+}
+
+int main() {
+    Model model = make_animated_model();
+    std::vector<f32> expected;
+    sample_clip(model, expected);
+
+    KeyframeQuantizeOptions options;
+    options.translations = true;
+    options.scales = true;
+    CHECK(quantize_animations(model, options));
+    compact_accessors(model);
+    CHECK(compact_buffers(model));
+    CHECK(model.save_as_glb(PATH));
+
+    // The range-quantized samplers make the file depend on the vendor extension
+    std::ifstream file(PATH, std::ios::binary);
+    std::string contents((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    CHECK(contents.find("\"extensionsRequired\":[\"XIUXIU_animation_dequantize\"]") != std::string::npos);
+
+    bool success = false;
+    Model loaded = Model::load(success, PATH);
+    CHECK(success);
+    CHECK(loaded.animations.size() == 1 && loaded.animations[0].samplers.size() == 5);
+    for (const AnimationChannel &channel : loaded.animations[0].channels) {
+        const AnimationSampler &sampler = loaded.animations[0].samplers[channel.sampler];
+        const Accessor &output = loaded.accessors[sampler.output];
+        CHECK(output.component_type == COMPONENT_SHORT && output.normalized);
+
+        bool ranged = channel.target.path == "translation" || channel.target.path == "scale";
+        CHECK(sampler.dequantize_offset.size() == (ranged ? 3u : 0u));
+        CHECK(sampler.dequantize_scale.size() == sampler.dequantize_offset.size());
+    }
+
+    // Within one i16 step of each sampler's range; the widest range here spans 8 units
+    std::vector<f32> sampled;
+    sample_clip(loaded, sampled);
+    CHECK(sampled.size() == expected.size());
+    for (usize i = 0; i < expected.size(); i++) CHECK(near(sampled[i], expected[i], 8.0f / 32767.0f));
+
+    std::remove(PATH);
+    std::printf("keyframes: ok\n");
+    return 0;
+}
@@ -0,0 +1,102 @@
+// Inverses, TRS round trips and the batched kernels against their one-at-a-time forms
+#include "common.hpp"
+#include "math.hpp"
+
+using namespace test;
+
+static u32 seed = 99;
+
+static f32 next_float(f32 lo, f32 hi) {
+    seed = seed * 1664525u + 1013904223u;
+    return lo + (hi - lo) * (f32)(seed >> 8) / (f32)(1u << 24);
+}
+
+static Mat4 random_trs() {
+    Vec4 rotation = quat_normalize({next_float(-1, 1), next_float(-1, 1), next_float(-1, 1), next_float(-1, 1)});
+    return compose_trs({next_float(-10, 10), next_float(-10, 10), next_float(-10, 10)}, rotation,
+                       {next_float(0.2f, 3), next_float(0.2f, 3), next_float(0.2f, 3)});
+}
+
+static bool near(const Mat4 &a, const Mat4 &b, f32 tolerance) {
+    for (usize i = 0; i < 16; i++) {
+        if (!test::near(a.m[i], b.m[i], tolerance)) return false;
+    }
+    return true;
+}
+
+static void check_inverses() {
+    for (u32 i = 0; i < 100; i++) {
+        Mat4 matrix = random_trs(), inverse, affine;
+        CHECK(mat4_inverse(matrix, inverse));
+        CHECK(mat4_affine_inverse(matrix, affine));
+        CHECK(near(mat4_multiply(matrix, inverse), Mat4::identify(), 1e-4f));
+        CHECK(near(mat4_multiply(inverse, matrix), Mat4::identify(), 1e-4f));
+        CHECK(near(affine, inverse, 1e-4f));
+        CHECK(affine.cols[0][3] == 0.0f && affine.cols[3][3] == 1.0f);
+    }
+
+    // A projective last row only mat4_inverse() handles
+    Mat4 projection = {{1.5f, 0, 0, 0, 0, 2.0f, 0, 0, 0, 0, -1.2f, -1.0f, 0, 0, -0.22f, 0}};
+    Mat4 inverse;
+    CHECK(mat4_inverse(projection, inverse));
+    CHECK(near(mat4_multiply(projection, inverse), Mat4::identify(), 1e-5f));
+
+    // Singular: a zero scale axis. The output is left untouched.
+    Mat4 flat = compose_trs({1, 2, 3}, {0, 0, 0, 1}, {1, 0, 1});
+    Mat4 untouched = projection;
+    CHECK(!mat4_inverse(flat, untouched) && near(untouched, projection, 0.0f));
+    CHECK(!mat4_affine_inverse(flat, untouched) && near(untouched, projection, 0.0f));
+}
+
+static void check_trs_round_trip() {
+    for (u32 i = 0; i < 100; i++) {
+        Vec3 translation = {next_float(-5, 5), next_float(-5, 5), next_float(-5, 5)};
+        Vec4 rotation = quat_normalize({next_float(-1, 1), next_float(-1, 1), next_float(-1, 1), next_float(-1, 1)});
+        // Every fourth matrix mirrors, which decompose_trs() folds into scale.x
+        Vec3 scale = {next_float(0.5f, 2) * (i % 4 == 0 ? -1.0f : 1.0f), next_float(0.5f, 2), next_float(0.5f, 2)};
+
+        Vec3 t, s;
+        Vec4 r;
+        Mat4 matrix = compose_trs(translation, rotation, scale);
+        decompose_trs(matrix, t, r, s);
+        CHECK(near(t, translation, 1e-4f));
+        CHECK(near(s, scale, 1e-4f));
+        CHECK(near(r, rotation, 1e-4f));
+        CHECK(near(compose_trs(t, r, s), matrix, 1e-4f));
+    }
+}
+
+static void check_batches() {
+    // Not a multiple of four, so the kernels' tails run too
+    const usize COUNT = 11;
+    std::vector<Mat4> a(COUNT), b(COUNT), out(COUNT);
+    for (usize i = 0; i < COUNT; i++) a[i] = random_trs(), b[i] = random_trs();
+
+    mat4_multiply_batch(a.data(), b.data(), out.data(), COUNT);
+    for (usize i = 0; i < COUNT; i++) CHECK(near(out[i], mat4_multiply(a[i], b[i]), 1e-4f));
+
+    // In place
+    std::vector<Mat4> expected = out;
+    for (usize i = 0; i < COUNT; i++) expected[i] = mat4_multiply(a[i], out[i]);
+    mat4_multiply_batch(a.data(), out.data(), out.data(), COUNT);
+    for (usize i = 0; i < COUNT; i++) CHECK(near(out[i], expected[i], 1e-3f));
+
+    Mat4 matrix = random_trs();
+    std::vector<Vec3> points(COUNT), transformed(COUNT);
+    for (Vec3 &point : points) point = {next_float(-1, 1), next_float(-1, 1), next_float(-1, 1)};
+    transform_points(matrix, points.data(), transformed.data(), COUNT);
+    for (usize i = 0; i < COUNT; i++) CHECK(near(transformed[i], transform_point(matrix, points[i]), 1e-5f));
+
+    transformed = points;
+    transform_vectors(matrix, transformed.data(), transformed.data(), COUNT);
+    for (usize i = 0; i < COUNT; i++) CHECK(near(transformed[i], transform_vector(matrix, points[i]), 1e-5f));
+}
+
+int main() {
+    check_inverses();
+    check_trs_round_trip();
+    check_batches();
+
+    std::printf("math: ok\n");
+    return 0;
+}
@@ -0,0 +1,183 @@
+// Ray queries against a mesh BVH must agree with testing every triangle, and hits must lie on the reported triangle
+#include "common.hpp"
+#include "mesh_bvh.hpp"
+
+using namespace test;
+
+static u32 seed = 777;
+
+static f32 next_float(f32 lo, f32 hi) {
+    seed = seed * 1664525u + 1013904223u;
+    return lo + (hi - lo) * (f32)(seed >> 8) / (f32)(1u << 24);
+}
+
+static Vec3 sub(const Vec3 &a, const Vec3 &b) {
+    return {a.x - b.x, a.y - b.y, a.z - b.z};
+}
+
+static Vec3 cross(const Vec3 &a, const Vec3 &b) {
+    return {a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x};
+}
+
+static f32 dot(const Vec3 &a, const Vec3 &b) {
+    return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+struct Triangle {
+    Vec3 corners[3];
+};
+
+// Every triangle of every primitive, as [primitive][triangle]
+static std::vector<std::vector<Triangle>> read_triangles(const Model &model, u32 mesh) {
+    std::vector<std::vector<Triangle>> triangles;
+    for (const Primitive &primitive : model.meshes[mesh].primitives) {
+        std::vector<f32> positions;
+        CHECK(read_floats(model, primitive.attributes.at("POSITION"), positions));
+        std::vector<u32> indices;
+        if (primitive.indices != UINT32_MAX) {
+            CHECK(read_indices(model, primitive.indices, 0, indices));
+        } else {
+            for (u32 i = 0; i < positions.size() / 3; i++) indices.push_back(i);
+        }
+
+        triangles.emplace_back();
+        for (usize i = 0; i + 2 < indices.size(); i += 3) {
+            Triangle triangle;
+            for (usize c = 0; c < 3; c++) {
+                const f32 *p = &positions[indices[i + c] * 3];
+                triangle.corners[c] = {p[0], p[1], p[2]};
+            }
+            triangles.back().push_back(triangle);
+        }
+    }
+    return triangles;
+}
+
+// Moller-Trumbore, both sides
+static bool intersect_triangle(const Triangle &triangle, const Vec3 &origin, const Vec3 &direction, f32 &distance) {
+    Vec3 e1 = sub(triangle.corners[1], triangle.corners[0]), e2 = sub(triangle.corners[2], triangle.corners[0]);
+    Vec3 p = cross(direction, e2);
+    f32 det = dot(e1, p);
+    if (std::fabs(det) < 1e-12f) return false;
+
+    Vec3 s = sub(origin, triangle.corners[0]);
+    f32 u = dot(s, p) / det;
+    if (u < 0.0f || u > 1.0f) return false;
+    Vec3 q = cross(s, e1);
+    f32 v = dot(direction, q) / det;
+    if (v < 0.0f || u + v > 1.0f) return false;
+
+    distance = dot(e2, q) / det;
+    return distance >= 0.0f;
+}
+
+// An indexed sphere and a non-indexed, interleaved ground quad in one mesh
+static Model make_mesh() {
+    Model model;
+    const u32 SEGMENTS = 24, RINGS = 12;
+    std::vector<f32> positions;
+    std::vector<u32> indices;
+    for (u32 r = 0; r <= RINGS; r++) {
+        for (u32 s = 0; s <= SEGMENTS; s++) {
+            f32 theta = 3.14159265f * r / RINGS, phi = 2.0f * 3.14159265f * s / SEGMENTS;
+            positions.insert(positions.end(), {std::sin(theta) * std::cos(phi), std::cos(theta),
+                                               std::sin(theta) * std::sin(phi)});
+        }
+    }
+    for (u32 r = 0; r < RINGS; r++) {
+        for (u32 s = 0; s < SEGMENTS; s++) {
+            u32 a = r * (SEGMENTS + 1) + s, b = a + 1, c = a + SEGMENTS + 1, d = c + 1;
+            indices.insert(indices.end(), {a, c, b, b, c, d});
+        }
+    }
+
+    Primitive sphere;
+    sphere.attributes["POSITION"] = add_float_accessor(model, positions, "VEC3", TARGET_ARRAY_BUFFER);
+    sphere.indices = add_index_accessor(model, indices, (u32)(positions.size() / 3));
+
+    // Position and a texture coordinate per vertex, so positions are read through a 20-byte stride
+    const f32 ground[] = {-3.0f, -1.5f, -3.0f, 0.0f, 0.0f, 3.0f, -1.5f, -3.0f, 1.0f, 0.0f,
+                          3.0f,  -1.5f, 3.0f,  1.0f, 1.0f, -3.0f, -1.5f, -3.0f, 0.0f, 0.0f,
+                          3.0f,  -1.5f, 3.0f,  1.0f, 1.0f, -3.0f, -1.5f, 3.0f,  0.0f, 1.0f};
+    u32 view = append_buffer_view(model, ground, sizeof(ground), 20, TARGET_ARRAY_BUFFER);
+    Accessor accessor;
+    accessor.buffer_view = view;
+    accessor.component_type = COMPONENT_FLOAT;
+    accessor.count = 6;
+    accessor.type = "VEC3";
+    Primitive quad;
+    quad.attributes["POSITION"] = add_accessor(model, accessor);
+
+    model.meshes.resize(1);
+    model.meshes[0].primitives = {sphere, quad};
+    return model;
+}
+
+int main() {
+    Model model = make_mesh();
+    MeshBvh bvh;
+    CHECK(build_mesh_bvh(model, 0, bvh));
+    std::vector<std::vector<Triangle>> triangles = read_triangles(model, 0);
+
+    const u32 RAYS = 512;
+    const f32 FAR = 100.0f;
+    std::vector<Vec3> origins(RAYS), directions(RAYS);
+    for (u32 i = 0; i < RAYS; i++) {
+        origins[i] = {next_float(-4.0f, 4.0f), next_float(-4.0f, 4.0f), next_float(3.0f, 5.0f)};
+        Vec3 target = {next_float(-2.0f, 2.0f), next_float(-2.0f, 2.0f), next_float(-2.0f, 2.0f)};
+        directions[i] = sub(target, origins[i]);
+    }
+
+    std::vector<MeshHit> packet(RAYS);
+    intersect_rays(bvh, origins.data(), directions.data(), RAYS, FAR, packet.data());
+
+    u32 hits = 0;
+    for (u32 i = 0; i < RAYS; i++) {
+        f32 closest = FAR;
+        bool expected = false;
+        for (const auto &primitive : triangles) {
+            for (const Triangle &triangle : primitive) {
+                f32 distance;
+                if (intersect_triangle(triangle, origins[i], directions[i], distance) && distance <= closest) {
+                    closest = distance;
+                    expected = true;
+                }
+            }
+        }
+
+        MeshHit hit;
+        bool found = intersect_ray(bvh, origins[i], directions[i], FAR, hit);
+        CHECK(found == expected);
+        CHECK(intersect_any(bvh, origins[i], directions[i], FAR) == expected);
+        CHECK((packet[i].primitive != UINT32_MAX) == expected);
+        if (!found) continue;
+        hits++;
+
+        // Edges shared by two triangles may report either, at the same distance
+        CHECK(near(hit.distance, closest, 1e-4f));
+        CHECK(near(packet[i].distance, closest, 1e-4f));
+
+        // The barycentric point of the reported triangle is where the ray is at the reported distance
+        const Triangle &triangle = triangles[hit.primitive][hit.triangle];
+        f32 w = 1.0f - hit.u - hit.v;
+        Vec3 on_triangle = {
+            w * triangle.corners[0].x + hit.u * triangle.corners[1].x + hit.v * triangle.corners[2].x,
+            w * triangle.corners[0].y + hit.u * triangle.corners[1].y + hit.v * triangle.corners[2].y,
+            w * triangle.corners[0].z + hit.u * triangle.corners[1].z + hit.v * triangle.corners[2].z};
+        Vec3 on_ray = {origins[i].x + directions[i].x * hit.distance, origins[i].y + directions[i].y * hit.distance,
+                       origins[i].z + directions[i].z * hit.distance};
+        CHECK(near(on_triangle, on_ray, 1e-3f));
+    }
+    // Both the sphere and the ground are hit, and some rays miss
+    CHECK(hits > RAYS / 4 && hits < RAYS);
+
+    // A distance limit short of the sphere turns hits into misses
+    MeshHit hit;
+    CHECK(intersect_ray(bvh, {0.0f, 0.0f, 5.0f}, {0.0f, 0.0f, -1.0f}, FAR, hit) && hit.primitive == 0);
+    CHECK(near(hit.distance, 4.0f, 1e-2f));
+    CHECK(!intersect_ray(bvh, {0.0f, 0.0f, 5.0f}, {0.0f, 0.0f, -1.0f}, 3.5f, hit));
+    CHECK(!intersect_any(bvh, {0.0f, 0.0f, 5.0f}, {0.0f, 0.0f, -1.0f}, 3.5f));
+
+    std::printf("mesh_bvh: ok\n");
+    return 0;
+}
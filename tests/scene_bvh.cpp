@@ -0,0 +1,178 @@
+// A scene BVH must hold every reachable primitive once, enclose its items at every level, answer box, frustum and ray
+// queries like a test of every item, and keep doing so after the nodes move and the BVH is refit
+#include "bounds.hpp"
+#include "common.hpp"
+#include "math.hpp"
+#include "scene_bvh.hpp"
+#include "transform.hpp"
+#include <algorithm>
+
+using namespace test;
+
+static u32 seed = 31337;
+
+static f32 next_float(f32 lo, f32 hi) {
+    seed = seed * 1664525u + 1013904223u;
+    return lo + (hi - lo) * (f32)(seed >> 8) / (f32)(1u << 24);
+}
+
+static bool contains(const Vec3 &min, const Vec3 &max, const Vec3 &inner_min, const Vec3 &inner_max) {
+    const f32 slack = 1e-4f;
+    return min.x <= inner_min.x + slack && min.y <= inner_min.y + slack && min.z <= inner_min.z + slack &&
+           max.x >= inner_max.x - slack && max.y >= inner_max.y - slack && max.z >= inner_max.z - slack;
+}
+
+// Two primitives per mesh: a unit cube and a smaller one beside it
+static Model make_scene(u32 node_count) {
+    Model model;
+    model.meshes.resize(1);
+    for (f32 offset : {0.0f, 1.5f}) {
+        std::vector<f32> positions;
+        for (u32 corner = 0; corner < 8; corner++) {
+            f32 size = offset > 0.0f ? 0.25f : 0.5f;
+            positions.insert(positions.end(), {offset + (corner & 1 ? size : -size), corner & 2 ? size : -size,
+                                               corner & 4 ? size : -size});
+        }
+        Primitive primitive;
+        primitive.attributes["POSITION"] = add_float_accessor(model, positions, "VEC3", TARGET_ARRAY_BUFFER);
+        model.meshes[0].primitives.push_back(primitive);
+    }
+
+    // Node 1 is never reachable from the scene
+    model.nodes.resize(node_count);
+    for (u32 n = 0; n < node_count; n++) {
+        model.nodes[n].translation = {next_float(-20, 20), next_float(-20, 20), next_float(-20, 20)};
+        model.nodes[n].mesh = n % 3 == 0 ? UINT32_MAX : 0;
+        if (n > 1) model.nodes[n == 2 ? 0 : (u32)next_float(2, (f32)n)].children.push_back(n);
+    }
+    model.nodes[0].translation = Vec3::zero();
+    model.scenes.resize(1);
+    model.scenes[0].nodes = {0};
+    return model;
+}
+
+static bool outside(const Frustum &frustum, const SceneBvhItem &item) {
+    for (const Vec4 &plane : frustum.planes) {
+        f32 far_side = plane.x * (plane.x >= 0.0f ? item.max.x : item.min.x) +
+                       plane.y * (plane.y >= 0.0f ? item.max.y : item.min.y) +
+                       plane.z * (plane.z >= 0.0f ? item.max.z : item.min.z) + plane.w;
+        if (far_side < 0.0f) return true;
+    }
+    return false;
+}
+
+// Slab test over [0, max_distance]
+static bool ray_hits(const SceneBvhItem &item, const Vec3 &origin, const Vec3 &direction, f32 max_distance) {
+    const f32 o[3] = {origin.x, origin.y, origin.z}, d[3] = {direction.x, direction.y, direction.z};
+    const f32 lo[3] = {item.min.x, item.min.y, item.min.z}, hi[3] = {item.max.x, item.max.y, item.max.z};
+    f32 enter = 0.0f, exit = max_distance;
+    for (usize c = 0; c < 3; c++) {
+        f32 t0 = (lo[c] - o[c]) / d[c], t1 = (hi[c] - o[c]) / d[c];
+        enter = std::max(enter, std::min(t0, t1));
+        exit = std::min(exit, std::max(t0, t1));
+    }
+    return enter <= exit;
+}
+
+static void check_structure(const Model &model, const SceneBvh &bvh) {
+    // Every primitive of every mesh node reachable from the scene, once
+    std::vector<u32> expected, found;
+    std::vector<u32> stack(model.scenes[0].nodes);
+    while (!stack.empty()) {
+        u32 n = stack.back();
+        stack.pop_back();
+        if (model.nodes[n].mesh != UINT32_MAX) expected.insert(expected.end(), {n * 2, n * 2 + 1});
+        stack.insert(stack.end(), model.nodes[n].children.begin(), model.nodes[n].children.end());
+    }
+    for (const SceneBvhItem &item : bvh.items) {
+        found.push_back(item.node * 2 + item.primitive);
+
+        Bounds world = transform_bounds(model.bounds.primitives[item.mesh][item.primitive],
+                                        world_transform(model, item.node));
+        CHECK(near(item.min, world.min, 1e-4f) && near(item.max, world.max, 1e-4f));
+    }
+    std::sort(expected.begin(), expected.end());
+    std::sort(found.begin(), found.end());
+    CHECK(found == expected);
+
+    for (u32 i = 0; i < bvh.nodes.size(); i++) {
+        const SceneBvhNode &node = bvh.nodes[i];
+        if (node.count > 0) {
+            for (u32 item = node.first; item < node.first + node.count; item++) {
+                CHECK(contains(node.min, node.max, bvh.items[item].min, bvh.items[item].max));
+            }
+            continue;
+        }
+        CHECK(node.first > i && node.first + 1 < bvh.nodes.size());
+        for (u32 child = node.first; child < node.first + 2; child++) {
+            CHECK(contains(node.min, node.max, bvh.nodes[child].min, bvh.nodes[child].max));
+        }
+    }
+}
+
+static void check_queries(const SceneBvh &bvh) {
+    std::vector<u32> items, expected;
+    for (u32 query = 0; query < 20; query++) {
+        Vec3 center = {next_float(-25, 25), next_float(-25, 25), next_float(-25, 25)};
+        Vec3 min = {center.x - 6.0f, center.y - 6.0f, center.z - 6.0f};
+        Vec3 max = {center.x + 6.0f, center.y + 6.0f, center.z + 6.0f};
+        items.clear();
+        expected.clear();
+        query_aabb(bvh, min, max, items);
+        for (u32 i = 0; i < bvh.items.size(); i++) {
+            const SceneBvhItem &item = bvh.items[i];
+            bool overlaps = item.min.x <= max.x && item.max.x >= min.x && item.min.y <= max.y &&
+                            item.max.y >= min.y && item.min.z <= max.z && item.max.z >= min.z;
+            if (overlaps) expected.push_back(i);
+        }
+        std::sort(items.begin(), items.end());
+        CHECK(items == expected);
+
+        Vec3 direction = {next_float(-1, 1), next_float(-1, 1), next_float(-1, 1)};
+        std::vector<SceneBvhHit> hits;
+        query_ray(bvh, center, direction, 30.0f, hits);
+        items.clear();
+        expected.clear();
+        for (usize h = 0; h < hits.size(); h++) {
+            CHECK(h == 0 || hits[h - 1].distance <= hits[h].distance);
+            items.push_back(hits[h].item);
+        }
+        for (u32 i = 0; i < bvh.items.size(); i++) {
+            if (ray_hits(bvh.items[i], center, direction, 30.0f)) expected.push_back(i);
+        }
+        std::sort(items.begin(), items.end());
+        CHECK(items == expected);
+    }
+
+    // Camera at z = 20 looking down -z with a 90 degree field of view, near 0.1 and far 30
+    Mat4 projection = {{1.0f, 0, 0, 0, 0, 1.0f, 0, 0, 0, 0, -30.1f / 29.9f, -1.0f, 0, 0, -6.0f / 29.9f, 0}};
+    Mat4 view = compose_trs({0.0f, 0.0f, -20.0f}, {0, 0, 0, 1}, {1, 1, 1});
+    Frustum frustum = frustum_from_matrix(mat4_multiply(projection, view));
+    items.clear();
+    expected.clear();
+    query_frustum(bvh, frustum, items);
+    for (u32 i = 0; i < bvh.items.size(); i++) {
+        if (!outside(frustum, bvh.items[i])) expected.push_back(i);
+    }
+    std::sort(items.begin(), items.end());
+    CHECK(items == expected);
+    CHECK(!expected.empty() && expected.size() < bvh.items.size());
+}
+
+int main() {
+    Model model = make_scene(150);
+    SceneBvh bvh;
+    CHECK(build_scene_bvh(model, 0, bvh, 4));
+    check_structure(model, bvh);
+    check_queries(bvh);
+
+    for (u32 n = 2; n < model.nodes.size(); n += 4) {
+        set_translation(model, n, {next_float(-20, 20), next_float(-20, 20), next_float(-20, 20)});
+    }
+    refit_scene_bvh(model, bvh);
+    check_structure(model, bvh);
+    check_queries(bvh);
+
+    std::printf("scene_bvh: ok\n");
+    return 0;
+}
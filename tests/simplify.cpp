@@ -0,0 +1,146 @@
+// Simplification reaches its target without tearing seams or moving locked borders, and only reuses input vertices
+#include "common.hpp"
+#include "simplify.hpp"
+#include <map>
+#include <utility>
+
+using namespace test;
+
+// UV sphere whose seam column and poles repeat their positions exactly, as exporters write them
+static void make_sphere(u32 segments, u32 rings, std::vector<f32> &positions, std::vector<u32> &indices) {
+    for (u32 r = 0; r <= rings; r++) {
+        for (u32 s = 0; s <= segments; s++) {
+            f32 theta = 3.14159265f * r / rings, phi = 2.0f * 3.14159265f * (s % segments) / segments;
+            f32 ring = r == 0 || r == rings ? 0.0f : std::sin(theta);
+            positions.insert(positions.end(), {ring * std::cos(phi), std::cos(theta), ring * std::sin(phi)});
+        }
+    }
+    for (u32 r = 0; r < rings; r++) {
+        for (u32 s = 0; s < segments; s++) {
+            u32 a = r * (segments + 1) + s, b = a + 1, c = a + segments + 1, d = c + 1;
+            if (r > 0) indices.insert(indices.end(), {a, c, b});
+            if (r + 1 < rings) indices.insert(indices.end(), {b, c, d});
+        }
+    }
+}
+
+// Every edge, with vertices identified by position, is shared by two triangles: the surface has no holes
+static bool closed(const std::vector<f32> &positions, const std::vector<u32> &indices) {
+    std::map<std::vector<f32>, u32> ids;
+    std::map<std::pair<u32, u32>, u32> edges;
+    for (usize i = 0; i < indices.size(); i += 3) {
+        u32 corner[3];
+        for (usize c = 0; c < 3; c++) {
+            const f32 *p = &positions[indices[i + c] * 3];
+            corner[c] = ids.insert(std::make_pair(std::vector<f32>(p, p + 3), (u32)ids.size())).first->second;
+        }
+        for (usize c = 0; c < 3; c++) {
+            u32 a = corner[c], b = corner[(c + 1) % 3];
+            edges[std::make_pair(std::min(a, b), std::max(a, b))]++;
+        }
+    }
+    for (const auto &edge : edges) {
+        if (edge.second != 2) return false;
+    }
+    return true;
+}
+
+static void check_sphere() {
+    std::vector<f32> positions;
+    std::vector<u32> indices;
+    make_sphere(48, 24, positions, indices);
+    usize vertex_count = positions.size() / 3;
+    CHECK(closed(positions, indices));
+
+    std::vector<u32> simplified(indices.size());
+    f32 error = -1.0f;
+    usize target = indices.size() / 4 / 3 * 3;
+    usize written = simplify(simplified.data(), indices.data(), indices.size(), positions.data(), vertex_count, target,
+                             0.05f, false, &error);
+    simplified.resize(written);
+
+    CHECK(written > 0 && written <= target && written % 3 == 0);
+    CHECK(error >= 0.0f && error <= 0.05f);
+    for (usize i = 0; i < written; i += 3) {
+        CHECK(simplified[i] < vertex_count && simplified[i + 1] < vertex_count && simplified[i + 2] < vertex_count);
+        CHECK(simplified[i] != simplified[i + 1] && simplified[i + 1] != simplified[i + 2] &&
+              simplified[i + 2] != simplified[i]);
+    }
+    CHECK(closed(positions, simplified));
+
+    // A tight error budget stops early instead of reaching the target
+    std::vector<u32> careful(indices.size());
+    usize kept = simplify(careful.data(), indices.data(), indices.size(), positions.data(), vertex_count, target,
+                          1e-4f, false, &error);
+    CHECK(kept > written && error <= 1e-4f);
+}
+
+// A bumpy open grid: with lock_border, every edge of the original border survives
+static void check_locked_border() {
+    const u32 N = 16;
+    std::vector<f32> positions;
+    std::vector<u32> indices;
+    for (u32 y = 0; y <= N; y++) {
+        for (u32 x = 0; x <= N; x++) positions.insert(positions.end(), {(f32)x, (f32)y, 0.02f * ((x * 7 + y * 3) % 5)});
+    }
+    for (u32 y = 0; y < N; y++) {
+        for (u32 x = 0; x < N; x++) {
+            u32 a = y * (N + 1) + x, b = a + 1, c = a + N + 1, d = c + 1;
+            indices.insert(indices.end(), {a, b, d, a, d, c});
+        }
+    }
+
+    std::vector<u32> simplified(indices.size());
+    simplified.resize(simplify(simplified.data(), indices.data(), indices.size(), positions.data(),
+                               positions.size() / 3, indices.size() / 10, 0.5f, true));
+    CHECK(simplified.size() < indices.size() / 2);
+
+    std::vector<u8> border_edge((N + 1) * (N + 1) * 2, 0); // [vertex * 2 + (0: +x, 1: +y)] present on the border
+    for (usize i = 0; i < simplified.size(); i += 3) {
+        for (usize c = 0; c < 3; c++) {
+            u32 a = simplified[i + c], b = simplified[i + (c + 1) % 3];
+            u32 lo = std::min(a, b), hi = std::max(a, b);
+            u32 x = lo % (N + 1), y = lo / (N + 1);
+            bool on_border = ((y == 0 || y == N) && hi == lo + 1) || ((x == 0 || x == N) && hi == lo + N + 1);
+            if (on_border) border_edge[lo * 2 + (hi == lo + 1 ? 0 : 1)] = 1;
+        }
+    }
+    u32 border_edges = 0;
+    for (u8 present : border_edge) border_edges += present;
+    CHECK(border_edges == 4 * N);
+}
+
+static void check_lods() {
+    std::vector<f32> positions;
+    std::vector<u32> indices;
+    make_sphere(32, 16, positions, indices);
+
+    Model model;
+    Primitive primitive;
+    primitive.attributes["POSITION"] = add_float_accessor(model, positions, "VEC3", TARGET_ARRAY_BUFFER);
+    primitive.indices = add_index_accessor(model, indices, (u32)(positions.size() / 3));
+    model.meshes.resize(1);
+    model.meshes[0].primitives.push_back(primitive);
+
+    std::vector<std::vector<u32>> lods;
+    CHECK(generate_lods(model, LodOptions(), &lods));
+    CHECK(lods.size() == 1 && lods[0].size() == 3);
+
+    usize previous = indices.size();
+    for (u32 mesh : lods[0]) {
+        const Primitive &lod = model.meshes[mesh].primitives[0];
+        CHECK(lod.attributes.at("POSITION") == primitive.attributes["POSITION"]);
+        usize count = model.accessors[lod.indices].count;
+        CHECK(count > 0 && count < previous);
+        previous = count;
+    }
+}
+
+int main() {
+    check_sphere();
+    check_locked_border();
+    check_lods();
+
+    std::printf("simplify: ok\n");
+    return 0;
+}
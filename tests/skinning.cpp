@@ -0,0 +1,92 @@
+// Linear blend and dual quaternion skinning agree wherever blending cannot differ: vertices bound to one joint, and
+// vertices blending joints that share the same rigid transform
+#include "common.hpp"
+#include "math.hpp"
+#include "skinning.hpp"
+#include "transform.hpp"
+
+using namespace test;
+
+// Two joints, node 1 a child of node 0. Vertex v sits at (v, 1, 0) with normal +y; vertices 0-3 follow joint 0,
+// vertices 4-7 joint 1 and vertices 8-10 split their weight between both.
+static Primitive make_skinned_strip(Model &model) {
+    model.nodes.resize(3);
+    model.nodes[0].children.push_back(1);
+    model.nodes[2].mesh = 0;
+    model.nodes[2].skin = 0;
+    model.scenes.resize(1);
+    model.scenes[0].nodes = {0, 2};
+
+    Skin skin;
+    skin.joints = {0, 1};
+    model.skins.push_back(skin);
+
+    const u32 VERTICES = 11;
+    std::vector<f32> positions, normals, weights;
+    std::vector<u8> joints;
+    for (u32 v = 0; v < VERTICES; v++) {
+        positions.insert(positions.end(), {(f32)v, 1.0f, 0.0f});
+        normals.insert(normals.end(), {0.0f, 1.0f, 0.0f});
+        u8 first = v >= 4 && v < 8 ? 1 : 0, second = v >= 8 ? 1 : 0;
+        joints.insert(joints.end(), {first, second, 0, 0});
+        f32 split = v < 8 ? 1.0f : 0.25f * (v - 7);
+        weights.insert(weights.end(), {split, 1.0f - split, 0.0f, 0.0f});
+    }
+
+    Accessor accessor;
+    accessor.buffer_view = append_buffer_view(model, joints.data(), joints.size(), 0, TARGET_ARRAY_BUFFER);
+    accessor.component_type = COMPONENT_UNSIGNED_BYTE;
+    accessor.count = VERTICES;
+    accessor.type = "VEC4";
+
+    Primitive primitive;
+    primitive.attributes["POSITION"] = add_float_accessor(model, positions, "VEC3", TARGET_ARRAY_BUFFER);
+    primitive.attributes["NORMAL"] = add_float_accessor(model, normals, "VEC3", TARGET_ARRAY_BUFFER);
+    primitive.attributes["JOINTS_0"] = add_accessor(model, accessor);
+    primitive.attributes["WEIGHTS_0"] = add_float_accessor(model, weights, "VEC4", TARGET_ARRAY_BUFFER);
+    model.meshes.resize(1);
+    model.meshes[0].primitives.push_back(primitive);
+    return primitive;
+}
+
+// Skins with both methods and checks vertices [0, count) agree with each other and with the joint transform
+static void check_rigid(Model &model, const Primitive &primitive, usize count) {
+    update_transforms(model);
+
+    SkinBinding binding;
+    JointPalette linear, dual;
+    CHECK(bind_skinned_primitive(model, primitive, binding));
+    CHECK(build_joint_palette(model, 0, linear) && build_joint_palette(model, 0, dual, true));
+    CHECK(update_joint_palette(linear, model.transforms.world) && update_joint_palette(dual, model.transforms.world));
+
+    SkinnedVertices a, b;
+    CHECK(skin_vertices(binding, linear, a) && skin_vertices_dual_quaternion(binding, dual, b));
+    for (usize v = 0; v < count; v++) {
+        const Mat4 &joint = linear.matrices[binding.joints[v * binding.influences]];
+        Vec3 position = transform_point(joint, binding.positions[v]);
+        CHECK(near(a.positions[v], position, 1e-4f));
+        CHECK(near(b.positions[v], position, 1e-4f));
+        CHECK(near(a.normals[v], b.normals[v], 1e-5f));
+    }
+}
+
+int main() {
+    Model model;
+    Primitive primitive = make_skinned_strip(model);
+
+    // Joint 1 bent 90 degrees against joint 0: only the single-joint vertices must agree
+    f32 half = std::sqrt(0.5f);
+    set_translation(model, 0, {1.0f, -2.0f, 3.0f});
+    set_rotation(model, 0, {0.0f, half, 0.0f, half});
+    set_translation(model, 1, {4.0f, 0.0f, 0.0f});
+    set_rotation(model, 1, {0.0f, 0.0f, half, half});
+    check_rigid(model, primitive, 8);
+
+    // Joint 1 moved onto joint 0, so every vertex, blended or not, moves rigidly
+    set_translation(model, 1, {0.0f, 0.0f, 0.0f});
+    set_rotation(model, 1, {0.0f, 0.0f, 0.0f, 1.0f});
+    check_rigid(model, primitive, 11);
+
+    std::printf("skinning: ok\n");
+    return 0;
+}
@@ -0,0 +1,87 @@
+// Strips and fans unpack with the glTF winding, and stripifying a list gives back the same triangles
+#include "common.hpp"
+#include "topology.hpp"
+
+using namespace test;
+
+static std::vector<u32> unpack(const std::vector<u32> &indices, bool fan) {
+    std::vector<u32> list(indices.size() >= 2 ? (indices.size() - 2) * 3 : 0);
+    usize written = fan ? fan_to_list(list.data(), indices.data(), indices.size())
+                        : strip_to_list(list.data(), indices.data(), indices.size());
+    list.resize(written);
+    return list;
+}
+
+// Two triangles per cell of an n x n grid, all wound the same way
+static std::vector<u32> make_grid(u32 n) {
+    std::vector<u32> indices;
+    for (u32 y = 0; y < n; y++) {
+        for (u32 x = 0; x < n; x++) {
+            u32 a = y * (n + 1) + x, b = a + 1, c = a + n + 1, d = c + 1;
+            indices.insert(indices.end(), {a, b, d, a, d, c});
+        }
+    }
+    return indices;
+}
+
+static void check_kernels() {
+    // Every other strip triangle swaps its last two corners: triangle i is {v[i], v[i + 1 + i % 2], v[i + 2 - i % 2]}
+    CHECK(unpack({0, 1, 2, 3, 4}, false) == std::vector<u32>({0, 1, 2, 1, 3, 2, 2, 3, 4}));
+    CHECK(unpack({0, 1, 2, 3}, true) == std::vector<u32>({1, 2, 0, 2, 3, 0}));
+
+    // Restarts begin a new strip or fan; degenerate triangles are dropped
+    CHECK(unpack({0, 1, 2, RESTART_INDEX, 5, 6, 7}, false) == std::vector<u32>({0, 1, 2, 5, 6, 7}));
+    CHECK(unpack({0, 1, 2, RESTART_INDEX, 5, 6, 7}, true) == std::vector<u32>({1, 2, 0, 6, 7, 5}));
+    CHECK(unpack({0, 1, 2, 2, 5, 5, 6, 7}, false).size() == 6);
+
+    std::vector<u32> list = make_grid(8);
+    for (bool use_restart : {false, true}) {
+        std::vector<u32> strip(list.size() / 3 * 6);
+        strip.resize(list_to_strip(strip.data(), list.data(), list.size(), use_restart));
+        CHECK(strip.size() < list.size());
+        CHECK(triangle_set(unpack(strip, false)) == triangle_set(list));
+    }
+}
+
+static void check_primitives() {
+    std::vector<u32> list = make_grid(8);
+    std::vector<f32> positions(81 * 3, 0.0f);
+
+    for (bool use_restart : {false, true}) {
+        Model model;
+        Primitive primitive;
+        primitive.attributes["POSITION"] = add_float_accessor(model, positions, "VEC3", TARGET_ARRAY_BUFFER);
+        primitive.indices = add_index_accessor(model, list, 81);
+
+        CHECK(convert_to_strip(model, primitive, use_restart));
+        CHECK(primitive.mode == MODE_TRIANGLE_STRIP);
+        CHECK(convert_to_triangles(model, primitive));
+        CHECK(primitive.mode == MODE_TRIANGLES);
+        CHECK(triangle_set(model, primitive.indices) == triangle_set(list));
+    }
+
+    // A non-indexed fan over vertices 0..5
+    Model model;
+    Primitive fan;
+    fan.attributes["POSITION"] = add_float_accessor(model, std::vector<f32>(6 * 3, 0.0f), "VEC3", TARGET_ARRAY_BUFFER);
+    fan.mode = MODE_TRIANGLE_FAN;
+    CHECK(convert_to_triangles(model, fan));
+    std::vector<u32> indices;
+    CHECK(read_indices(model, fan.indices, 6, indices));
+    CHECK(indices == std::vector<u32>({1, 2, 0, 2, 3, 0, 3, 4, 0, 4, 5, 0}));
+
+    // Lists that do not shrink as strips are left alone by default
+    Model single;
+    Primitive triangle;
+    triangle.attributes["POSITION"] = add_float_accessor(single, std::vector<f32>(9, 0.0f), "VEC3", 0);
+    triangle.indices = add_index_accessor(single, {0, 1, 2}, 3);
+    CHECK(convert_to_strip(single, triangle) && triangle.mode == MODE_TRIANGLES);
+}
+
+int main() {
+    check_kernels();
+    check_primitives();
+
+    std::printf("topology: ok\n");
+    return 0;
+}
@@ -0,0 +1,85 @@
+// Incremental update_transforms() must match a full rebuild and recompute exactly the edited subtrees
+#include "common.hpp"
+#include "math.hpp"
+#include "transform.hpp"
+
+using namespace test;
+
+static u32 seed = 4242;
+
+static u32 next_random(u32 range) {
+    seed = seed * 1664525u + 1013904223u;
+    return (seed >> 8) % range;
+}
+
+static bool near(const Mat4 &a, const Mat4 &b, f32 tolerance) {
+    for (usize i = 0; i < 16; i++) {
+        if (!test::near(a.m[i], b.m[i], tolerance)) return false;
+    }
+    return true;
+}
+
+int main() {
+    const u32 NODES = 200;
+    Model model;
+    model.nodes.resize(NODES);
+    for (u32 n = 1; n < NODES; n++) model.nodes[next_random(n)].children.push_back(n);
+    update_transforms(model);
+    CHECK(model.transforms.changed.size() == NODES);
+
+    for (u32 iteration = 0; iteration < 50; iteration++) {
+        std::vector<u8> edited(NODES, 0);
+        for (u32 edit = 0; edit < 4; edit++) {
+            u32 n = next_random(NODES);
+            edited[n] = 1;
+            switch (edit) {
+            case 0:
+                set_translation(model, n, {(f32)next_random(10), (f32)next_random(10), 0.0f});
+                break;
+            case 1:
+                set_rotation(model, n, quat_normalize({0.0f, (f32)next_random(5), 0.0f, 1.0f}));
+                break;
+            case 2:
+                set_scale(model, n, {1.0f + next_random(3), 1.0f, 1.0f});
+                break;
+            default:
+                // A matrix node edited directly; the next set_translation() on it switches it back to TRS
+                model.nodes[n].matrix = compose_trs({1.0f, (f32)next_random(4), 0.0f}, {0, 0, 0, 1}, {1, 1, 1});
+                model.nodes[n].has_matrix = true;
+                mark_transform_dirty(model, n);
+                break;
+            }
+        }
+        update_transforms(model);
+
+        // Exactly the edited nodes and their descendants, each once
+        std::vector<u8> expected(NODES, 0), seen(NODES, 0);
+        for (u32 n = 0; n < NODES; n++) {
+            for (u32 p = n; p != UINT32_MAX && !expected[n]; p = model.transforms.parents[p]) expected[n] = edited[p];
+        }
+        for (u32 n : model.transforms.changed) {
+            CHECK(expected[n] && !seen[n]);
+            seen[n] = 1;
+        }
+        CHECK(seen == expected);
+
+        std::vector<Mat4> incremental = model.transforms.world;
+        invalidate_transforms(model);
+        update_transforms(model);
+        for (u32 n = 0; n < NODES; n++) CHECK(near(incremental[n], world_transform(model, n), 1e-4f));
+    }
+
+    // A cycle is detached rather than walked forever: 0 -> 1 -> 0
+    Model cyclic;
+    cyclic.nodes.resize(2);
+    cyclic.nodes[0].children.push_back(1);
+    cyclic.nodes[1].children.push_back(0);
+    cyclic.nodes[0].translation = {1.0f, 0.0f, 0.0f};
+    cyclic.nodes[1].translation = {0.0f, 2.0f, 0.0f};
+    update_transforms(cyclic);
+    CHECK(cyclic.transforms.changed.size() == 2);
+    CHECK(near(transform_point(world_transform(cyclic, 1), {0, 0, 0}), {1.0f, 2.0f, 0.0f}, 1e-6f));
+
+    std::printf("transform: ok\n");
+    return 0;
+}
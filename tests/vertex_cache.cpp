@@ -0,0 +1,52 @@
+// optimize_vertex_cache(Model&) must not reorder one accessor's indices under another that reads the same bytes
+#include "common.hpp"
+#include "vertex_cache.hpp"
+
+using namespace test;
+
+static u32 add_indices(Model &model, u32 buffer_view, usize byte_offset, usize count) {
+    Accessor accessor;
+    accessor.buffer_view = buffer_view;
+    accessor.byte_offset = byte_offset;
+    accessor.component_type = COMPONENT_UNSIGNED_SHORT;
+    accessor.count = count;
+    accessor.type = "SCALAR";
+    return add_accessor(model, accessor);
+}
+
+int main() {
+    // Six triangles of a strip of 14 vertices, deliberately out of cache order
+    std::vector<u16> indices = {0, 1, 2, 9, 10, 11, 4, 5, 6, 2, 3, 4, 11, 12, 13, 6, 7, 8};
+    Model model;
+    u32 view = append_buffer_view(model, indices.data(), indices.size() * sizeof(u16), 0, TARGET_ELEMENT_ARRAY_BUFFER);
+    u32 whole = add_indices(model, view, 0, 18);
+    u32 prefix = add_indices(model, view, 3 * sizeof(u16), 3);
+
+    // A second view over the bytes of triangles 2 and 3 of `whole`
+    u32 second_view = add_buffer_view(model, model.buffer_views[view].buffer, model.buffer_views[view].byte_offset + 12,
+                                      12, 0, TARGET_ELEMENT_ARRAY_BUFFER);
+    u32 middle = add_indices(model, second_view, 0, 6);
+
+    model.meshes.resize(1);
+    for (u32 accessor : {whole, prefix, middle}) {
+        Primitive primitive;
+        primitive.indices = accessor;
+        model.meshes[0].primitives.push_back(primitive);
+    }
+
+    std::vector<std::vector<u32>> expected;
+    for (u32 accessor : {whole, prefix, middle}) expected.push_back(triangle_set(model, accessor));
+
+    VertexCacheReport report;
+    CHECK(optimize_vertex_cache(model, 16, &report));
+    CHECK(report.before.triangles == 9);
+
+    std::vector<u32> prefix_indices;
+    CHECK(read_indices(model, prefix, 0, prefix_indices));
+    CHECK(prefix_indices == std::vector<u32>({9, 10, 11}));
+    CHECK(triangle_set(model, whole) == expected[0]);
+    CHECK(triangle_set(model, middle) == expected[2]);
+
+    std::printf("vertex_cache: ok\n");
+    return 0;
+}
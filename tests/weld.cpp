@@ -0,0 +1,87 @@
+// Welding a triangle soup merges exactly the vertices whose attributes agree, and every corner keeps its values
+#include "common.hpp"
+#include "weld.hpp"
+
+using namespace test;
+
+static u32 seed = 2024;
+
+static f32 next_float(f32 lo, f32 hi) {
+    seed = seed * 1664525u + 1013904223u;
+    return lo + (hi - lo) * (f32)(seed >> 8) / (f32)(1u << 24);
+}
+
+// 3 x 3 quads as a non-indexed soup. The corners of quad 0 get their texture coordinates offset, a seam that keeps
+// its three corners shared with other quads apart, so 16 grid points weld to 19 vertices. `jitter` moves positions
+// by up to that much, and z alternates between 0 and -0.
+static Model make_soup(f32 jitter, std::vector<f32> &positions, std::vector<f32> &uvs) {
+    positions.clear();
+    uvs.clear();
+    for (u32 quad = 0; quad < 9; quad++) {
+        u32 x = quad % 3, y = quad / 3;
+        const u32 corners[6][2] = {{x, y}, {x + 1, y}, {x + 1, y + 1}, {x, y}, {x + 1, y + 1}, {x, y + 1}};
+        for (u32 c = 0; c < 6; c++) {
+            f32 px = (f32)corners[c][0], py = (f32)corners[c][1];
+            positions.insert(positions.end(), {px + next_float(-jitter, jitter), py + next_float(-jitter, jitter),
+                                               c % 2 ? -0.0f : 0.0f});
+            f32 seam = quad == 0 ? 1.0f : 0.0f;
+            uvs.insert(uvs.end(), {px / 3.0f + seam, py / 3.0f});
+        }
+    }
+
+    Model model;
+    Primitive primitive;
+    primitive.attributes["POSITION"] = add_float_accessor(model, positions, "VEC3", TARGET_ARRAY_BUFFER);
+    primitive.attributes["TEXCOORD_0"] = add_float_accessor(model, uvs, "VEC2", TARGET_ARRAY_BUFFER);
+    model.meshes.resize(1);
+    model.meshes[0].primitives.push_back(primitive);
+    return model;
+}
+
+static void check_weld(f32 jitter, f32 epsilon) {
+    std::vector<f32> positions, uvs;
+    Model model = make_soup(jitter, positions, uvs);
+    Primitive &primitive = model.meshes[0].primitives[0];
+
+    WeldOptions options;
+    options.position_epsilon = epsilon;
+    WeldStats stats;
+    CHECK(weld_primitive(model, primitive, options, &stats));
+    CHECK(stats.vertices_before == 54 && stats.vertices_after == 19);
+
+    std::vector<u32> indices;
+    std::vector<f32> welded_positions, welded_uvs;
+    CHECK(read_indices(model, primitive.indices, stats.vertices_after, indices) && indices.size() == 54);
+    CHECK(read_floats(model, primitive.attributes["POSITION"], welded_positions));
+    CHECK(read_floats(model, primitive.attributes["TEXCOORD_0"], welded_uvs));
+    CHECK(welded_positions.size() == 19 * 3);
+
+    for (usize corner = 0; corner < 54; corner++) {
+        u32 vertex = indices[corner];
+        for (usize c = 0; c < 3; c++) CHECK(near(welded_positions[vertex * 3 + c], positions[corner * 3 + c], epsilon));
+        CHECK(welded_uvs[vertex * 2] == uvs[corner * 2] && welded_uvs[vertex * 2 + 1] == uvs[corner * 2 + 1]);
+    }
+}
+
+int main() {
+    // Exact: identical values merge, and -0 merges with 0
+    check_weld(0.0f, 0.0f);
+    // Positions jittered well within their grid cells
+    check_weld(0.001f, 0.01f);
+
+    // Morph targets displacing shared positions differently keep them apart
+    std::vector<f32> positions, uvs;
+    Model model = make_soup(0.0f, positions, uvs);
+    Primitive &primitive = model.meshes[0].primitives[0];
+    std::vector<f32> offsets(positions.size(), 0.0f);
+    offsets[2 * 3 + 2] = 1.0f; // Corner 2 of quad 0; corner 4 has the same position and texture coordinates
+    primitive.targets.resize(1);
+    primitive.targets[0]["POSITION"] = add_float_accessor(model, offsets, "VEC3", TARGET_ARRAY_BUFFER);
+
+    WeldStats stats;
+    CHECK(weld_primitive(model, primitive, WeldOptions(), &stats));
+    CHECK(stats.vertices_after == 20);
+
+    std::printf("weld: ok\n");
+    return 0;
+}